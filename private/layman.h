@@ -31,19 +31,33 @@
 #include "../public/layman.h"
 
 // Continue normally with the private definitions.
+#include "layman/adjacency.h"
+#include "layman/bvh.h"
 #include "layman/camera.h"
+#include "layman/compression.h"
+#include "layman/culling.h"
 #include "layman/entity.h"
 #include "layman/environment.h"
 #include "layman/framebuffer.h"
+#include "layman/geometry.h"
 #include "layman/light.h"
 #include "layman/material.h"
 #include "layman/mesh.h"
+#include "layman/meshlet.h"
 #include "layman/model.h"
+#include "layman/optimizer.h"
+#include "layman/pack.h"
+#include "layman/parallel.h"
+#include "layman/queue.h"
 #include "layman/renderer.h"
 #include "layman/scene.h"
 #include "layman/shader.h"
+#include "layman/simplifier.h"
+#include "layman/streaming.h"
 #include "layman/texture.h"
+#include "layman/transform.h"
 #include "layman/utils.h"
+#include "layman/vertex.h"
 #include "layman/window.h"
 
 #endif
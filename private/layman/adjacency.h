@@ -0,0 +1,36 @@
+#ifndef LAYMAN_PRIVATE_ADJACENCY_H
+#define LAYMAN_PRIVATE_ADJACENCY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Triangles using each vertex of an index buffer, as walked by the optimizer, the simplifier and the meshlet builder.
+ *
+ * The triangles of vertex `v` are `triangles[offsets[v]]` up to `triangles[offsets[v + 1]]`, in increasing order.
+ */
+struct layman_adjacency {
+	uint32_t *offsets;   // Of the first triangle of each vertex, one past the last vertex included.
+	uint32_t *triangles;
+};
+
+/**
+ * @brief Allocates the adjacency of up to `indices_count` indices addressing `vertices_count` vertices.
+ *
+ * @return Returns `true` on success or `false` if out of memory, the adjacency then holds nothing to destroy.
+ */
+bool layman_adjacency_create(struct layman_adjacency *adjacency, size_t indices_count, size_t vertices_count);
+void layman_adjacency_destroy(struct layman_adjacency *adjacency);
+
+/**
+ * @brief Lists the triangles using each vertex.
+ *
+ * @param[in] indices The triangles, every index below `vertices_count`.
+ * @param[in] indices_count At most as many as the adjacency was created for.
+ *
+ * @remark Can be built again as the indices change, reusing the memory.
+ */
+void layman_adjacency_build(struct layman_adjacency *adjacency, const uint32_t *indices, size_t indices_count, size_t vertices_count);
+
+#endif
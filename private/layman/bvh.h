@@ -0,0 +1,77 @@
+#ifndef LAYMAN_PRIVATE_BVH_H
+#define LAYMAN_PRIVATE_BVH_H
+
+#include "cglm/cglm.h"
+#include <stdint.h>
+
+// Deep enough for any sensible tree; the build turns nodes into leaves rather than going past it.
+#define LAYMAN_BVH_MAX_DEPTH 64
+
+#define LAYMAN_BVH_NONE UINT32_MAX
+
+struct layman_bvh_node {
+	vec3 min;
+	vec3 max;
+
+	// Leaves have a non-zero count and `first` is their first slot in `indices`.
+	// Inner nodes have a count of zero, `first` is their left child and the right child follows right after it.
+	uint32_t first;
+	uint32_t count;
+
+	uint32_t parent;
+};
+
+/**
+ * Bounding volume hierarchy over a set of axis-aligned bounding boxes (the primitives).
+ *
+ * The hierarchy doesn't own the boxes; they are passed in by the caller every time they're needed.
+ */
+struct layman_bvh {
+	struct layman_bvh_node *nodes;
+	size_t nodes_count;
+
+	uint32_t *indices; // Primitive indices, grouped by leaf.
+	uint32_t *leaves;  // The leaf of every primitive.
+	size_t count;
+
+	float built_cost; // Right after the last build, see layman_bvh_cost().
+};
+
+// Tells whether a box overlaps the shape being queried.
+typedef bool (*layman_bvh_overlap)(const float *min, const float *max, const void *shape);
+
+// Called for every primitive overlapping the shape being queried.
+typedef void (*layman_bvh_visit)(uint32_t primitive, void *data);
+
+struct layman_bvh *layman_bvh_create(void);
+void layman_bvh_destroy(struct layman_bvh *bvh);
+
+/**
+ * @brief Rebuilds the hierarchy from scratch using the surface area heuristic with binning.
+ *
+ * @return Returns `true` on success or `false` otherwise, in which case the hierarchy is left empty.
+ */
+bool layman_bvh_build(struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, size_t count);
+
+/**
+ * @brief Updates the boxes of the nodes containing a primitive after its own box changed.
+ *
+ * @remark Refitting never changes the structure of the tree, so its quality slowly degrades as primitives move around.
+ */
+void layman_bvh_refit(struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, uint32_t primitive);
+
+/**
+ * @brief Estimates the cost of a query with the surface area heuristic, relative to testing a single box.
+ *
+ * Compared to `built_cost`, tells how much refitting degraded the hierarchy. Unbounded primitives make it infinite.
+ */
+float layman_bvh_cost(const struct layman_bvh *bvh);
+
+/**
+ * @brief Visits every primitive whose box overlaps a shape.
+ *
+ * @return The number of primitives visited.
+ */
+size_t layman_bvh_query(const struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, layman_bvh_overlap overlap, const void *shape, layman_bvh_visit visit, void *data);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef LAYMAN_PRIVATE_COMPRESSION_H
+#define LAYMAN_PRIVATE_COMPRESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Tells whether an internal format stores its pixels in compressed blocks of 4x4 pixels.
+ */
+bool layman_compression_block_format(enum layman_texture_format_internal format);
+
+/**
+ * @brief Tells how many bytes an image takes once compressed in a block format.
+ *
+ * @remark Images whose size isn't a multiple of 4 still take whole blocks.
+ */
+size_t layman_compression_size(enum layman_texture_format_internal format, size_t width, size_t height);
+
+/**
+ * @brief Compresses 8-bit pixels to a block format.
+ *
+ * BC1 and BC3 read the first three channels as the color, and the fourth as the alpha when there's one. BC4 only reads
+ * the first channel and BC5 the first two.
+ *
+ * The rows of blocks are spread over several threads. Doesn't touch OpenGL, images can be compressed on any thread.
+ *
+ * @param[out] blocks Where to write the blocks, layman_compression_size() bytes.
+ *
+ * @return Returns `true` on success or `false` if there's no encoder for the format.
+ */
+bool layman_compression_encode(enum layman_texture_format_internal format, const unsigned char *pixels, size_t width, size_t height, size_t components, unsigned char *blocks);
+
+/**
+ * @brief Halves the size of 8-bit pixels with a box filter, down to a minimum of 1.
+ *
+ * Compressed levels are built on the CPU from these, glGenerateMipmap() can't write compressed textures.
+ */
+void layman_compression_downsample(const unsigned char *pixels, size_t width, size_t height, size_t components, unsigned char *output);
+
+/**
+ * @brief Walks down the levels of 8-bit pixels, each downsampled from the one before with
+ *        layman_compression_downsample().
+ *
+ * @param[in] levels How many levels to visit, the full size included.
+ * @param[in] visit Called with the pixels of every level in order, only valid during the call.
+ *
+ * @return Returns `true` on success or `false` if out of memory, before any level is visited.
+ */
+bool layman_compression_mipmap(const unsigned char *pixels, size_t width, size_t height, size_t components, size_t levels, void (*visit)(size_t level, const unsigned char *pixels, size_t width, size_t height, void *data), void *data);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef LAYMAN_PRIVATE_CULLING_H
+#define LAYMAN_PRIVATE_CULLING_H
+
+#include "meshlet.h"
+#include <stdint.h>
+
+/**
+ * World-space bounding spheres of everything that could be drawn this frame.
+ *
+ * The spheres are stored as a structure of arrays so that the frustum test can process several of them at once.
+ * The arrays are always padded to a multiple of 4 elements.
+ */
+struct layman_culling {
+	float *center_x;
+	float *center_y;
+	float *center_z;
+	float *radius;
+	uint8_t *visible;
+
+	// What each sphere belongs to.
+	const struct layman_mesh **meshes;
+	const struct layman_entity **entities;
+	uint8_t **lods; // Where the LOD drawn last is remembered, see `struct layman_entity`.
+
+	size_t count;
+	size_t capacity;
+};
+
+struct layman_culling *layman_culling_create(void);
+void layman_culling_destroy(struct layman_culling *culling);
+
+void layman_culling_clear(struct layman_culling *culling);
+
+/**
+ * @brief Computes the world-space bounding sphere of a mesh; center and radius.
+ */
+void layman_culling_sphere(const struct layman_mesh *mesh, mat4 model_matrix, vec4 sphere);
+
+/**
+ * @brief Adds the bounding sphere of a mesh, transformed to world-space.
+ *
+ * @param[in] culling A pointer to the culling data.
+ * @param[in] mesh A pointer to the mesh.
+ * @param[in] entity A pointer to the entity the mesh is drawn for.
+ * @param[in] lod Where the LOD the mesh was last drawn with is remembered.
+ * @param[in] model_matrix The local-to-world matrix of the entity.
+ *
+ * @return Returns `true` on success or `false` otherwise.
+ */
+bool layman_culling_push(struct layman_culling *culling, const struct layman_mesh *mesh, const struct layman_entity *entity, uint8_t *lod, mat4 model_matrix);
+
+/**
+ * @brief Tests every sphere against the six planes of a frustum.
+ *
+ * @param[in] culling A pointer to the culling data.
+ * @param[in] view_projection_matrix The matrix from which the frustum planes are extracted.
+ *
+ * @remark Fills `visible` with `1` for spheres intersecting the frustum and `0` otherwise.
+ *
+ * @return The number of visible spheres.
+ */
+size_t layman_culling_frustum(struct layman_culling *culling, mat4 view_projection_matrix);
+
+/**
+ * @brief Tests the meshlets of a mesh against the six planes of a frustum, and the back-facing ones against their cones.
+ *
+ * @param[in] meshlets The bounds of the meshlets, see `struct layman_meshlets`.
+ * @param[in] model_matrix The local-to-world matrix of the instance of the mesh.
+ * @param[in] planes The normalized world-space planes of the frustum, see `glm_frustum_planes()`.
+ * @param[in] camera The world-space position of the camera.
+ * @param[in] cones Whether to cull the meshlets facing away from the camera, only done when the matrix keeps their cones.
+ * @param[out] visible Set to `1` for each visible meshlet and `0` otherwise.
+ *
+ * @return The number of visible meshlets.
+ */
+size_t layman_culling_meshlets(const struct layman_meshlets *meshlets, mat4 model_matrix, vec4 planes[6], vec3 camera, bool cones, uint8_t *visible);
+
+#endif
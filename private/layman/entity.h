@@ -3,7 +3,29 @@
 
 struct layman_entity {
 	const struct layman_model *model;
-	vec3 position;
+	uint32_t transform;
+
+	// The LOD each mesh of the model was last drawn with, remembered by the renderer to only switch past a margin.
+	// Written even through constant entities, it's nothing but a cache.
+	uint8_t *lods;
 };
 
+/**
+ * @brief Copies the local-to-world matrix of an entity, as of the last update of the transforms.
+ */
+void layman_entity_model_matrix(const struct layman_entity *entity, mat4 model_matrix);
+
+/**
+ * @brief Copies the matrix transforming the normals of an entity to world-space, as of the last update of the transforms.
+ */
+void layman_entity_normal_matrix(const struct layman_entity *entity, mat4 normal_matrix);
+
+/**
+ * @brief Computes the world-space axis-aligned bounding box of an entity.
+ *
+ * @remark Entities without a model get an empty box at their position.
+ * @remark Entities whose model has unknown bounds get an infinite box.
+ */
+void layman_entity_bounds(const struct layman_entity *entity, vec3 min, vec3 max);
+
 #endif
@@ -0,0 +1,59 @@
+#ifndef LAYMAN_PRIVATE_GEOMETRY_H
+#define LAYMAN_PRIVATE_GEOMETRY_H
+
+#include "glad/glad.h"
+
+// Layout expected by glMultiDrawElementsIndirect().
+struct layman_draw_command {
+	GLuint count;
+	GLuint instance_count;
+	GLuint first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+};
+
+/**
+ * Vertices and indices of many meshes packed into a few large buffers behind a single vertex array.
+ *
+ * Meshes are copied in on the GPU side, their own buffers are left untouched. The space they take is never reclaimed,
+ * which makes this only worth it for static geometry.
+ */
+struct layman_geometry {
+	unsigned int id; // Unique, meshes remember the one they were packed into.
+
+	GLuint vao;
+	GLuint vbos[4]; // Positions, normals, UVs and tangents.
+	GLuint ebo_indices;
+
+	size_t vertices_count;
+	size_t vertices_capacity;
+	size_t indices_count;
+	size_t indices_capacity;
+};
+
+/**
+ * @brief Creates an empty geometry.
+ *
+ * @param[in] instances_buffer The buffer of `struct layman_instance` elements the per-instance attributes read from.
+ */
+struct layman_geometry *layman_geometry_create(GLuint instances_buffer);
+void layman_geometry_destroy(struct layman_geometry *geometry);
+
+void layman_geometry_switch(const struct layman_geometry *geometry);
+
+/**
+ * @brief Changes the buffer of `struct layman_instance` elements the per-instance attributes read from.
+ */
+void layman_geometry_bind_instances(const struct layman_geometry *geometry, GLuint instances_buffer);
+
+/**
+ * @brief Copies the vertices and indices of a mesh, those of its LODs included, into a geometry.
+ *
+ * @remark Only meshes with tightly packed positions, normals, UVs and tangents, and 16-bit indices, can be packed.
+ *         The indices stay relative to each mesh, such that the geometry as a whole can exceed what they address.
+ *
+ * @return Returns `true` on success or `false` if the mesh can't be packed.
+ */
+bool layman_geometry_add(struct layman_geometry *geometry, struct layman_mesh *mesh);
+
+#endif
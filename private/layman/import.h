@@ -0,0 +1,47 @@
+#ifndef LAYMAN_PRIVATE_IMPORT_H
+#define LAYMAN_PRIVATE_IMPORT_H
+
+#include "gltf.h"
+
+/*
+ * What the glTF loader and the cooker (`tools/cooker.c`) both read from glTF files, for them to agree on it.
+ * Only included by them, the rest of layman doesn't know about glTF.
+ */
+
+#define LAYMAN_IMPORT_TEXTURES 5
+
+/**
+ * @brief The kinds the textures of a material get loaded as, in the order of `struct layman_pack_material`.
+ */
+extern const enum layman_texture_kind layman_import_texture_kinds[LAYMAN_IMPORT_TEXTURES];
+
+/**
+ * @brief Gets the encoded image of a texture view.
+ *
+ * @return Returns the image, or `NULL` when the view has none or it isn't stored in a buffer.
+ */
+const cgltf_image *layman_import_view_image(const cgltf_texture_view *view);
+
+/**
+ * @brief Gets the encoded image of one of the textures of a material.
+ *
+ * @param[in] texture The index of the texture, see `layman_import_texture_kinds`.
+ *
+ * @return Returns the image, or `NULL` when there's none to load. A packed occlusion has none of its own.
+ */
+const cgltf_image *layman_import_texture(const cgltf_material *material, size_t texture);
+
+/**
+ * @brief Tells whether the occlusion lives in the red channel of the metallic-roughness image, the usual glTF "ORM"
+ *        layout.
+ */
+bool layman_import_occlusion_packed(const cgltf_material *material);
+
+/**
+ * @brief Gets the bytes of an encoded image, layman_import_view_image() having returned it.
+ *
+ * @remark Buffers not loaded with cgltf_load_buffers() are taken for the binary chunk of a `.glb` file.
+ */
+const unsigned char *layman_import_image_data(const cgltf_data *gltf, const cgltf_image *image);
+
+#endif
@@ -1,7 +1,15 @@
 #ifndef LAYMAN_PRIVATE_MATERIAL_H
 #define LAYMAN_PRIVATE_MATERIAL_H
 
+enum layman_material_alpha_mode {
+	LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE,
+	LAYMAN_MATERIAL_ALPHA_MODE_MASK,
+	LAYMAN_MATERIAL_ALPHA_MODE_BLEND,
+};
+
 struct layman_material {
+	unsigned int id; // Unique, used to group draws by material.
+
 	vec4 base_color_factor;
 	struct layman_texture *base_color_texture;
 	struct layman_texture *metallic_roughness_texture;
@@ -11,10 +19,37 @@ struct layman_material {
 	float normal_scale;
 	struct layman_texture *occlusion_texture;
 	float occlusion_strength;
+	bool occlusion_packed; // Occlusion in the red channel of the metallic-roughness texture, bound only once.
 	struct layman_texture *emissive_texture;
 	vec3 emissive_factor;
+	enum layman_material_alpha_mode alpha_mode;
+	float alpha_cutoff; // Only used in the mask mode.
+	bool unlit;
+	bool double_sided; // Both faces of the triangles are seen, none of them can be culled.
+
+	size_t references; // Only meaningful for the materials shared through layman_material_acquire().
 };
 
+/**
+ * @brief Shares a material with the models already using an identical one.
+ *
+ * @param[in] material A material just made with layman_material_create(), owned by the registry from now on.
+ *
+ * @return The material to use in its place, possibly another one, or `NULL` when running out of memory.
+ *
+ * @remark Materials are identical when all their properties are and they use the very same textures. The one given
+ *         is destroyed when another one is returned, as well as when `NULL` is.
+ * @remark Shared materials are released with layman_material_release(), never destroyed directly.
+ */
+struct layman_material *layman_material_acquire(struct layman_material *material);
+
+/**
+ * @brief Gives back a material returned by layman_material_acquire(), destroying it along with its last user.
+ *
+ * @param[in] material The material to release, can be `NULL`.
+ */
+void layman_material_release(struct layman_material *material);
+
 void layman_material_switch(const struct layman_material *material);
 
 #endif
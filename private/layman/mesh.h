@@ -2,6 +2,19 @@
 #define LAYMAN_PRIVATE_MESH_H
 
 #include "glad/glad.h"
+#include "meshlet.h"
+#include "vertex.h"
+#include <stdint.h>
+
+// The most LODs a mesh can have, the full detail included.
+#define LAYMAN_MESH_LODS 8
+
+// A range of the indices of a mesh, drawing it with fewer triangles over the same vertices.
+struct layman_mesh_lod {
+	uint32_t first_index;
+	uint32_t indices_count;
+	float error; // The farthest the surface strays from the full detail, relative to the radius of the bounds.
+};
 
 struct layman_mesh {
 	GLuint vao;
@@ -11,12 +24,144 @@ struct layman_mesh {
 	GLuint ebo_indices;
 	GLuint vbo_tangents;
 	GLuint vbo_bitangents;
-	size_t indices_count;
+	GLuint vbo_vertices; // The attributes interleaved in a format, instead of the separate buffers above.
+	size_t vertices_count;
+	size_t indices_count; // Of every LOD.
+	enum layman_mesh_index_format indices_format;
+
+	// From the full detail to the coarsest, see layman_simplifier_chain().
+	struct layman_mesh_lod lods[LAYMAN_MESH_LODS];
+	size_t lods_count;
+
+	// Clusters of the full detail culled one by one, see layman_meshlet_build(). `NULL` when the mesh has none.
+	struct layman_meshlets *meshlets;
+
+	struct layman_vertex_format format; // The attributes the vertices have and how they're stored, see LAYMAN_MESH_HAS().
+
+	// Where the mesh lives within shared geometry buffers, see `struct layman_geometry`.
+	bool packable;            // Whether the layout of the mesh allows it to be packed at all.
+	unsigned int geometry_id; // Zero when not packed.
+	GLuint geometry_first_index;
+	GLint geometry_base_vertex;
+
+	// Local-space bounding volumes, used for culling.
+	// Meshes without known bounds get infinite ones and are never culled.
+	vec3 aabb_min;
+	vec3 aabb_max;
+	vec3 sphere_center;
+	float sphere_radius;
 
 	struct layman_shader *shader;
 	const struct layman_material *material;
 };
 
+// Per-instance data, as laid out in the renderer's instance buffer.
+// Also mirrors the `Instance` structure of `shaders/culling/main.comp` (std430 layout).
+struct layman_instance {
+	mat4 model_matrix;
+	mat4 normal_matrix;
+
+	// Only read by the GPU culling.
+	vec4 sphere;      // World-space bounding sphere; center and radius.
+	uint32_t command; // Index of the draw command of the instance or `LAYMAN_INSTANCE_NO_COMMAND`.
+	uint32_t padding[3];
+};
+
+#define LAYMAN_INSTANCE_NO_COMMAND UINT32_MAX
+
+#define LAYMAN_MESH_HAS(mesh, attribute) (((mesh)->format.attributes >> (attribute)) & 1)
+
+_Static_assert(sizeof (struct layman_instance) == 160, "Instances must follow the std430 layout");
+
 void layman_mesh_switch(const struct layman_mesh *mesh);
 
+/**
+ * @brief Tells how many bytes an index takes in a format.
+ */
+size_t layman_mesh_index_size(enum layman_mesh_index_format format);
+
+/**
+ * @brief Tells the OpenGL type of the indices in a format, as the draw calls take it.
+ */
+GLenum layman_mesh_index_type(enum layman_mesh_index_format format);
+
+/**
+ * @brief Picks the narrowest index format able to address some vertices.
+ *
+ * 8-bit indices are never picked, most GPUs widen them in the driver at a cost larger than the bandwidth they save.
+ */
+enum layman_mesh_index_format layman_mesh_index_format_fit(size_t vertices_count);
+
+/**
+ * @brief Narrows 32-bit indices to a format, which must address all of them.
+ *
+ * @param[out] destination Where to write the indices, can be the 32-bit indices themselves.
+ */
+void layman_mesh_narrow_indices(const uint32_t *indices, size_t count, enum layman_mesh_index_format format, void *destination);
+
+/**
+ * @brief Creates a mesh from vertices whose attributes are interleaved and encoded in a format.
+ *
+ * @param[in] streams The vertices of each stream of the format, see layman_vertex_encode(). Unused ones are ignored.
+ *
+ * @remark Interleaved meshes can't be packed into shared geometry buffers.
+ */
+struct layman_mesh *layman_mesh_create_interleaved(const struct layman_vertex_format *format, const void *const streams[LAYMAN_VERTEX_STREAMS], size_t vertices_count, const void *indices, size_t indices_count, enum layman_mesh_index_format indices_format, const struct layman_material *material);
+
+/**
+ * @brief Assigns the LODs of a mesh, ranges of its indices sorted from the full detail to the coarsest.
+ *
+ * Meshes start with a single LOD covering all of their indices.
+ */
+void layman_mesh_assign_lods(struct layman_mesh *mesh, const struct layman_mesh_lod *lods, size_t count);
+
+/**
+ * @brief Assigns the meshlets of a mesh, which must cover the range of its full detail in order.
+ *
+ * @remark Running out of memory leaves the mesh without, drawn whole.
+ */
+void layman_mesh_assign_meshlets(struct layman_mesh *mesh, const struct layman_meshlet *meshlets, size_t count);
+
+/**
+ * @brief Assigns the bounding volumes of a mesh from its axis-aligned bounding box.
+ *
+ * The bounding sphere is derived from the box.
+ */
+void layman_mesh_assign_bounds(struct layman_mesh *mesh, const vec3 min, const vec3 max);
+
+/**
+ * @brief Computes the bounding volumes of a mesh by scanning its vertex positions.
+ *
+ * @param[in] positions Pointer to the first position (three floats).
+ * @param[in] count The number of positions.
+ * @param[in] stride The distance in bytes between positions, or `0` when tightly packed.
+ */
+void layman_mesh_compute_bounds(struct layman_mesh *mesh, const float *positions, size_t count, size_t stride);
+
+/**
+ * @brief Computes the bounding box of vertex positions, as layman_mesh_compute_bounds() does.
+ *
+ * @param[out] aabb_min, aabb_max The corners of the box, an empty one when there are no positions.
+ */
+void layman_mesh_positions_bounds(const float *positions, size_t count, size_t stride, vec3 aabb_min, vec3 aabb_max);
+
+/**
+ * @brief Points the per-instance attributes of a mesh to a range of an instance buffer.
+ *
+ * @param[in] mesh A pointer to the mesh.
+ * @param[in] buffer The buffer containing `struct layman_instance` elements.
+ * @param[in] first The index of the first instance to use.
+ */
+void layman_mesh_bind_instances(const struct layman_mesh *mesh, GLuint buffer, size_t first);
+
+/**
+ * @brief Enables the per-instance attributes of the bound vertex array.
+ */
+void layman_mesh_enable_instances(void);
+
+/**
+ * @brief Points the per-instance attributes of the bound vertex array to a range of an instance buffer.
+ */
+void layman_mesh_point_instances(GLuint buffer, size_t first);
+
 #endif
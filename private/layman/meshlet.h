@@ -0,0 +1,74 @@
+#ifndef LAYMAN_PRIVATE_MESHLET_H
+#define LAYMAN_PRIVATE_MESHLET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The most vertices and triangles of a meshlet, the limits mesh shaders are usually tuned for.
+#define LAYMAN_MESHLET_VERTICES 64
+#define LAYMAN_MESHLET_TRIANGLES 124
+
+// A cluster of neighbouring triangles of a mesh, a range of its indices with bounds of its own.
+struct layman_meshlet {
+	uint32_t first_index;
+	uint32_t indices_count;
+
+	// Local-space bounding sphere.
+	float center[3];
+	float radius;
+
+	// Normal cone: every triangle faces within `acos(sqrt(1 - cutoff²))` of the axis.
+	// Cones too wide to ever be culled have a null axis and a cutoff of `1`.
+	float axis[3];
+	float cutoff;
+};
+
+/**
+ * The bounds of the meshlets of a mesh, as a structure of arrays for layman_culling_meshlets().
+ *
+ * The arrays are padded to a multiple of 4 elements, the padding never being visible.
+ */
+struct layman_meshlets {
+	float *center_x;
+	float *center_y;
+	float *center_z;
+	float *radius;
+	float *axis_x;
+	float *axis_y;
+	float *axis_z;
+	float *cutoff;
+
+	uint32_t *first_index;
+	uint32_t *indices_count;
+
+	size_t count;
+};
+
+/**
+ * @brief Splits triangles into meshlets, reordering them such that each meshlet is a range of the indices.
+ *
+ * Meshlets grow from the first triangle left, one neighbour at a time, picking those adding the fewest vertices, which
+ * keeps them compact. Triangles keep their relative order within a meshlet, and meshlets follow the order of their first
+ * triangle, such that the order tuned by layman_optimizer_optimize() mostly survives.
+ *
+ * @param[in,out] indices The triangles, reordered in place.
+ * @param[in] positions The positions of the vertices (three floats).
+ * @param[in] stride The distance in bytes between positions, or `0` when tightly packed.
+ * @param[out] meshlets The meshlets made, for the caller to free.
+ *
+ * @return The number of meshlets, or `0` when out of memory or when an index is out of range, leaving the indices
+ * untouched.
+ */
+size_t layman_meshlet_build(uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, struct layman_meshlet **meshlets);
+
+/**
+ * @brief Gathers the bounds of meshlets for culling.
+ *
+ * @return The bounds or `NULL` when out of memory.
+ */
+struct layman_meshlets *layman_meshlets_create(const struct layman_meshlet *meshlets, size_t count);
+
+void layman_meshlets_destroy(struct layman_meshlets *meshlets);
+
+#endif
@@ -4,6 +4,21 @@
 struct layman_model {
 	struct layman_mesh **meshes;
 	size_t meshes_count;
+
+	// One per glTF material, followed by the default one. Shared by the meshes using them.
+	struct layman_material **materials;
+	size_t materials_count;
+
+	// Local-space bounding box enclosing all the meshes.
+	vec3 aabb_min;
+	vec3 aabb_max;
 };
 
+/**
+ * @brief Grows the bounding box of a model to enclose that of one of its meshes.
+ *
+ * @remark Boxes start empty, with their minimum at `FLT_MAX` and their maximum at `-FLT_MAX`.
+ */
+void layman_model_enclose(vec3 aabb_min, vec3 aabb_max, const vec3 mesh_min, const vec3 mesh_max);
+
 #endif
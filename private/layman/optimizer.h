@@ -0,0 +1,51 @@
+#ifndef LAYMAN_PRIVATE_OPTIMIZER_H
+#define LAYMAN_PRIVATE_OPTIMIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Entries of the post-transform vertex cache the orders are tuned for, modelled as a FIFO.
+#define LAYMAN_OPTIMIZER_CACHE_SIZE 16
+
+// How an index buffer fares with the vertex cache.
+struct layman_optimizer_statistics {
+	size_t triangles_count;
+	size_t vertices_count; // Referenced by the indices.
+	size_t transforms;     // Cache misses, each a run of the vertex shader.
+};
+
+/**
+ * @brief Simulates the vertex cache over an index buffer.
+ *
+ * The average cache miss ratio (ACMR) is `transforms / triangles_count`, from 3 down to about 0.5 for regular meshes.
+ * The average transform to vertex ratio (ATVR) is `transforms / vertices_count`, 1 being perfect.
+ * Indices out of range leave nothing but the number of triangles.
+ */
+struct layman_optimizer_statistics layman_optimizer_analyze(const uint32_t *indices, size_t indices_count, size_t vertices_count);
+
+/**
+ * @brief Reorders the triangles of an index buffer for the vertex cache and overdraw, then its vertices for fetches.
+ *
+ * Triangles are first ordered by Tipsify, fanning around vertices still in the cache. The order is then cut into
+ * clusters barely hurting the cache, sorted such that those facing outwards, likely occluders, get drawn first.
+ * Finally, vertices are renumbered in the order they're first used.
+ *
+ * @param[in,out] indices The triangles, rewritten in place with the new vertex numbers.
+ * @param[in] positions The positions of the vertices (three floats), or `NULL` to only optimize for the cache.
+ * @param[in] stride The distance in bytes between positions, or `0` when tightly packed.
+ * @param[out] remap The new number of each vertex, see layman_optimizer_remap(). Unused vertices go last.
+ *
+ * @return `false` when out of memory or when an index is out of range, leaving everything untouched.
+ */
+bool layman_optimizer_optimize(uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, uint32_t *remap);
+
+/**
+ * @brief Moves the vertices of a stream to their new number, tightly packing them.
+ *
+ * @param[in] size The size in bytes of a vertex.
+ * @param[in] stride The distance in bytes between vertices in the source, or `0` when tightly packed.
+ */
+void layman_optimizer_remap(const void *source, size_t size, size_t stride, size_t vertices_count, const uint32_t *remap, void *destination);
+
+#endif
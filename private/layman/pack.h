@@ -0,0 +1,144 @@
+#ifndef LAYMAN_PRIVATE_PACK_H
+#define LAYMAN_PRIVATE_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Layout of the packs written by the cooker (`tools/cooker.c`) and mapped by layman_model_load_pack().
+ *
+ * A pack starts with a header, followed by blobs and tables at the offsets it gives, all relative to the start of the
+ * file. Everything is little-endian and naturally aligned; blobs are aligned to `LAYMAN_PACK_ALIGNMENT`.
+ * Enumerations are stored as their values, the version must be bumped whenever one of them changes.
+ */
+
+#define LAYMAN_PACK_MAGIC 0x4B504D4C // "LMPK".
+#define LAYMAN_PACK_VERSION 5
+#define LAYMAN_PACK_ALIGNMENT 16
+#define LAYMAN_PACK_NONE UINT32_MAX
+
+// Flags of `struct layman_pack_material`.
+#define LAYMAN_PACK_MATERIAL_UNLIT 1
+#define LAYMAN_PACK_MATERIAL_OCCLUSION_PACKED 2
+#define LAYMAN_PACK_MATERIAL_DOUBLE_SIDED 4
+
+struct layman_pack_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t textures_count;
+	uint32_t materials_count; // The default material included, last.
+	uint32_t meshes_count;
+	uint32_t reserved;
+
+	// Local-space bounding box enclosing all the meshes.
+	float aabb_min[3];
+	float aabb_max[3];
+
+	// Of the tables of records.
+	uint64_t textures_offset;
+	uint64_t materials_offset;
+	uint64_t meshes_offset;
+};
+
+struct layman_pack_texture {
+	uint32_t kind;            // `enum layman_texture_kind`.
+	uint32_t format;          // `enum layman_texture_format` of uncompressed levels.
+	uint32_t format_internal; // `enum layman_texture_format_internal`.
+	uint32_t width;
+	uint32_t height;
+	uint32_t levels;
+
+	// Every level one after the other, largest first, ready to be uploaded.
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct layman_pack_material {
+	float base_color_factor[4];
+	float emissive_factor[3];
+	float metallic_factor;
+	float roughness_factor;
+	float normal_scale;
+	float occlusion_strength;
+	float alpha_cutoff;
+	uint32_t alpha_mode; // `enum layman_material_alpha_mode`.
+	uint32_t flags;
+
+	// Base color, metallic-roughness, normal, occlusion and emissive textures, or `LAYMAN_PACK_NONE`.
+	uint32_t textures[5];
+	uint32_t reserved;
+};
+
+// See `struct layman_mesh_lod`.
+struct layman_pack_lod {
+	uint32_t first_index;
+	uint32_t indices_count;
+	float error;
+};
+
+// See `struct layman_meshlet`.
+struct layman_pack_meshlet {
+	uint32_t first_index;
+	uint32_t indices_count;
+	float center[3];
+	float radius;
+	float axis[3];
+	float cutoff;
+};
+
+struct layman_pack_mesh {
+	uint32_t material;
+	uint32_t vertices_count;
+	uint32_t indices_count; // Of every LOD.
+	uint32_t indices_format; // `enum layman_mesh_index_format`.
+
+	// See `struct layman_vertex_format`.
+	uint32_t attributes;
+	uint8_t encodings[4]; // `enum layman_vertex_encoding`, by attribute.
+	uint32_t split;
+
+	uint32_t lods_count;
+	struct layman_pack_lod lods[8]; // From the full detail to the coarsest, ranges of the indices.
+
+	float aabb_min[3];
+	float aabb_max[3];
+
+	uint32_t meshlets_count; // Splitting the full detail, or none.
+	uint32_t reserved;
+
+	uint64_t streams_offsets[2]; // Of each stream of the format, see layman_vertex_encode().
+	uint64_t indices_offset;
+	uint64_t meshlets_offset;
+};
+
+_Static_assert(sizeof (struct layman_pack_header) == 72, "Packs have a fixed layout");
+_Static_assert(sizeof (struct layman_pack_texture) == 40, "Packs have a fixed layout");
+_Static_assert(sizeof (struct layman_pack_material) == 80, "Packs have a fixed layout");
+_Static_assert(sizeof (struct layman_pack_lod) == 12, "Packs have a fixed layout");
+_Static_assert(sizeof (struct layman_pack_meshlet) == 40, "Packs have a fixed layout");
+_Static_assert(sizeof (struct layman_pack_mesh) == 192, "Packs have a fixed layout");
+
+/**
+ * @brief Maps a whole file in memory, read-only.
+ *
+ * @return The address of the content or `NULL` on failure.
+ */
+const void *layman_pack_map(const char *filepath, size_t *size);
+
+void layman_pack_unmap(const void *data, size_t size);
+
+/**
+ * @brief Reads the vertex format of a mesh record.
+ */
+struct layman_vertex_format layman_pack_vertex_format(const struct layman_pack_mesh *mesh);
+
+/**
+ * @brief Checks that a mapped pack is of the current version and that every offset, count and index in it stays in
+ * bounds.
+ *
+ * Once validated, its content can be used without any further check.
+ */
+bool layman_pack_validate(const void *data, size_t size);
+
+#endif
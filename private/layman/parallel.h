@@ -0,0 +1,36 @@
+#ifndef LAYMAN_PRIVATE_PARALLEL_H
+#define LAYMAN_PRIVATE_PARALLEL_H
+
+#include <stddef.h>
+
+// Processes the item at a given index. Called concurrently from several threads, so it must not touch OpenGL.
+typedef void (*layman_parallel_job)(size_t index, void *data);
+
+/**
+ * @brief Tells how many threads the machine can run at once.
+ */
+size_t layman_parallel_threads(void);
+
+/**
+ * @brief Starts the workers of layman_parallel_for(), one less than the machine has threads.
+ *
+ * @remark Falls back to fewer workers, or none, when threads can't be started.
+ */
+void layman_parallel_start(void);
+
+/**
+ * @brief Stops the workers once they're done with their current work.
+ */
+void layman_parallel_stop(void);
+
+/**
+ * @brief Calls a job once for every index in `[0, count)`, spread over the workers.
+ *
+ * The items are handed out one at a time, so jobs of uneven cost still balance well. The calling thread takes part in
+ * the work and the function only returns once every item is done.
+ *
+ * @remark Without workers, from within a job, or while another thread uses them, the calling thread does it all.
+ */
+void layman_parallel_for(size_t count, layman_parallel_job job, void *data);
+
+#endif
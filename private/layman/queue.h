@@ -0,0 +1,59 @@
+#ifndef LAYMAN_PRIVATE_QUEUE_H
+#define LAYMAN_PRIVATE_QUEUE_H
+
+#include <stdint.h>
+
+// Passes are the most significant part of the sort keys, so they get drawn in this order.
+enum layman_render_pass {
+	LAYMAN_RENDER_PASS_OPAQUE,
+
+	// Keep there.
+	LAYMAN_RENDER_PASS_COUNT,
+};
+
+// One packet per mesh to draw.
+struct layman_render_packet {
+	uint64_t key;
+	const struct layman_mesh *mesh;
+	const struct layman_entity *entity;
+	unsigned int lod; // Of the mesh, see `struct layman_mesh_lod`.
+};
+
+struct layman_render_queue {
+	struct layman_render_packet *packets;
+	struct layman_render_packet *scratch; // Radix sort ping-pong buffer.
+	size_t count;
+	size_t capacity;
+};
+
+struct layman_render_queue *layman_render_queue_create(void);
+void layman_render_queue_destroy(struct layman_render_queue *queue);
+
+/**
+ * @brief Packs the state of a draw into a sort key.
+ *
+ * From the most significant bits to the least: pass, shader program, material, vertex array, LOD and depth.
+ * Sorting by the key therefore groups the draws by their most expensive state changes first and draws front-to-back
+ * within a group.
+ *
+ * @param[in] pass The pass the draw belongs to.
+ * @param[in] mesh A pointer to the mesh to draw.
+ * @param[in] lod The LOD of the mesh to draw.
+ * @param[in] depth The normalized [0, 1] distance to the camera.
+ *
+ * @return The sort key.
+ */
+uint64_t layman_render_queue_key(enum layman_render_pass pass, const struct layman_mesh *mesh, unsigned int lod, float depth);
+
+void layman_render_queue_clear(struct layman_render_queue *queue);
+bool layman_render_queue_push(struct layman_render_queue *queue, uint64_t key, const struct layman_mesh *mesh, const struct layman_entity *entity, unsigned int lod);
+
+/**
+ * @brief Sorts the packets by their keys.
+ *
+ * This is a stable LSD radix sort on bytes; passes where every key has the same byte are skipped, which is the common
+ * case for the pass and most of the program bits.
+ */
+void layman_render_queue_sort(struct layman_render_queue *queue);
+
+#endif
@@ -4,6 +4,34 @@
 #include "cimgui.h"
 #include "cimgui_impl.h"
 
+// Mirrors the `FrameConstants` uniform block of `shaders/common/frame.glsl` (std140 layout).
+struct layman_frame_constants {
+	mat4 view_matrix;
+	mat4 projection_matrix;
+	mat4 view_projection_matrix;
+
+	vec3 camera;
+	float exposure;
+
+	int mip_count;
+	int light_count;
+	float padding[2];
+
+	struct {
+		vec3 direction;
+		float range;
+		vec3 color;
+		float intensity;
+		vec3 position;
+		float inner_cone_cos;
+		float outer_cone_cos;
+		int type;
+		float padding[2];
+	} lights[MAX_LIGHTS];
+};
+
+_Static_assert(sizeof (struct layman_frame_constants) == 224 + 64 * MAX_LIGHTS, "Frame constants must follow the std140 layout");
+
 struct layman_renderer {
 	// Viewport.
 	float viewport_width;
@@ -22,6 +50,50 @@ struct layman_renderer {
 	float exposure;
 
 	const struct layman_window *window;
+
+	// Bytes of texture data streamed in per frame, see layman_streaming_update().
+	size_t streaming_budget;
+
+	// Largest error on screen of the LODs drawn, in pixels.
+	float lod_error;
+
+	// World-space bounds of everything in the scene, tested against the view frustum before anything gets queued.
+	struct layman_culling *culling;
+	vec4 frustum_planes[6]; // Of the current frame, normalized.
+
+	// The meshlets of the instance being drawn that survived the culling, merged into ranges of indices.
+	uint8_t *meshlets_visible;
+	GLsizei *meshlet_counts;
+	const void **meshlet_offsets;
+	size_t meshlets_capacity;
+
+	// Draws of the current frame, sorted by state to minimize the switching overhead.
+	struct layman_render_queue *queue;
+
+	// Per-instance data of the current frame, in the same order as the queue.
+	struct layman_instance *instances;
+	size_t instances_capacity;
+	GLuint instances_vbo;
+
+	// Shared buffers the meshes get packed into when indirect drawing is enabled, `NULL` otherwise.
+	struct layman_geometry *geometry;
+	GLuint indirect_buffer;
+
+	// One draw command per run of instances of the same mesh, rebuilt every frame.
+	struct layman_draw_command *commands;
+	const struct layman_mesh **command_meshes;
+	size_t commands_count;
+	size_t commands_capacity;
+
+	// Compute program culling the instances of the packed meshes when GPU culling is enabled, `NULL` otherwise.
+	struct layman_shader *culling_shader;
+	GLint uniform_frustum_planes;
+	GLint uniform_instance_count;
+	GLuint visible_instances_vbo; // Instances that survived the culling, compacted per draw command.
+
+	// Per-frame constants, computed once per render and shared by every program.
+	struct layman_frame_constants frame_constants;
+	GLuint frame_constants_ubo;
 	
 	// UI via (c)imgui, aka ig.
 	struct ImGuiContext *ig_context;
@@ -6,6 +6,16 @@ struct layman_scene {
 	size_t entity_count;
 	size_t entity_capacity;
 
+	// World-space bounds of every entity, in the same order as `entities`.
+	vec3 *entity_min;
+	vec3 *entity_max;
+
+	// Hierarchy over the entity bounds, rebuilt lazily by layman_scene_update() whenever it's outdated, or when refitting
+	// degraded it too much.
+	struct layman_bvh *bvh;
+	bool bvh_outdated;
+	uint64_t transforms_generation; // Of the world matrices the bounds were last taken from.
+
 	const struct layman_light **lights;
 	size_t lights_count;
 
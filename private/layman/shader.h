@@ -1,41 +1,60 @@
 #ifndef LAYMAN_PRIVATE_SHADER_H
 #define LAYMAN_PRIVATE_SHADER_H
 
+#include <stdint.h>
+
+// Uniform buffer binding point of the frame constants block, shared by every program.
+#define LAYMAN_FRAME_CONSTANTS_BINDING 0
+
 struct layman_shader {
 	GLuint program_id;
+	enum layman_shader_status status;
+	GLuint stages[3]; // Vertex, fragment and compute shaders, only kept while the program is pending.
+
+	// Where the binary goes once the program is linked, see layman_shader_cache_directory().
+	uint64_t binary_hash;
+	bool binary_cached;
+
+	// Only meaningful for the programs shared through layman_shader_acquire().
+	uint64_t hash;        // Of the sources and defines.
+	const void *context;  // The OpenGL context the program belongs to.
+	size_t references;
 
 	// Material uniforms.
 	GLint uniform_base_color_factor;
-	GLint uniform_base_color_sampler;
-	GLint uniform_normal_sampler;
 	GLint uniform_normal_scale;
-	GLint uniform_metallic_roughness_sampler;
 	GLint uniform_metallic_factor;
 	GLint uniform_roughness_factor;
-	GLint uniform_occlusion_sampler;
 	GLint uniform_occlusion_strength;
-	GLint uniform_emissive_sampler;
 	GLint uniform_emissive_factor;
-
-	// Environment IBL.
-	GLint uniform_environment_mip_count;
-	GLint uniform_environment_lambertian;
-	GLint uniform_environment_ggx;
-	GLint uniform_environment_ggx_lut;
-	GLint uniform_environment_charlie;
-	GLint uniform_environment_charlie_lut;
-
-	// Camera uniforms.
-	GLint uniform_camera;
-
-	// Light uniforms.
-	GLint uniform_lights_type[MAX_LIGHTS];
-	GLint uniform_lights_position[MAX_LIGHTS];
-	GLint uniform_lights_direction[MAX_LIGHTS];
-	GLint uniform_lights_color[MAX_LIGHTS];
-	GLint uniform_lights_intensity[MAX_LIGHTS];
+	GLint uniform_alpha_cutoff;
 };
 
 void layman_shader_switch(const struct layman_shader *shader);
 
+/**
+ * @brief Detects KHR_parallel_shader_compile or ARB_parallel_shader_compile on the current context and lets the driver
+ * compile on as many threads as it wants.
+ *
+ * Without either, layman_shader_poll() blocks until programs are linked.
+ */
+void layman_shader_setup_parallel_compile(void);
+
+/**
+ * @brief Gets a program shared by everything using the same sources and defines, compiling it on first use.
+ *
+ * @param[in] defines Extra preprocessor definitions, one `#define` per line, or `NULL`.
+ *
+ * @remark Programs are told apart by a 64-bit hash of their sources and defines.
+ * @remark Every acquired program must be released with layman_shader_release(), never destroyed directly.
+ *
+ * @return A pointer to a program or `NULL` on failure.
+ */
+struct layman_shader *layman_shader_acquire(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length, const char *defines);
+
+/**
+ * @brief Releases a program obtained from layman_shader_acquire(), destroying it once nothing uses it anymore.
+ */
+void layman_shader_release(struct layman_shader *shader);
+
 #endif
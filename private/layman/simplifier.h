@@ -0,0 +1,44 @@
+#ifndef LAYMAN_PRIVATE_SIMPLIFIER_H
+#define LAYMAN_PRIVATE_SIMPLIFIER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Simplifies triangles down to a number of indices, collapsing the edges whose quadric error is the smallest.
+ *
+ * Vertices only ever collapse onto one of their neighbours, such that the result still indexes the same vertices.
+ * Those on the borders of the mesh or sharing their position with others, along seams of the UVs or normals, never
+ * move: the silhouette holds and no cracks open. Collapses folding a triangle over are rejected.
+ *
+ * @param[in] positions The positions of the vertices (three floats).
+ * @param[in] stride The distance in bytes between positions, or `0` when tightly packed.
+ * @param[in] target_count The number of indices to get down to.
+ * @param[out] destination Where to write the indices, up to `indices_count` of them. Can be `indices` itself.
+ * @param[out] destination_count The number of indices written, above the target when nothing else could collapse.
+ * @param[out] error The farthest the surface moved, relative to the radius of the bounds of the positions.
+ *
+ * @return `false` when out of memory or when an index is out of range, leaving everything untouched.
+ */
+bool layman_simplifier_simplify(const uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, size_t target_count, uint32_t *destination, size_t *destination_count, float *error);
+
+/**
+ * @brief Appends a chain of LODs to the triangles of a mesh, each with a fraction of the triangles of the one before.
+ *
+ * The LODs are simplified as layman_simplifier_simplify() would, one after the other such that the errors add up,
+ * then ordered for the vertex cache without renumbering the vertices. The chain stops early once simplifying barely
+ * removes anything more.
+ *
+ * @param[in,out] indices The full detail, reallocated to make room for the LODs after it.
+ * @param[in] lods_count The most LODs to make, the full detail included. No more than `LAYMAN_MESH_LODS`.
+ * @param[in] ratio Of the triangles of a LOD to those of the one before, within ]0, 1[.
+ * @param[out] lods The range of indices of each LOD, the full detail first.
+ *
+ * @remark Running out of memory only shortens the chain.
+ *
+ * @return The number of LODs made, at least `1`.
+ */
+size_t layman_simplifier_chain(uint32_t **indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, size_t lods_count, float ratio, struct layman_mesh_lod *lods);
+
+#endif
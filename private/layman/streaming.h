@@ -0,0 +1,96 @@
+#ifndef LAYMAN_PRIVATE_STREAMING_H
+#define LAYMAN_PRIVATE_STREAMING_H
+
+#include "glad/glad.h"
+#include <stdint.h>
+
+enum layman_streaming_state {
+	LAYMAN_STREAMING_STATE_RESERVED, // The staging memory is being written to.
+	LAYMAN_STREAMING_STATE_READY,    // Waiting for its turn to be uploaded.
+	LAYMAN_STREAMING_STATE_ISSUED,   // Uploaded, the staging memory is in use until the fence signals.
+};
+
+struct layman_streaming_upload {
+	enum layman_streaming_state state;
+	struct layman_texture *texture; // `NULL` when discarded or cancelled, the memory is then only given back.
+	size_t offset;                  // Of the pixels within the ring.
+	size_t length;
+	size_t end;                     // Where the ring was at once this upload got reserved.
+	GLsync fence;
+};
+
+/**
+ * Ring of staging memory that textures get streamed through, a little every frame.
+ *
+ * The ring is a pixel unpack buffer that stays mapped for its whole life. Pixels are written straight into it, then
+ * copied to their texture by the GPU with glTexSubImage2D(), and the memory is reused once a fence tells that copy
+ * happened. Uploads happen in the order their memory was reserved in.
+ *
+ * Requires `GL_ARB_buffer_storage` (OpenGL 4.4).
+ */
+struct layman_streaming {
+	GLuint buffer;
+	unsigned char *mapped;
+	size_t size;
+
+	// The memory in use spans from the tail to the head, wrapping around.
+	size_t head;
+	size_t tail;
+	size_t used;
+
+	// Oldest first.
+	struct layman_streaming_upload *uploads;
+	size_t uploads_count;
+	size_t uploads_capacity;
+	uint64_t first_ticket; // Ticket of the oldest upload.
+};
+
+/**
+ * @brief Creates a staging ring for the current context.
+ *
+ * @return A pointer to the ring or `NULL` on failure, or when the context doesn't support persistent mappings.
+ */
+struct layman_streaming *layman_streaming_create(size_t size);
+void layman_streaming_destroy(struct layman_streaming *streaming);
+
+/**
+ * @brief Reserves staging memory for the pixels of a texture.
+ *
+ * The memory can be written to from any thread, but the ring itself must only be used from the thread owning the
+ * context. Every reservation must be followed by either layman_streaming_submit() or layman_streaming_discard().
+ *
+ * @param[out] ticket Identifies the reservation.
+ *
+ * @return A pointer to the memory or `NULL` when the ring is too full.
+ */
+unsigned char *layman_streaming_reserve(struct layman_streaming *streaming, size_t length, uint64_t *ticket);
+
+/**
+ * @brief Queues the upload of reserved memory to the first level of a texture.
+ *
+ * The texture must already have its storage, the pixels are expected in its format and type, tightly packed. It shows
+ * a placeholder until then, see layman_texture_provide_placeholder().
+ *
+ * @return Returns `true` on success or `false` if the reservation was already submitted or discarded.
+ */
+bool layman_streaming_submit(struct layman_streaming *streaming, uint64_t ticket, struct layman_texture *texture);
+
+/**
+ * @brief Gives reserved memory back without uploading anything. Does nothing once submitted.
+ */
+void layman_streaming_discard(struct layman_streaming *streaming, uint64_t ticket);
+
+/**
+ * @brief Forgets the pending upload of a texture about to be destroyed.
+ */
+void layman_streaming_cancel(struct layman_streaming *streaming, const struct layman_texture *texture);
+
+/**
+ * @brief Reclaims the memory of completed uploads and issues the next ones, up to a number of bytes.
+ *
+ * At least one upload is issued when there's any, such that textures larger than the budget still make progress.
+ * Meant to be called once per frame.
+ */
+void layman_streaming_update(struct layman_streaming *streaming, size_t budget);
+
+#endif
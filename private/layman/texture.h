@@ -1,6 +1,19 @@
 #ifndef LAYMAN_PRIVATE_TEXTURE_H
 #define LAYMAN_PRIVATE_TEXTURE_H
 
+// Pixels decoded from an encoded image (PNG, JPEG, ...), ready to be uploaded.
+struct layman_image {
+	unsigned char *pixels; // `NULL` until decoded.
+	int width;
+	int height;
+	int components;
+
+	// Staging memory to decode into, see layman_image_stage(). `NULL` when the image owns its pixels.
+	struct layman_streaming *streaming;
+	unsigned char *staging;
+	uint64_t ticket;
+};
+
 struct layman_texture {
 	size_t width;
 	size_t height;
@@ -19,8 +32,123 @@ struct layman_texture {
 	GLenum gl_type;
 	GLenum gl_format;
 	GLenum gl_internal_format;
+	enum layman_texture_format_internal format_internal;
+
+	// Only meaningful for the textures shared through layman_texture_acquire().
+	uint64_t hash;       // Of the encoded image and the kind.
+	size_t size;         // Of the encoded image, guards against hash collisions.
+	bool compressed;     // Whether it was compressed as asked by layman_texture_compression(), or left as is.
+	const void *context; // The OpenGL context the texture belongs to.
+	size_t references;
+
+	// The ring streaming the pixels in, `NULL` once they're uploaded.
+	struct layman_streaming *streaming;
 };
 
 void layman_texture_switch(const struct layman_texture *texture);
 
+/**
+ * @brief Creates a texture with a given number of levels, all allocated upfront.
+ *
+ * The storage is immutable when supported (OpenGL 4.2), its size, format and levels can't change afterwards.
+ * Cubemaps get their six faces allocated along.
+ */
+struct layman_texture *layman_texture_create_with_levels(enum layman_texture_kind kind, size_t width, size_t height, size_t levels, enum layman_texture_type type, enum layman_texture_format format, enum layman_texture_format_internal format_internal);
+
+/**
+ * @brief Uploads the pixels of a single level of a single face, without touching the other levels.
+ *
+ * @param[in] face The face of a cubemap, in the order of `GL_TEXTURE_CUBE_MAP_POSITIVE_X` and following, or `0`.
+ */
+void layman_texture_provide_face_data(struct layman_texture *texture, unsigned int face, unsigned int level, const void *data);
+
+/**
+ * @brief Shows a neutral placeholder until the first level gets uploaded, and the others generated from it.
+ *
+ * Only the smallest level is filled, with white or a flat normal, and made the base level. Uploading the first level
+ * must set the base level back to `0`.
+ */
+void layman_texture_provide_placeholder(struct layman_texture *texture);
+
+size_t layman_texture_level_width(const struct layman_texture *texture, unsigned int level);
+size_t layman_texture_level_height(const struct layman_texture *texture, unsigned int level);
+
+/**
+ * @brief Reserves staging memory for an image to be decoded into, such that its upload can be streamed.
+ *
+ * @remark Only reads the header of the encoded image.
+ *
+ * @return Returns `true` on success or `false` when the image can't be staged, it then gets decoded as usual.
+ */
+bool layman_image_stage(struct layman_image *image, struct layman_streaming *streaming, const unsigned char *data, size_t size);
+
+/**
+ * @brief Decodes an encoded image, into its staging memory if it has some.
+ *
+ * @remark Doesn't touch OpenGL, images can be decoded on any thread.
+ *
+ * @return Returns `true` on success or `false` otherwise.
+ */
+bool layman_image_decode(struct layman_image *image, const unsigned char *data, size_t size);
+
+/**
+ * @brief Frees the pixels of an image, or gives its staging memory back unless it was submitted for upload.
+ */
+void layman_image_free(struct layman_image *image);
+
+/**
+ * @brief Creates a texture for the pixels of a decoded image.
+ *
+ * Staged images are streamed in over the next frames, see layman_streaming_update(). Other images are uploaded now.
+ * Images of the kinds being compressed get their levels compressed on the CPU, they are better left unstaged.
+ */
+struct layman_texture *layman_texture_create_from_image(enum layman_texture_kind kind, const struct layman_image *image);
+
+/**
+ * @brief Creates a texture from levels prepared ahead of time, uploading them as they are.
+ *
+ * @param[in] data Every level one after the other, largest first, each taking layman_texture_data_size() bytes.
+ */
+struct layman_texture *layman_texture_create_from_levels(enum layman_texture_kind kind, size_t width, size_t height, size_t levels, enum layman_texture_format format, enum layman_texture_format_internal format_internal, const unsigned char *data);
+
+/**
+ * @brief Tells how many bytes the pixels of a level take, tightly packed 8-bit channels or compressed blocks.
+ */
+size_t layman_texture_data_size(enum layman_texture_format format, enum layman_texture_format_internal format_internal, size_t width, size_t height);
+
+/**
+ * @brief Picks the internal format layman_texture_create_from_image() gives to an image of a kind.
+ *
+ * @remark Doesn't touch OpenGL, the cooker picks formats the same way.
+ */
+enum layman_texture_format_internal layman_texture_import_format(enum layman_texture_kind kind, const struct layman_image *image, bool compressed);
+
+/**
+ * @brief Tells whether the textures of a kind are compressed when created from images, see layman_texture_compression().
+ */
+bool layman_texture_compressed(enum layman_texture_kind kind);
+
+/**
+ * @brief Tells whether layman_texture_acquire() would reuse an existing texture for an encoded image.
+ */
+bool layman_texture_cached(enum layman_texture_kind kind, const unsigned char *data, size_t size);
+
+/**
+ * @brief Gets a texture shared by everything using the same encoded image for the same kind, creating it on first use.
+ *
+ * @param[in] decoded The image already decoded, or `NULL` to decode it here when needed.
+ *
+ * @remark Textures are told apart by a 64-bit hash of their encoded image, so identical images shipped by different
+ *         models are only decoded and uploaded once. Toggling layman_texture_compression() makes new ones.
+ * @remark Every acquired texture must be released with layman_texture_release(), never destroyed directly.
+ *
+ * @return A pointer to a texture or `NULL` on failure.
+ */
+struct layman_texture *layman_texture_acquire(enum layman_texture_kind kind, const unsigned char *data, size_t size, const struct layman_image *decoded);
+
+/**
+ * @brief Releases a texture obtained from layman_texture_acquire(), destroying it once nothing uses it anymore.
+ */
+void layman_texture_release(struct layman_texture *texture);
+
 #endif
@@ -0,0 +1,97 @@
+#ifndef LAYMAN_PRIVATE_TRANSFORM_H
+#define LAYMAN_PRIVATE_TRANSFORM_H
+
+#include "cglm/cglm.h"
+#include <stdint.h>
+
+#define LAYMAN_TRANSFORM_NONE UINT32_MAX
+
+/**
+ * Every transform of every entity, stored as a structure of arrays.
+ *
+ * Transforms are referred to by stable handles, while their data lives in slots that get reordered such that parents
+ * always come before their children. The world matrices can then be computed in a single forward pass.
+ * The arrays are always padded to a multiple of 4 elements so that the local matrices can be computed 4 at a time.
+ *
+ * There is a single set of transforms shared by the whole library; like the rest of it, it isn't thread-safe.
+ */
+struct layman_transforms {
+	// Local transforms, by slot.
+	float *translation_x;
+	float *translation_y;
+	float *translation_z;
+	float *rotation_x;
+	float *rotation_y;
+	float *rotation_z;
+	float *rotation_w;
+	float *scale_x;
+	float *scale_y;
+	float *scale_z;
+
+	uint32_t *parents; // Handle of the parent of each slot, or LAYMAN_TRANSFORM_NONE.
+	uint8_t *dirty;    // Whether the local transform of each slot changed since the last update.
+
+	// Results of the last update, by slot.
+	mat4 *world_matrices;
+	mat4 *normal_matrices;
+
+	uint32_t *handles; // Handle of each slot.
+	size_t count;
+	size_t capacity;
+
+	uint32_t *slots; // Slot of each handle, or LAYMAN_TRANSFORM_NONE for unused handles.
+	size_t handles_count;
+
+	bool order_outdated; // Whether some children might come before their parent.
+	bool any_dirty;
+	uint64_t generation; // Of the world matrices, bumped by every update that changed some.
+};
+
+/**
+ * @brief Creates an identity transform without a parent.
+ *
+ * @return The handle of the transform or `LAYMAN_TRANSFORM_NONE` on failure.
+ */
+uint32_t layman_transform_create(void);
+
+/**
+ * @brief Destroys a transform.
+ *
+ * @remark Its children become roots, keeping their local transform.
+ */
+void layman_transform_destroy(uint32_t transform);
+
+void layman_transform_set_translation(uint32_t transform, const vec3 translation);
+void layman_transform_set_rotation(uint32_t transform, const versor rotation);
+void layman_transform_set_scale(uint32_t transform, const vec3 scale);
+
+/**
+ * @brief Attaches a transform to a parent, or detaches it with `LAYMAN_TRANSFORM_NONE`.
+ *
+ * @return Returns `true` on success or `false` if it would create a cycle.
+ */
+bool layman_transform_set_parent(uint32_t transform, uint32_t parent);
+
+/**
+ * @brief Recomputes the world and normal matrices of every transform that changed, along with their descendants.
+ *
+ * @return The generation of the world matrices, which only changes when some of them did.
+ */
+uint64_t layman_transforms_update(void);
+
+/**
+ * @brief Copies the local-to-world matrix of a transform, as of the last update.
+ *
+ * @remark Destroyed transforms have the identity.
+ */
+void layman_transform_world_matrix(uint32_t transform, mat4 world_matrix);
+
+/**
+ * @brief Copies the matrix transforming the normals of a transform to world-space, as of the last update.
+ *
+ * @remark The matrix isn't normalized, the normals it transforms must be renormalized. Destroyed transforms have the
+ *         identity.
+ */
+void layman_transform_normal_matrix(uint32_t transform, mat4 normal_matrix);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef LAYMAN_PRIVATE_VERTEX_H
+#define LAYMAN_PRIVATE_VERTEX_H
+
+#include "glad/glad.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// The per-vertex attributes, positions to tangents.
+#define LAYMAN_VERTEX_ATTRIBUTES (LAYMAN_MESH_ATTRIBUTE_TANGENT + 1)
+
+// Interleaved attributes, then the positions alone when they're split.
+#define LAYMAN_VERTEX_STREAMS 2
+
+// How an attribute is stored.
+enum layman_vertex_encoding {
+	LAYMAN_VERTEX_ENCODING_FLOAT,      // 32-bit floats, any attribute.
+	LAYMAN_VERTEX_ENCODING_HALF,       // 16-bit floats, UVs.
+	LAYMAN_VERTEX_ENCODING_UNORM16,    // UVs within [0, 1].
+	LAYMAN_VERTEX_ENCODING_OCTAHEDRAL, // Normals folded onto an octahedron, two snorm16.
+	LAYMAN_VERTEX_ENCODING_SNORM8,     // Tangents, with the sign of the bitangent in W.
+};
+
+/**
+ * Layout of the vertices of a mesh.
+ *
+ * The attributes are interleaved in the order of `enum layman_mesh_attribute`, each in its own encoding. Positions can
+ * be split into a stream of their own, such that passes only needing them fetch nothing else.
+ */
+struct layman_vertex_format {
+	unsigned int attributes; // Bits of the `enum layman_mesh_attribute` values present. Positions are mandatory.
+	enum layman_vertex_encoding encodings[LAYMAN_VERTEX_ATTRIBUTES];
+	bool split;
+};
+
+/**
+ * @brief Makes a format holding some attributes as plain floats, all interleaved in a single stream.
+ */
+struct layman_vertex_format layman_vertex_format_float(unsigned int attributes);
+
+/**
+ * @brief Makes the most compact format holding some attributes without visible loss.
+ *
+ * Normals are octahedral and tangents 8-bit. UVs are 16-bit unsigned integers when within [0, 1], half floats when
+ * close enough to it for their precision and floats otherwise. Everything stays in a single stream.
+ *
+ * @param[in] uvs The UVs to be stored, two floats per vertex, or `NULL`.
+ */
+struct layman_vertex_format layman_vertex_format_compact(unsigned int attributes, const float *uvs, size_t count);
+
+/**
+ * @brief Tells whether a format is consistent: every attribute present in an encoding it supports.
+ */
+bool layman_vertex_format_valid(const struct layman_vertex_format *format);
+
+/**
+ * @brief Tells how many bytes a vertex takes in one of the streams of a format, `0` for an unused stream.
+ */
+size_t layman_vertex_size(const struct layman_vertex_format *format, size_t stream);
+
+/**
+ * @brief Encodes vertices into the streams of a format.
+ *
+ * @param[in] sources The values of each attribute as tightly packed floats, by `enum layman_mesh_attribute`.
+ * @param[out] streams Where to write each stream, layman_vertex_size() bytes per vertex.
+ *
+ * @remark Doesn't touch OpenGL, vertices can be encoded on any thread.
+ */
+void layman_vertex_encode(const struct layman_vertex_format *format, const float *const sources[LAYMAN_VERTEX_ATTRIBUTES], size_t count, void *const streams[LAYMAN_VERTEX_STREAMS]);
+
+/**
+ * @brief Points the attributes of the bound vertex array to the streams of a format.
+ */
+void layman_vertex_point(const struct layman_vertex_format *format, const GLuint buffers[LAYMAN_VERTEX_STREAMS]);
+
+#endif
@@ -9,6 +9,9 @@ struct layman_window {
 	unsigned int height;
 	double start_time;
 	int samples;
+
+	// Staging memory textures are streamed in through, `NULL` when the context doesn't support it.
+	struct layman_streaming *streaming;
 };
 
 /**
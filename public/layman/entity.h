@@ -2,6 +2,7 @@
 #define LAYMAN_PUBLIC_ENTITY_H
 
 #include "model.h"
+#include <stdbool.h>
 
 /**
  * @brief Creates an entity.
@@ -31,4 +32,43 @@ struct layman_entity *layman_entity_create_from_model(const struct layman_model
  */
 void layman_entity_destroy(struct layman_entity *entity);
 
+/**
+ * @brief Sets the translation of an entity, relative to its parent.
+ *
+ * @param[in] entity A pointer to the entity.
+ * @param[in] translation The translation along the x, y and z axes.
+ */
+void layman_entity_translate(struct layman_entity *entity, const float translation[3]);
+
+/**
+ * @brief Sets the rotation of an entity, relative to its parent.
+ *
+ * @param[in] entity A pointer to the entity.
+ * @param[in] rotation A unit quaternion, in the x, y, z, w order.
+ */
+void layman_entity_rotate(struct layman_entity *entity, const float rotation[4]);
+
+/**
+ * @brief Sets the scale of an entity, relative to its parent.
+ *
+ * @param[in] entity A pointer to the entity.
+ * @param[in] scale The scale along the x, y and z axes.
+ */
+void layman_entity_scale(struct layman_entity *entity, const float scale[3]);
+
+/**
+ * @brief Attaches an entity to a parent, such that it follows all of its transformations.
+ *
+ * @param[in] entity A pointer to the entity.
+ * @param[in] parent A pointer to the parent or `NULL` to detach the entity.
+ *
+ * @remark Destroying a parent detaches all of its children, which then keep their transformations, now relative to the world.
+ *
+ * @par Performance
+ * Only the entities that were transformed since the last frame, and their descendants, get their matrices recomputed.
+ *
+ * @return Returns `true` on success or `false` if the parent is a descendant of the entity.
+ */
+bool layman_entity_attach(struct layman_entity *entity, const struct layman_entity *parent);
+
 #endif
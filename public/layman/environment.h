@@ -3,9 +3,38 @@
 
 #include "window.h"
 
+enum layman_environment_quality {
+	LAYMAN_ENVIRONMENT_QUALITY_LOW,
+	LAYMAN_ENVIRONMENT_QUALITY_MEDIUM,
+	LAYMAN_ENVIRONMENT_QUALITY_HIGH,
+};
+
 struct layman_environment *layman_environment_create_from_hdr(const struct layman_window *window, const char *filepath);
 void layman_environment_destroy(struct layman_environment *environment);
 
+/**
+ * @brief Picks how finely the environments created next get prefiltered.
+ *
+ * The tier sets the resolution of the cubemap converted from the HDR image (what the skybox shows), that of the
+ * prefiltered cubemaps and of their lookup tables, and the most samples taken per texel. High is the default.
+ *
+ * | Quality | Cubemap | Specular | Lambertian | LUT | Samples |
+ * |---------|---------|----------|------------|-----|---------|
+ * | Low     | 512     | 128      | 16         | 64  | 32      |
+ * | Medium  | 1024    | 256      | 32         | 128 | 64      |
+ * | High    | 2048    | 512      | 64         | 256 | 128     |
+ *
+ * @param[in] quality The tier to use.
+ *
+ * @remark Environments already created are left as they are.
+ *
+ * @par Performance
+ * Samples are read from the mips of the source cubemap according to their probability, each standing for the texels
+ * around it, which is why so few are needed. Mirror-like levels take a single sample and rougher ones take more, up
+ * to the most of the tier. Each tier roughly divides the GPU time of the previous one by 8.
+ */
+void layman_environment_quality(enum layman_environment_quality quality);
+
 void renderCube(); // FIXME: MOVE ME SOMEWHERE!
 
 #endif
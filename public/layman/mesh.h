@@ -9,6 +9,17 @@ enum layman_mesh_attribute {
 	LAYMAN_MESH_ATTRIBUTE_UV,
 	LAYMAN_MESH_ATTRIBUTE_NORMAL,
 	LAYMAN_MESH_ATTRIBUTE_TANGENT,
+
+	// Per-instance attributes, streamed by the renderer. Matrices take up four consecutive locations.
+	LAYMAN_MESH_ATTRIBUTE_MODEL_MATRIX,
+	LAYMAN_MESH_ATTRIBUTE_NORMAL_MATRIX = LAYMAN_MESH_ATTRIBUTE_MODEL_MATRIX + 4,
+};
+
+// Width of the indices of a mesh.
+enum layman_mesh_index_format {
+	LAYMAN_MESH_INDEX_FORMAT_UINT8,
+	LAYMAN_MESH_INDEX_FORMAT_UINT16,
+	LAYMAN_MESH_INDEX_FORMAT_UINT32,
 };
 
 // TODO: Documentation.
@@ -22,10 +33,12 @@ struct layman_mesh *layman_mesh_create_from_raw(
 	const float *normals, size_t normals_count, size_t normals_stride,
 	// UVs.
 	const float *uvs, size_t uvs_count, size_t uvs_stride,
-	// Indices.
-	const unsigned short *indices, size_t indices_count,
+	// Indices, all in the same format.
+	const void *indices, size_t indices_count, enum layman_mesh_index_format indices_format,
 	// Tangents.
-	const float *tangents, size_t tangents_count, size_t tangents_stride);
+	const float *tangents, size_t tangents_count, size_t tangents_stride,
+	// Material, decides along with the attributes which shader permutation the mesh uses. Can be NULL.
+	const struct layman_material *material);
 
 // TODO: Documentation.
 void layman_mesh_destroy(struct layman_mesh *mesh);
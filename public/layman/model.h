@@ -6,6 +6,25 @@
 // TODO: Documentation.
 struct layman_model *layman_model_load(const struct layman_window *window, const char *filepath);
 
+/**
+ * @brief Loads a model from a pack made by the cooker (`layman-cooker`).
+ *
+ * The pack is mapped in memory and its content goes straight to the GPU: the vertices are already interleaved, the
+ * textures already mipmapped and compressed, and the materials already resolved. Nothing gets parsed or decoded.
+ *
+ * @param[in] window A pointer to the window whose context the model is for.
+ * @param[in] filepath The path of the pack.
+ *
+ * @remark Packs are tied to the version of the library that made them; outdated packs are rejected and must be cooked
+ *         again.
+ *
+ * @par Performance
+ * Loading a pack is bound by the speed of the disk, loading a glTF file by the speed of the CPU decoding its images.
+ *
+ * @return A pointer to a model or `NULL` on failure.
+ */
+struct layman_model *layman_model_load_pack(const struct layman_window *window, const char *filepath);
+
 // TODO: Documentation.
 void layman_model_destroy(struct layman_model *model);
 
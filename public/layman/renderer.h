@@ -8,7 +8,75 @@
 // TODO: Documentation.
 struct layman_renderer *layman_renderer_create(const struct layman_window *window);
 void layman_renderer_destroy(struct layman_renderer *renderer);
-void layman_renderer_render(struct layman_renderer *renderer, const struct layman_camera *camera, const struct layman_scene *scene);
+void layman_renderer_render(struct layman_renderer *renderer, const struct layman_camera *camera, struct layman_scene *scene);
 void layman_renderer_wireframe(struct layman_renderer *renderer, bool enabled);
 
+/**
+ * @brief Enables or disables indirect drawing.
+ *
+ * When enabled, meshes get packed into a few large buffers shared by all of them the first time they're drawn. All the
+ * draws sharing a shader and material are then submitted at once with a single multi-draw call.
+ *
+ * @param[in] renderer A pointer to the renderer.
+ * @param[in] enabled Whether to draw indirectly.
+ *
+ * @remark Requires OpenGL 4.3, which isn't available on Mac.
+ * @remark Meshes that don't have tightly packed positions, normals, UVs and tangents keep being drawn one by one.
+ *
+ * @par Performance
+ * The packed copies of the meshes are never freed until indirect drawing is disabled, which makes it best suited to
+ * static scenes.
+ *
+ * @return Returns `true` on success or `false` if indirect drawing isn't supported.
+ */
+bool layman_renderer_indirect(struct layman_renderer *renderer, bool enabled);
+
+/**
+ * @brief Enables or disables the culling of instances on the GPU.
+ *
+ * When enabled, a compute pass tests every instance of the packed meshes against the view frustum and fills the draw
+ * commands with the visible ones, instead of the CPU testing each of them.
+ *
+ * @param[in] renderer A pointer to the renderer.
+ * @param[in] enabled Whether to cull on the GPU.
+ *
+ * @remark Requires indirect drawing to be enabled, see layman_renderer_indirect(). Disabling indirect drawing also
+ * disables the culling on the GPU.
+ * @remark Meshes that can't be packed are still tested by the CPU.
+ *
+ * @return Returns `true` on success or `false` otherwise.
+ */
+bool layman_renderer_gpu_culling(struct layman_renderer *renderer, bool enabled);
+
+/**
+ * @brief Changes how many bytes of texture data can be streamed in per frame.
+ *
+ * Textures of the models loaded are decoded into staging memory and uploaded over the next frames rather than all at
+ * once, they show up as they arrive.
+ *
+ * @param[in] renderer A pointer to the renderer.
+ * @param[in] budget The number of bytes, `32 MiB` by default. At least one texture is streamed per frame regardless.
+ *
+ * @remark Requires `GL_ARB_buffer_storage` (OpenGL 4.4), textures are otherwise uploaded as soon as they're loaded.
+ *
+ * @par Performance
+ * Lower budgets spread the uploads over more frames and make for a smoother frame time.
+ */
+void layman_renderer_streaming_budget(struct layman_renderer *renderer, size_t budget);
+
+/**
+ * @brief Changes how far, on screen, the LODs of a mesh may stray from its full detail.
+ *
+ * Every mesh is drawn with its coarsest LOD whose error, scaled by the size of its bounds on screen, stays within this
+ * many pixels. Switching to a coarser one takes a margin below that, such that meshes around the threshold don't
+ * keep switching back and forth.
+ *
+ * @param[in] renderer A pointer to the renderer.
+ * @param[in] pixels The largest error, `1` pixel by default. `0` always draws the full detail.
+ *
+ * @par Performance
+ * Distant meshes cost a fraction of their vertices, the higher the error the fewer.
+ */
+void layman_renderer_lod_error(struct layman_renderer *renderer, float pixels);
+
 #endif
@@ -4,6 +4,15 @@
 #include "entity.h"
 #include "light.h"
 #include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Called by the scene queries for every entity matching the query.
+ *
+ * @param[in] entity A pointer to the entity.
+ * @param[in] data The user data given to the query.
+ */
+typedef void (*layman_scene_query_callback)(const struct layman_entity *entity, void *data);
 
 /**
  * @brief Creates a scene.
@@ -30,7 +39,10 @@ void layman_scene_destroy(struct layman_scene *scene);
  * @param[in] entity A pointer to the entity.
  *
  * @par Performance
- * The entities are sorted by their models to minimize the switching overhead during rendering.
+ * The order of insertion doesn't matter; the renderer sorts the meshes of all the entities by shader, material and
+ * vertex array every frame to minimize the switching overhead.
+ * The spatial hierarchy of the scene isn't rebuilt right away, only on the next update (see layman_scene_update());
+ * until then, queries test every entity one by one.
  *
  * @par Ownership/lifetime
  * - The user **maintains** ownership over the entity.
@@ -40,6 +52,62 @@ void layman_scene_destroy(struct layman_scene *scene);
  */
 bool layman_scene_add_entity(struct layman_scene *scene, const struct layman_entity *entity);
 
+/**
+ * @brief Brings the spatial hierarchy of a scene up to date with its entities.
+ *
+ * The renderer does it before every frame. Only queries made between moving entities and the next frame need it.
+ *
+ * @param[in] scene A pointer to the scene.
+ *
+ * @par Performance
+ * When only a few entities moved, the hierarchy is refitted around their new bounds. When many of them did, or when
+ * entities were added, it's rebuilt from scratch.
+ */
+void layman_scene_update(struct layman_scene *scene);
+
+/**
+ * @brief Finds the entities whose bounds intersect a view frustum.
+ *
+ * @param[in] scene A pointer to the scene.
+ * @param[in] view_projection_matrix The column-major matrix from which the frustum planes are extracted.
+ * @param[in] callback The function called for every matching entity.
+ * @param[in] data User data passed along to the callback.
+ *
+ * @remark The test is conservative; some entities just outside of the frustum may be reported as well.
+ *
+ * @return The number of matching entities.
+ */
+size_t layman_scene_query_frustum(const struct layman_scene *scene, const float view_projection_matrix[16], layman_scene_query_callback callback, void *data);
+
+/**
+ * @brief Finds the entities whose bounds intersect a sphere.
+ *
+ * @param[in] scene A pointer to the scene.
+ * @param[in] center The center of the sphere.
+ * @param[in] radius The radius of the sphere.
+ * @param[in] callback The function called for every matching entity.
+ * @param[in] data User data passed along to the callback.
+ *
+ * @return The number of matching entities.
+ */
+size_t layman_scene_query_sphere(const struct layman_scene *scene, const float center[3], float radius, layman_scene_query_callback callback, void *data);
+
+/**
+ * @brief Finds the entities whose bounds are hit by a ray.
+ *
+ * @param[in] scene A pointer to the scene.
+ * @param[in] origin The origin of the ray.
+ * @param[in] direction The direction of the ray, which doesn't need to be normalized.
+ * @param[in] max_distance How far along the ray to look, in multiples of `direction`.
+ * @param[in] callback The function called for every matching entity.
+ * @param[in] data User data passed along to the callback.
+ *
+ * @remark Entities aren't reported in order of distance.
+ *
+ * @return The number of matching entities.
+ */
+size_t layman_scene_query_ray(const struct layman_scene *scene, const float origin[3], const float direction[3], float max_distance, layman_scene_query_callback callback, void *data);
+
 // TODO: Documentation.
 bool layman_scene_add_light(struct layman_scene *scene, const struct layman_light *light);
 
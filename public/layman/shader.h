@@ -1,25 +1,62 @@
 #ifndef LAYMAN_PUBLIC_SHADER_H
 #define LAYMAN_PUBLIC_SHADER_H
 
+#include <stdbool.h>
+
+enum layman_shader_status {
+	LAYMAN_SHADER_STATUS_PENDING, // Still compiling or linking.
+	LAYMAN_SHADER_STATUS_READY,
+	LAYMAN_SHADER_STATUS_FAILED,
+};
+
 // TODO: Documentation.
 struct layman_shader *layman_shader_load_from_files(const char *vertex_filepath, const char *fragment_filepath, const char *compute_filepath);
 
 // TODO: Documentation.
 struct layman_shader *layman_shader_load_from_memory(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length);
 
+/**
+ * @brief Starts loading a shader without waiting for it to compile.
+ *
+ * All the compilation and linkage is queued right away. Drivers supporting `GL_KHR_parallel_shader_compile` then
+ * process it on their own threads, so that many shaders can be compiling at once.
+ *
+ * @remark The shader can't be used until layman_shader_poll() reports it ready.
+ * @remark Shaders are manually managed and must be destroyed with layman_shader_destroy(), even when they failed.
+ *
+ * @return A pointer to a pending shader or `NULL` on failure.
+ */
+struct layman_shader *layman_shader_load_from_memory_async(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length);
+
+/**
+ * @brief Checks whether a shader loaded with layman_shader_load_from_memory_async() is done compiling.
+ *
+ * @param[in] shader A pointer to the shader.
+ *
+ * @remark Without `GL_KHR_parallel_shader_compile`, this waits for the compilation to be over.
+ *
+ * @return The status of the shader.
+ */
+enum layman_shader_status layman_shader_poll(struct layman_shader *shader);
+
+/**
+ * @brief Sets the directory where compiled programs get cached across runs.
+ *
+ * Programs are looked up by a hash of their sources, their preprocessor definitions and the OpenGL vendor, renderer and
+ * version. Binaries rejected by the driver, after an update for instance, are silently recompiled and replaced.
+ *
+ * @param[in] path The path to an existing directory, or `NULL` to disable the cache (the default).
+ *
+ * @remark Only affects the programs loaded afterwards.
+ *
+ * @return Returns `true` on success or `false` otherwise.
+ */
+bool layman_shader_cache_directory(const char *path);
+
 // TODO: Documentation.
 void layman_shader_destroy(struct layman_shader *shader);
 
 // TODO: Documentation.
 void layman_shader_bind_uniform_material(const struct layman_shader *shader, const struct layman_material *material);
 
-// TODO: Documentation.
-void layman_shader_bind_uniform_camera(const struct layman_shader *shader, const struct layman_camera *camera);
-
-// TODO: Documentation.
-void layman_shader_bind_uniform_lights(const struct layman_shader *shader, const struct layman_light **lights, size_t count);
-
-// TODO: Documentation.
-void layman_shader_bind_uniform_environment(const struct layman_shader *shader, const struct layman_environment *environment);
-
 #endif
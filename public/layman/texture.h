@@ -39,6 +39,8 @@ enum layman_texture_format {
 };
 
 enum layman_texture_format_internal {
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_R8,
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_RG8,
 	LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB,
 	LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB8,
 	LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB16F,
@@ -47,9 +49,27 @@ enum layman_texture_format_internal {
 	LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA8,
 	LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA16F,
 	LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA32F,
+
+	// sRGB encoded, converted to linear by the hardware when sampled.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_SRGB8,
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_SRGB8_ALPHA8,
+
+	// Block-compressed, 4x4 pixels per block.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1, // RGB, 4 bits per pixel.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3, // RGBA, 8 bits per pixel.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4, // R, 4 bits per pixel.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC5, // RG, 8 bits per pixel.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC7, // RGBA, 8 bits per pixel.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB,
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3_SRGB,
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_BC7_SRGB,
+
+	// Keep there.
+	LAYMAN_TEXTURE_FORMAT_INTERNAL_COUNT,
 };
 
 // TODO: Documentation.
+// Textures of the albedo and emission kinds must hold sRGB encoded colors in an sRGB internal format.
 struct layman_texture *layman_texture_create(enum layman_texture_kind kind, size_t width, size_t height, bool mipmapping, enum layman_texture_type type, enum layman_texture_format format, enum layman_texture_format_internal format_internal);
 struct layman_texture *layman_texture_create_from_file(enum layman_texture_kind kind, const char *filepath);
 struct layman_texture *layman_texture_create_from_memory(enum layman_texture_kind kind, const unsigned char *data, size_t size);
@@ -57,4 +77,22 @@ void layman_texture_destroy(struct layman_texture *texture);
 void layman_texture_provide_data(struct layman_texture *texture, unsigned int level, unsigned int width, unsigned int height, const void *data);
 void layman_texture_anisotropic_filtering(struct layman_texture *texture, float anisotropy);
 
+/**
+ * @brief Enables or disables the compression of the textures loaded from models.
+ *
+ * Textures get compressed on the CPU as they're imported: BC5 for normals, BC4 for occlusion, sRGB BC1 for the colors
+ * and sRGB BC3 for the colors with an alpha. The other kinds are left uncompressed.
+ *
+ * @param[in] enabled Whether to compress textures.
+ *
+ * @remark Textures already loaded are left as they are.
+ * @remark Textures using block-compressed internal formats take their data already compressed with
+ *         layman_texture_provide_data(), level by level.
+ *
+ * @par Performance
+ * Compressed textures take 4 to 8 times less memory and bandwidth, which usually makes sampling them faster too. The
+ * encoding is fast but lossy, and it slows down imports.
+ */
+void layman_texture_compression(bool enabled);
+
 #endif
@@ -0,0 +1,41 @@
+// =====================================================================================================================
+//                                               FRAME CONSTANTS
+// =====================================================================================================================
+
+// Prepended to every shader by the engine. The renderer fills this block once per frame and binds it to a fixed binding
+// point shared by all programs, so that none of this has to be re-uploaded per mesh.
+// The layout must match `struct layman_frame_constants` exactly (std140 rules).
+
+// KHR_lights_punctual extension.
+// see https://github.com/KhronosGroup/glTF/tree/master/extensions/2.0/Khronos/KHR_lights_punctual
+struct Light
+{
+    vec3 direction;
+    float range;
+
+    vec3 color;
+    float intensity;
+
+    vec3 position;
+    float innerConeCos;
+
+    float outerConeCos;
+    int type;
+
+    vec2 padding;
+};
+
+layout(std140) uniform FrameConstants
+{
+    mat4 u_ViewMatrix;
+    mat4 u_ProjectionMatrix;
+    mat4 u_ViewProjectionMatrix;
+
+    vec3 u_Camera;
+    float u_Exposure;
+
+    int u_MipCount;
+    int u_LightCount;
+
+    Light u_Lights[LIGHT_COUNT];
+};
@@ -12,10 +12,11 @@ const uint cCharlie = 2;
 
 uniform float pfp_roughness;
 uniform uint pfp_sampleCount;
-uniform uint pfp_currentMipLevel;
-uniform uint pfp_width;
+uniform uint pfp_width; // of the source cubemap
+uniform uint pfp_outputWidth; // of the level being written
 uniform float pfp_lodBias;
 uniform uint pfp_distribution; // enum
+uniform bool pfp_lut; // writes the LUT instead of the faces
 
 in vec2 UV;
 
@@ -233,7 +234,8 @@ vec3 filterColor(vec3 N)
 
 		if (NdotL > 0.0)
 		{
-			float lod = 0.0;
+			// Without roughness there's a single sample, covering a texel of the output.
+			float lod = max(log2(float(pfp_width) / float(pfp_outputWidth)), 0.0);
 		
 			if (pfp_roughness > 0.0 || pfp_distribution == cLambertian)
 			{		
@@ -342,9 +344,16 @@ vec3 LUT(float NdotV, float roughness)
 
 void main() 
 {
-	vec2 newUV = UV * float(1 << (pfp_currentMipLevel));
-	 
-	newUV = newUV*2.0-1.0;
+	// Write LUT:
+	// x-coordinate: NdotV
+	// y-coordinate: roughness
+	if (pfp_lut)
+	{
+		outLUT = LUT(UV.x, UV.y);
+		return;
+	}
+
+	vec2 newUV = UV*2.0-1.0;
 	
 	for(int face = 0; face < 6; ++face)
 	{
@@ -359,14 +368,4 @@ void main()
 		//writeFace(face,  texture(uCubeMap, direction).rgb);
 		//writeFace(face,   direction);
 	}
-
-	// Write LUT:
-	// x-coordinate: NdotV
-	// y-coordinate: roughness
-	if (pfp_currentMipLevel == 0)
-	{
-		
-		outLUT = LUT(UV.x, UV.y);
-	
-	}
 }
\ No newline at end of file
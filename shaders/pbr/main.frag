@@ -4,8 +4,6 @@ precision highp float;
 //                                                 TONEMAPPING
 // =====================================================================================================================
 
-uniform float u_Exposure;
-
 const float GAMMA = 2.2;
 const float INV_GAMMA = 1.0 / GAMMA;
 
@@ -130,7 +128,6 @@ uniform int u_SpecularGlossinessUVSet;
 uniform mat3 u_SpecularGlossinessUVTransform;
 
 // IBL
-uniform int u_MipCount;
 uniform samplerCube u_LambertianEnvSampler;
 uniform samplerCube u_GGXEnvSampler;
 uniform sampler2D u_GGXLUT;
@@ -634,24 +631,7 @@ vec3 BRDF_specularSheen(vec3 sheenColor, float sheenIntensity, float sheenRoughn
 //                                                     PUNCTUAL
 // =====================================================================================================================
 
-// KHR_lights_punctual extension.
-// see https://github.com/KhronosGroup/glTF/tree/master/extensions/2.0/Khronos/KHR_lights_punctual
-struct Light
-{
-    vec3 direction;
-    float range;
-
-    vec3 color;
-    float intensity;
-
-    vec3 position;
-    float innerConeCos;
-
-    float outerConeCos;
-    int type;
-
-    vec2 padding;
-};
+// The Light struct and the u_Lights array are part of the frame constants block.
 
 const int LightType_Directional = 0;
 const int LightType_Point = 1;
@@ -725,7 +705,7 @@ vec3 getPunctualRadianceSheen(vec3 sheenColor, float sheenIntensity, float sheen
 vec3 getIBLRadianceGGX(vec3 n, vec3 v, float perceptualRoughness, vec3 specularColor)
 {
     float NdotV = clampedDot(n, v);
-    float lod = clamp(perceptualRoughness * float(u_MipCount), 0.0, float(u_MipCount));
+    float lod = clamp(perceptualRoughness * float(u_MipCount - 1), 0.0, float(u_MipCount - 1));
     vec3 reflection = normalize(reflect(-v, n));
 
     vec2 brdfSamplePoint = clamp(vec2(NdotV, perceptualRoughness), vec2(0.0, 0.0), vec2(1.0, 1.0));
@@ -749,7 +729,7 @@ vec3 getIBLRadianceTransmission(vec3 n, vec3 v, float perceptualRoughness, float
     vec2 brdf = texture(u_GGXLUT, brdfSamplePoint).rg;
 
     // Sample GGX environment map.
-    float lod = clamp(perceptualRoughness * float(u_MipCount), 0.0, float(u_MipCount));
+    float lod = clamp(perceptualRoughness * float(u_MipCount - 1), 0.0, float(u_MipCount - 1));
 
     // Approximate double refraction by assuming a solid sphere beneath the point.
     vec3 r = refract(-v, n, 1.0 / ior);
@@ -780,7 +760,7 @@ vec3 getIBLRadianceLambertian(vec3 n, vec3 diffuseColor)
 vec3 getIBLRadianceCharlie(vec3 n, vec3 v, float sheenRoughness, vec3 sheenColor, float sheenIntensity)
 {
     float NdotV = clampedDot(n, v);
-    float lod = clamp(sheenRoughness * float(u_MipCount), 0.0, float(u_MipCount));
+    float lod = clamp(sheenRoughness * float(u_MipCount - 1), 0.0, float(u_MipCount - 1));
     vec3 reflection = normalize(reflect(-v, n));
 
     vec2 brdfSamplePoint = clamp(vec2(NdotV, sheenRoughness), vec2(0.0, 0.0), vec2(1.0, 1.0));
@@ -813,10 +793,6 @@ vec3 getIBLRadianceSubsurface(vec3 n, vec3 v, float scale, float distortion, flo
 
 out vec4 g_finalColor;
 
-#ifdef USE_PUNCTUAL
-uniform Light u_Lights[LIGHT_COUNT];
-#endif
-
 // Metallic Roughness
 uniform float u_MetallicFactor;
 uniform float u_RoughnessFactor;
@@ -870,8 +846,6 @@ uniform float u_Transmission;
 // Alpha mode
 uniform float u_AlphaCutoff;
 
-uniform vec3 u_Camera;
-
 struct MaterialInfo
 {
     float perceptualRoughness;      // roughness value, as authored by the model creator (input to shader)
@@ -967,7 +941,12 @@ NormalInfo getNormalInfo(vec3 v)
 
     // Compute pertubed normals:
     #ifdef HAS_NORMAL_MAP
-        n = texture(u_NormalSampler, UV).rgb * 2.0 - vec3(1.0);
+        #ifdef HAS_NORMAL_MAP_RG
+            n.xy = texture(u_NormalSampler, UV).rg * 2.0 - vec2(1.0);
+            n.z = sqrt(max(1.0 - dot(n.xy, n.xy), 0.0));
+        #else
+            n = texture(u_NormalSampler, UV).rgb * 2.0 - vec3(1.0);
+        #endif
         n *= vec3(u_NormalScale, u_NormalScale, 1.0);
         n = mat3(t, b, ng) * normalize(n);
     #else
@@ -995,7 +974,8 @@ vec4 getBaseColor()
     #if defined(MATERIAL_SPECULARGLOSSINESS) && defined(HAS_DIFFUSE_MAP)
         baseColor *= sRGBToLinear(texture(u_DiffuseSampler, getDiffuseUV()));
     #elif defined(MATERIAL_METALLICROUGHNESS) && defined(HAS_BASE_COLOR_MAP)
-        baseColor *= sRGBToLinear(texture(u_BaseColorSampler, getBaseColorUV()));
+        // sRGB texture, the hardware linearizes it.
+        baseColor *= texture(u_BaseColorSampler, getBaseColorUV());
     #endif
 
     return baseColor * getVertexColor();
@@ -1320,7 +1300,7 @@ void main()
 #endif
 
 #ifdef USE_PUNCTUAL
-    for (int i = 0; i < LIGHT_COUNT; ++i)
+    for (int i = 0; i < u_LightCount; ++i)
     {
         Light light = u_Lights[i];
 
@@ -1398,7 +1378,8 @@ void main()
 
     f_emissive = u_EmissiveFactor;
 #ifdef HAS_EMISSIVE_MAP
-    f_emissive *= sRGBToLinear(texture(u_EmissiveSampler, getEmissiveUV())).rgb;
+    // sRGB texture, the hardware linearizes it.
+    f_emissive *= texture(u_EmissiveSampler, getEmissiveUV()).rgb;
 #endif
 
     vec3 color = vec3(0);
@@ -1432,6 +1413,10 @@ void main()
 #ifdef HAS_OCCLUSION_MAP
     ao = texture(u_OcclusionSampler,  getOcclusionUV()).r;
     color = mix(color, color * ao, u_OcclusionStrength);
+#elif defined(HAS_OCCLUSION_IN_METALLIC_ROUGHNESS_MAP)
+    // ORM layout, the occlusion is in the red channel.
+    ao = texture(u_MetallicRoughnessSampler, getMetallicRoughnessUV()).r;
+    color = mix(color, color * ao, u_OcclusionStrength);
 #endif
 
 #ifndef DEBUG_OUTPUT // no debug
@@ -231,8 +231,12 @@ in vec3 a_Position;
 out vec3 v_Position;
 
 #ifdef HAS_NORMALS
+#ifdef HAS_NORMALS_OCTAHEDRAL
+in vec2 a_Normal; // Folded onto an octahedron, see octahedralDecode().
+#else
 in vec3 a_Normal;
 #endif
+#endif
 
 #ifdef HAS_TANGENTS
 in vec4 a_Tangent;
@@ -267,9 +271,10 @@ in vec4 a_Color;
 out vec4 v_Color;
 #endif
 
-uniform mat4 u_ViewProjectionMatrix;
-uniform mat4 u_ModelMatrix;
-uniform mat4 u_NormalMatrix;
+// u_ViewProjectionMatrix comes from the frame constants block.
+// The model and normal matrices are per-instance attributes.
+in mat4 a_ModelMatrix;
+in mat4 a_NormalMatrix;
 
 vec4 getPosition()
 {
@@ -286,10 +291,26 @@ vec4 getPosition()
     return pos;
 }
 
+#ifdef HAS_NORMALS_OCTAHEDRAL
+// Unfolds a unit vector from the square its octahedron was flattened to, the lower half being mirrored over the corners.
+vec3 octahedralDecode(vec2 folded)
+{
+    vec3 v = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    if (v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
+}
+#endif
+
 #ifdef HAS_NORMALS
 vec3 getNormal()
 {
+#ifdef HAS_NORMALS_OCTAHEDRAL
+    vec3 normal = octahedralDecode(a_Normal);
+#else
     vec3 normal = a_Normal;
+#endif
 
 #ifdef USE_MORPHING
     normal += getTargetNormal();
@@ -322,18 +343,19 @@ vec3 getTangent()
 
 void main()
 {
-    vec4 pos = u_ModelMatrix * getPosition();
+    vec4 pos = a_ModelMatrix * getPosition();
     v_Position = vec3(pos.xyz) / pos.w;
 
     #ifdef HAS_NORMALS
     #ifdef HAS_TANGENTS
         vec3 tangent = getTangent();
-        vec3 normalW = normalize(vec3(u_NormalMatrix * vec4(getNormal(), 0.0)));
-        vec3 tangentW = normalize(vec3(u_ModelMatrix * vec4(tangent, 0.0)));
-        vec3 bitangentW = cross(normalW, tangentW) * a_Tangent.w;
+        vec3 normalW = normalize(vec3(a_NormalMatrix * vec4(getNormal(), 0.0)));
+        vec3 tangentW = normalize(vec3(a_ModelMatrix * vec4(tangent, 0.0)));
+        // The sign alone, 8-bit tangents don't decode to exactly -1 on every version.
+        vec3 bitangentW = cross(normalW, tangentW) * sign(a_Tangent.w);
         v_TBN = mat3(tangentW, bitangentW, normalW);
     #else // !HAS_TANGENTS
-        v_Normal = normalize(vec3(u_NormalMatrix * vec4(getNormal(), 0.0)));
+        v_Normal = normalize(vec3(a_NormalMatrix * vec4(getNormal(), 0.0)));
     #endif
     #endif // !HAS_NORMALS
 
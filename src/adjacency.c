@@ -0,0 +1,41 @@
+#include "layman.h"
+#include <string.h>
+
+bool layman_adjacency_create(struct layman_adjacency *adjacency, size_t indices_count, size_t vertices_count) {
+	adjacency->offsets = malloc((vertices_count + 1) * sizeof *adjacency->offsets);
+	adjacency->triangles = malloc(indices_count * sizeof *adjacency->triangles + 1);
+	if (!adjacency->offsets || !adjacency->triangles) {
+		layman_adjacency_destroy(adjacency);
+		return false;
+	}
+
+	return true;
+}
+
+void layman_adjacency_destroy(struct layman_adjacency *adjacency) {
+	free(adjacency->offsets);
+	free(adjacency->triangles);
+	adjacency->offsets = NULL;
+	adjacency->triangles = NULL;
+}
+
+void layman_adjacency_build(struct layman_adjacency *adjacency, const uint32_t *indices, size_t indices_count, size_t vertices_count) {
+	memset(adjacency->offsets, 0, (vertices_count + 1) * sizeof *adjacency->offsets);
+
+	for (size_t i = 0; i < indices_count; i++) {
+		adjacency->offsets[indices[i] + 1]++;
+	}
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		adjacency->offsets[v + 1] += adjacency->offsets[v];
+	}
+
+	// Filled from the end of each range, which leaves the offsets back to the start of it.
+	for (size_t i = indices_count; i-- > 0;) {
+		adjacency->triangles[--adjacency->offsets[indices[i] + 1]] = i / 3;
+	}
+
+	// The loop above shifted every range by one vertex.
+	memmove(adjacency->offsets, adjacency->offsets + 1, vertices_count * sizeof *adjacency->offsets);
+	adjacency->offsets[vertices_count] = indices_count;
+}
@@ -0,0 +1,356 @@
+#include "layman.h"
+#include <float.h>
+
+#define BINS 16
+#define LEAF_SIZE 4      // Ranges this small are never split.
+#define MAX_LEAF_SIZE 16 // Ranges this large are always split, even when the heuristic disagrees.
+#define TRAVERSAL_COST 1.0f
+
+// Everything needed during a build, to avoid passing it around everywhere.
+struct build_context {
+	struct layman_bvh *bvh;
+	const vec3 *mins;
+	const vec3 *maxs;
+	vec3 *centroids;
+};
+
+static float half_area(const vec3 min, const vec3 max) {
+	float dx = max[0] - min[0];
+	float dy = max[1] - min[1];
+	float dz = max[2] - min[2];
+
+	return dx * dy + dy * dz + dz * dx;
+}
+
+static void empty_box(vec3 min, vec3 max) {
+	glm_vec3_copy((vec3) { FLT_MAX, FLT_MAX, FLT_MAX}, min);
+	glm_vec3_copy((vec3) { -FLT_MAX, -FLT_MAX, -FLT_MAX}, max);
+}
+
+static void grow_box(vec3 min, vec3 max, const vec3 other_min, const vec3 other_max) {
+	glm_vec3_minv(min, (float *) other_min, min);
+	glm_vec3_maxv(max, (float *) other_max, max);
+}
+
+static void leaf_box(const struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, struct layman_bvh_node *node) {
+	empty_box(node->min, node->max);
+
+	for (uint32_t i = node->first; i < node->first + node->count; i++) {
+		grow_box(node->min, node->max, mins[bvh->indices[i]], maxs[bvh->indices[i]]);
+	}
+}
+
+static int bin_of(const struct build_context *context, uint32_t primitive, int axis, float origin, float scale) {
+	int bin = (context->centroids[primitive][axis] - origin) * scale;
+	return bin < BINS - 1 ? bin : BINS - 1;
+}
+
+static void make_leaf(struct build_context *context, uint32_t node_index) {
+	struct layman_bvh_node *node = context->bvh->nodes + node_index;
+
+	for (uint32_t i = node->first; i < node->first + node->count; i++) {
+		context->bvh->leaves[context->bvh->indices[i]] = node_index;
+	}
+}
+
+static void build_node(struct build_context *context, uint32_t node_index, size_t depth) {
+	struct layman_bvh *bvh = context->bvh;
+	struct layman_bvh_node *node = bvh->nodes + node_index;
+
+	leaf_box(bvh, context->mins, context->maxs, node);
+
+	if (node->count <= LEAF_SIZE || depth + 1 >= LAYMAN_BVH_MAX_DEPTH) {
+		make_leaf(context, node_index);
+		return;
+	}
+
+	// Split along the axis where the centroids are the most spread out.
+	vec3 centroid_min, centroid_max;
+	empty_box(centroid_min, centroid_max);
+	for (uint32_t i = node->first; i < node->first + node->count; i++) {
+		grow_box(centroid_min, centroid_max, context->centroids[bvh->indices[i]], context->centroids[bvh->indices[i]]);
+	}
+
+	vec3 extent;
+	glm_vec3_sub(centroid_max, centroid_min, extent);
+	int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+
+	// Everything is stacked at the same spot, there's no way to split this.
+	if (extent[axis] <= 0) {
+		make_leaf(context, node_index);
+		return;
+	}
+
+	// Bin the primitives by centroid.
+	struct {
+		vec3 min, max;
+		size_t count;
+	} bins[BINS];
+
+	for (size_t b = 0; b < BINS; b++) {
+		empty_box(bins[b].min, bins[b].max);
+		bins[b].count = 0;
+	}
+
+	float scale = BINS / extent[axis];
+
+	for (uint32_t i = node->first; i < node->first + node->count; i++) {
+		uint32_t primitive = bvh->indices[i];
+		int b = bin_of(context, primitive, axis, centroid_min[axis], scale);
+		grow_box(bins[b].min, bins[b].max, context->mins[primitive], context->maxs[primitive]);
+		bins[b].count++;
+	}
+
+	// Sweep from the right to know the cost of every right side, then from the left to evaluate every split.
+	float right_areas[BINS];
+	size_t right_counts[BINS];
+	vec3 sweep_min, sweep_max;
+	size_t sweep_count = 0;
+
+	empty_box(sweep_min, sweep_max);
+	for (size_t b = BINS - 1; b > 0; b--) {
+		grow_box(sweep_min, sweep_max, bins[b].min, bins[b].max);
+		sweep_count += bins[b].count;
+		right_areas[b] = sweep_count ? half_area(sweep_min, sweep_max) : 0;
+		right_counts[b] = sweep_count;
+	}
+
+	float best_cost = FLT_MAX;
+	size_t best_split = 0; // Bins up to and including this one go to the left.
+
+	empty_box(sweep_min, sweep_max);
+	sweep_count = 0;
+	for (size_t b = 0; b < BINS - 1; b++) {
+		grow_box(sweep_min, sweep_max, bins[b].min, bins[b].max);
+		sweep_count += bins[b].count;
+
+		if (sweep_count == 0 || right_counts[b + 1] == 0) {
+			continue;
+		}
+
+		float cost = half_area(sweep_min, sweep_max) * sweep_count + right_areas[b + 1] * right_counts[b + 1];
+		if (cost < best_cost) {
+			best_cost = cost;
+			best_split = b;
+		}
+	}
+
+	float node_area = half_area(node->min, node->max);
+	float split_cost = TRAVERSAL_COST + best_cost / node_area;
+	float leaf_cost = node->count;
+
+	// Unbounded primitives make every cost infinite, in which case the heuristic has nothing to say.
+	bool heuristic_valid = isfinite(split_cost) && best_cost != FLT_MAX;
+
+	if (heuristic_valid && split_cost >= leaf_cost && node->count <= MAX_LEAF_SIZE) {
+		make_leaf(context, node_index);
+		return;
+	}
+
+	// Partition the primitives in place, either along the chosen split or around the middle when there's none.
+	uint32_t *begin = bvh->indices + node->first;
+	uint32_t *end = begin + node->count;
+
+	if (heuristic_valid) {
+		while (begin < end) {
+			if ((size_t) bin_of(context, *begin, axis, centroid_min[axis], scale) <= best_split) {
+				begin++;
+			} else {
+				uint32_t tmp = *begin;
+				*begin = *--end;
+				*end = tmp;
+			}
+		}
+	} else {
+		begin += node->count / 2;
+	}
+
+	uint32_t left_count = begin - (bvh->indices + node->first);
+
+	uint32_t left = bvh->nodes_count;
+	uint32_t right = left + 1;
+	bvh->nodes_count += 2;
+
+	bvh->nodes[left].first = node->first;
+	bvh->nodes[left].count = left_count;
+	bvh->nodes[left].parent = node_index;
+
+	bvh->nodes[right].first = node->first + left_count;
+	bvh->nodes[right].count = node->count - left_count;
+	bvh->nodes[right].parent = node_index;
+
+	node->first = left;
+	node->count = 0;
+
+	build_node(context, left, depth + 1);
+	build_node(context, right, depth + 1);
+}
+
+struct layman_bvh *layman_bvh_create(void) {
+	struct layman_bvh *bvh = malloc(sizeof *bvh);
+	if (!bvh) {
+		return NULL;
+	}
+
+	bvh->nodes = NULL;
+	bvh->nodes_count = 0;
+	bvh->indices = NULL;
+	bvh->leaves = NULL;
+	bvh->count = 0;
+	bvh->built_cost = 0;
+
+	return bvh;
+}
+
+void layman_bvh_destroy(struct layman_bvh *bvh) {
+	if (!bvh) {
+		return;
+	}
+
+	free(bvh->nodes);
+	free(bvh->indices);
+	free(bvh->leaves);
+	free(bvh);
+}
+
+bool layman_bvh_build(struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, size_t count) {
+	free(bvh->nodes);
+	free(bvh->indices);
+	free(bvh->leaves);
+
+	bvh->nodes = NULL;
+	bvh->nodes_count = 0;
+	bvh->indices = NULL;
+	bvh->leaves = NULL;
+	bvh->count = 0;
+	bvh->built_cost = 0;
+
+	if (count == 0) {
+		return true;
+	}
+
+	// A binary tree with `count` leaves at most never has more than `2 * count - 1` nodes.
+	bvh->nodes = malloc((2 * count - 1) * sizeof *bvh->nodes);
+	bvh->indices = malloc(count * sizeof *bvh->indices);
+	bvh->leaves = malloc(count * sizeof *bvh->leaves);
+	vec3 *centroids = malloc(count * sizeof *centroids);
+
+	if (!bvh->nodes || !bvh->indices || !bvh->leaves || !centroids) {
+		free(bvh->nodes);
+		free(bvh->indices);
+		free(bvh->leaves);
+		free(centroids);
+		bvh->nodes = NULL;
+		bvh->indices = NULL;
+		bvh->leaves = NULL;
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		bvh->indices[i] = i;
+		glm_vec3_center((float *) mins[i], (float *) maxs[i], centroids[i]);
+	}
+
+	bvh->count = count;
+	bvh->nodes_count = 1;
+	bvh->nodes[0].first = 0;
+	bvh->nodes[0].count = count;
+	bvh->nodes[0].parent = LAYMAN_BVH_NONE;
+
+	struct build_context context = {
+		.bvh = bvh,
+		.mins = mins,
+		.maxs = maxs,
+		.centroids = centroids,
+	};
+
+	build_node(&context, 0, 0);
+	bvh->built_cost = layman_bvh_cost(bvh);
+
+	free(centroids);
+
+	return true;
+}
+
+void layman_bvh_refit(struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, uint32_t primitive) {
+	if (primitive >= bvh->count) {
+		return;
+	}
+
+	uint32_t node_index = bvh->leaves[primitive];
+	leaf_box(bvh, mins, maxs, bvh->nodes + node_index);
+
+	// Walk up until a node's box doesn't change anymore, its ancestors are then already correct.
+	for (node_index = bvh->nodes[node_index].parent; node_index != LAYMAN_BVH_NONE; node_index = bvh->nodes[node_index].parent) {
+		struct layman_bvh_node *node = bvh->nodes + node_index;
+		const struct layman_bvh_node *left = bvh->nodes + node->first;
+		const struct layman_bvh_node *right = left + 1;
+
+		vec3 min, max;
+		glm_vec3_minv((float *) left->min, (float *) right->min, min);
+		glm_vec3_maxv((float *) left->max, (float *) right->max, max);
+
+		if (memcmp(min, node->min, sizeof min) == 0 && memcmp(max, node->max, sizeof max) == 0) {
+			break;
+		}
+
+		glm_vec3_copy(min, node->min);
+		glm_vec3_copy(max, node->max);
+	}
+}
+
+float layman_bvh_cost(const struct layman_bvh *bvh) {
+	if (bvh->nodes_count == 0) {
+		return 0;
+	}
+
+	// Same costs as the build weighs its splits with, each node being reached in proportion to its area.
+	float cost = 0;
+	for (size_t i = 0; i < bvh->nodes_count; i++) {
+		const struct layman_bvh_node *node = bvh->nodes + i;
+		cost += half_area(node->min, node->max) * (node->count ? node->count : TRAVERSAL_COST);
+	}
+
+	// Everything stacked at the same spot overlaps every query reaching it.
+	float area = half_area(bvh->nodes[0].min, bvh->nodes[0].max);
+	return area > 0 ? cost / area : bvh->count;
+}
+
+size_t layman_bvh_query(const struct layman_bvh *bvh, const vec3 *mins, const vec3 *maxs, layman_bvh_overlap overlap, const void *shape, layman_bvh_visit visit, void *data) {
+	if (bvh->nodes_count == 0) {
+		return 0;
+	}
+
+	// The build caps the depth, so the stack can never overflow.
+	uint32_t stack[LAYMAN_BVH_MAX_DEPTH + 1];
+	size_t stack_size = 0;
+	size_t visited = 0;
+
+	stack[stack_size++] = 0;
+
+	while (stack_size > 0) {
+		const struct layman_bvh_node *node = bvh->nodes + stack[--stack_size];
+
+		if (!overlap(node->min, node->max, shape)) {
+			continue;
+		}
+
+		if (node->count == 0) {
+			stack[stack_size++] = node->first + 1;
+			stack[stack_size++] = node->first;
+			continue;
+		}
+
+		for (uint32_t i = node->first; i < node->first + node->count; i++) {
+			uint32_t primitive = bvh->indices[i];
+
+			// Small leaves hold several primitives, each of which can miss the shape on its own.
+			if (node->count == 1 || overlap(mins[primitive], maxs[primitive], shape)) {
+				visit(primitive, data);
+				visited++;
+			}
+		}
+	}
+
+	return visited;
+}
@@ -0,0 +1,348 @@
+#include "layman.h"
+#include <stdint.h>
+#include <string.h>
+
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+// Below this, starting threads costs more than it saves. The small levels of a mipmap chain all end up there.
+#define PARALLEL_BLOCKS_MIN 1024
+
+// What a thread needs to compress its rows of blocks.
+struct encoding {
+	enum layman_texture_format_internal format;
+	const unsigned char *pixels;
+	size_t width;
+	size_t height;
+	size_t components;
+	unsigned char *blocks;
+	size_t block_size;
+	size_t columns;
+};
+
+bool layman_compression_block_format(enum layman_texture_format_internal format) {
+	switch (format) {
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC5:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC7:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3_SRGB:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC7_SRGB:
+		    return true;
+	    default:
+		    return false;
+	}
+}
+
+// Bytes per block of 4x4 pixels.
+static size_t block_size(enum layman_texture_format_internal format) {
+	switch (format) {
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4:
+		    return 8;
+	    default:
+		    return 16;
+	}
+}
+
+size_t layman_compression_size(enum layman_texture_format_internal format, size_t width, size_t height) {
+	return ((width + 3) / 4) * ((height + 3) / 4) * block_size(format);
+}
+
+// Gathers the pixels of a block as RGBA, opaque when there's no alpha.
+// Blocks hanging off the edges of the image repeat its last row and column, which doesn't skew their endpoints.
+static void fetch(const struct encoding *encoding, size_t block_x, size_t block_y, unsigned char block[64]) {
+	for (size_t y = 0; y < 4; y++) {
+		size_t pixel_y = block_y * 4 + y < encoding->height ? block_y * 4 + y : encoding->height - 1;
+
+		for (size_t x = 0; x < 4; x++) {
+			size_t pixel_x = block_x * 4 + x < encoding->width ? block_x * 4 + x : encoding->width - 1;
+			const unsigned char *pixel = encoding->pixels + (pixel_y * encoding->width + pixel_x) * encoding->components;
+			unsigned char *texel = block + (y * 4 + x) * 4;
+
+			texel[0] = pixel[0];
+			texel[1] = encoding->components > 1 ? pixel[1] : 0;
+			texel[2] = encoding->components > 2 ? pixel[2] : 0;
+			texel[3] = encoding->components > 3 ? pixel[3] : 255;
+		}
+	}
+}
+
+// Smallest and largest value of every channel over a block.
+static void bounds(const unsigned char block[64], unsigned char min[4], unsigned char max[4]) {
+	#ifdef USE_SSE2
+	__m128i rows[4];
+	for (size_t i = 0; i < 4; i++) {
+		rows[i] = _mm_loadu_si128((const __m128i *) (block + i * 16));
+	}
+
+	__m128i low = _mm_min_epu8(_mm_min_epu8(rows[0], rows[1]), _mm_min_epu8(rows[2], rows[3]));
+	__m128i high = _mm_max_epu8(_mm_max_epu8(rows[0], rows[1]), _mm_max_epu8(rows[2], rows[3]));
+
+	// Fold the 4 pixels left in each register onto the first one.
+	low = _mm_min_epu8(low, _mm_srli_si128(low, 8));
+	low = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+	high = _mm_max_epu8(high, _mm_srli_si128(high, 8));
+	high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+
+	int32_t packed_min = _mm_cvtsi128_si32(low);
+	int32_t packed_max = _mm_cvtsi128_si32(high);
+	memcpy(min, &packed_min, 4);
+	memcpy(max, &packed_max, 4);
+	#else
+	for (size_t c = 0; c < 4; c++) {
+		min[c] = 255;
+		max[c] = 0;
+	}
+
+	for (size_t i = 0; i < 16; i++) {
+		for (size_t c = 0; c < 4; c++) {
+			unsigned char value = block[i * 4 + c];
+			min[c] = value < min[c] ? value : min[c];
+			max[c] = value > max[c] ? value : max[c];
+		}
+	}
+	#endif
+}
+
+static uint16_t pack_565(const unsigned char color[3]) {
+	return (uint16_t) (((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+static void unpack_565(uint16_t packed, int color[3]) {
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+
+	// Replicate the high bits into the low ones, such that white stays white.
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+static void write_16(unsigned char *out, uint16_t value) {
+	out[0] = value & 0xFF;
+	out[1] = value >> 8;
+}
+
+// Encodes the color of a block as BC1, always in its 4 colors mode as BC3 requires. sRGB colors are fitted as they are.
+// The endpoints are the corners of the bounding box of the colors, inset a bit since its extremes are rarely hit
+// exactly. This isn't as precise as fitting the principal axis, but it's fast enough to run on every imported texture.
+static void encode_color(const unsigned char block[64], unsigned char out[8]) {
+	unsigned char min[4], max[4];
+	bounds(block, min, max);
+
+	for (size_t c = 0; c < 3; c++) {
+		unsigned char inset = (max[c] - min[c]) >> 4;
+		min[c] += inset;
+		max[c] -= inset;
+	}
+
+	// Every channel of the maximum is larger, so is its packed value; the block can't fall in the 3 colors mode.
+	uint16_t color_0 = pack_565(max);
+	uint16_t color_1 = pack_565(min);
+
+	write_16(out + 0, color_0);
+	write_16(out + 2, color_1);
+
+	// The palette as the GPU decodes it.
+	int palette[4][3];
+	unpack_565(color_0, palette[0]);
+	unpack_565(color_1, palette[1]);
+	for (size_t c = 0; c < 3; c++) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	uint32_t indices = 0;
+	if (color_0 != color_1) {
+		for (size_t i = 0; i < 16; i++) {
+			const unsigned char *texel = block + i * 4;
+
+			uint32_t best = 0;
+			int best_distance = INT32_MAX;
+			for (uint32_t p = 0; p < 4; p++) {
+				int dr = texel[0] - palette[p][0];
+				int dg = texel[1] - palette[p][1];
+				int db = texel[2] - palette[p][2];
+				int distance = dr * dr + dg * dg + db * db;
+
+				if (distance < best_distance) {
+					best = p;
+					best_distance = distance;
+				}
+			}
+
+			indices |= best << (2 * i);
+		}
+	}
+
+	out[4] = indices & 0xFF;
+	out[5] = (indices >> 8) & 0xFF;
+	out[6] = (indices >> 16) & 0xFF;
+	out[7] = indices >> 24;
+}
+
+// Encodes a single channel of a block as BC4, which is also how BC3 stores its alpha.
+// The endpoints are the extremes of the channel, in the 8 values mode whose palette evenly spans them.
+static void encode_channel(const unsigned char block[64], size_t channel, unsigned char out[8]) {
+	unsigned char min = 255, max = 0;
+	for (size_t i = 0; i < 16; i++) {
+		unsigned char value = block[i * 4 + channel];
+		min = value < min ? value : min;
+		max = value > max ? value : max;
+	}
+
+	out[0] = max;
+	out[1] = min;
+
+	uint64_t indices = 0;
+	if (max != min) {
+		int range = max - min;
+
+		for (size_t i = 0; i < 16; i++) {
+			// Step from the maximum (0) to the minimum (7), then remap to the order of the palette.
+			// Index 0 is the maximum, 1 the minimum and 2 to 7 the values between them.
+			uint64_t step = ((max - block[i * 4 + channel]) * 7 + range / 2) / range;
+			uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+
+			indices |= index << (3 * i);
+		}
+	}
+
+	for (size_t i = 0; i < 6; i++) {
+		out[2 + i] = (indices >> (8 * i)) & 0xFF;
+	}
+}
+
+static void encode_row(size_t row, void *data) {
+	const struct encoding *encoding = data;
+	unsigned char *out = encoding->blocks + row * encoding->columns * encoding->block_size;
+
+	for (size_t column = 0; column < encoding->columns; column++, out += encoding->block_size) {
+		unsigned char block[64];
+		fetch(encoding, column, row, block);
+
+		switch (encoding->format) {
+		    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1:
+		    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB:
+			    encode_color(block, out);
+			    break;
+
+		    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3:
+		    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3_SRGB:
+			    encode_channel(block, 3, out);
+			    encode_color(block, out + 8);
+			    break;
+
+		    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4:
+			    encode_channel(block, 0, out);
+			    break;
+
+		    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC5:
+			    encode_channel(block, 0, out);
+			    encode_channel(block, 1, out + 8);
+			    break;
+
+		    default:
+			    break;
+		}
+	}
+}
+
+bool layman_compression_encode(enum layman_texture_format_internal format, const unsigned char *pixels, size_t width, size_t height, size_t components, unsigned char *blocks) {
+	// BC7 is only ever uploaded from data compressed offline, a decent encoder for it is far too slow for import time.
+	switch (format) {
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3_SRGB:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4:
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC5:
+		    break;
+	    default:
+		    return false;
+	}
+
+	struct encoding encoding = {
+		.format = format,
+		.pixels = pixels,
+		.width = width,
+		.height = height,
+		.components = components,
+		.blocks = blocks,
+		.block_size = block_size(format),
+		.columns = (width + 3) / 4,
+	};
+
+	size_t rows = (height + 3) / 4;
+	if (rows * encoding.columns < PARALLEL_BLOCKS_MIN) {
+		for (size_t row = 0; row < rows; row++) {
+			encode_row(row, &encoding);
+		}
+	} else {
+		layman_parallel_for(rows, encode_row, &encoding);
+	}
+
+	return true;
+}
+
+void layman_compression_downsample(const unsigned char *pixels, size_t width, size_t height, size_t components, unsigned char *output) {
+	size_t new_width = width > 1 ? width / 2 : 1;
+	size_t new_height = height > 1 ? height / 2 : 1;
+
+	// Sizes of 1 have nothing to average with along their axis.
+	size_t step_x = width > 1 ? components : 0;
+	size_t step_y = height > 1 ? width * components : 0;
+
+	for (size_t y = 0; y < new_height; y++) {
+		for (size_t x = 0; x < new_width; x++) {
+			const unsigned char *source = pixels + (y * 2 * width + x * 2) * components;
+			unsigned char *destination = output + (y * new_width + x) * components;
+
+			for (size_t c = 0; c < components; c++) {
+				unsigned int sum = source[c] + source[c + step_x] + source[c + step_y] + source[c + step_x + step_y];
+				destination[c] = (sum + 2) / 4;
+			}
+		}
+	}
+}
+
+bool layman_compression_mipmap(const unsigned char *pixels, size_t width, size_t height, size_t components, size_t levels, void (*visit)(size_t level, const unsigned char *pixels, size_t width, size_t height, void *data), void *data) {
+	// The levels get downsampled back and forth between two buffers, both large enough for the second level.
+	size_t scratch_size = MAX(width / 2, 1) * MAX(height / 2, 1) * components;
+	unsigned char *scratch[2] = {NULL, NULL};
+	if (levels > 1) {
+		scratch[0] = malloc(scratch_size);
+		scratch[1] = malloc(scratch_size);
+		if (!scratch[0] || !scratch[1]) {
+			free(scratch[0]);
+			free(scratch[1]);
+			return false;
+		}
+	}
+
+	for (size_t level = 0; level < levels; level++) {
+		size_t level_width = MAX(width >> level, 1);
+		size_t level_height = MAX(height >> level, 1);
+
+		if (level > 0) {
+			layman_compression_downsample(pixels, MAX(width >> (level - 1), 1), MAX(height >> (level - 1), 1), components, scratch[level % 2]);
+			pixels = scratch[level % 2];
+		}
+
+		visit(level, pixels, level_width, level_height, data);
+	}
+
+	free(scratch[0]);
+	free(scratch[1]);
+
+	return true;
+}
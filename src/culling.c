@@ -0,0 +1,280 @@
+#include "layman.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define USE_SSE
+#endif
+
+#define SPHERES_CAPACITY_STEP 256 // Must be a multiple of 4.
+
+// Relative to the squared scale, how far from a similarity a matrix can be for the cones of meshlets to be tested.
+#define SIMILARITY_TOLERANCE 1e-3f
+
+struct layman_culling *layman_culling_create(void) {
+	struct layman_culling *culling = malloc(sizeof *culling);
+	if (!culling) {
+		return NULL;
+	}
+
+	culling->center_x = NULL;
+	culling->center_y = NULL;
+	culling->center_z = NULL;
+	culling->radius = NULL;
+	culling->visible = NULL;
+	culling->meshes = NULL;
+	culling->entities = NULL;
+	culling->lods = NULL;
+	culling->count = 0;
+	culling->capacity = 0;
+
+	return culling;
+}
+
+void layman_culling_destroy(struct layman_culling *culling) {
+	if (!culling) {
+		return;
+	}
+
+	free(culling->center_x);
+	free(culling->center_y);
+	free(culling->center_z);
+	free(culling->radius);
+	free(culling->visible);
+	free(culling->meshes);
+	free(culling->entities);
+	free(culling->lods);
+	free(culling);
+}
+
+void layman_culling_clear(struct layman_culling *culling) {
+	culling->count = 0;
+}
+
+static bool grow(struct layman_culling *culling) {
+	size_t new_capacity = culling->capacity + SPHERES_CAPACITY_STEP;
+
+	#define GROW(array) do { \
+		void *new_array = realloc(culling->array, new_capacity * sizeof *culling->array); \
+		if (!new_array) { \
+			return false; \
+		} \
+		culling->array = new_array; \
+	} while (0)
+
+	GROW(center_x);
+	GROW(center_y);
+	GROW(center_z);
+	GROW(radius);
+	GROW(visible);
+	GROW(meshes);
+	GROW(entities);
+	GROW(lods);
+
+	#undef GROW
+
+	// The padding must hold valid numbers since it gets tested along with the rest.
+	for (size_t i = culling->capacity; i < new_capacity; i++) {
+		culling->center_x[i] = 0;
+		culling->center_y[i] = 0;
+		culling->center_z[i] = 0;
+		culling->radius[i] = 0;
+	}
+
+	culling->capacity = new_capacity;
+
+	return true;
+}
+
+void layman_culling_sphere(const struct layman_mesh *mesh, mat4 model_matrix, vec4 sphere) {
+	glm_mat4_mulv3(model_matrix, (float *) mesh->sphere_center, 1, sphere);
+
+	// The radius grows with the largest scaling factor of the matrix.
+	float scale_x = glm_vec3_norm(model_matrix[0]);
+	float scale_y = glm_vec3_norm(model_matrix[1]);
+	float scale_z = glm_vec3_norm(model_matrix[2]);
+	sphere[3] = mesh->sphere_radius * fmaxf(scale_x, fmaxf(scale_y, scale_z));
+}
+
+bool layman_culling_push(struct layman_culling *culling, const struct layman_mesh *mesh, const struct layman_entity *entity, uint8_t *lod, mat4 model_matrix) {
+	if (culling->count == culling->capacity && !grow(culling)) {
+		return false;
+	}
+
+	vec4 sphere;
+	layman_culling_sphere(mesh, model_matrix, sphere);
+
+	size_t i = culling->count;
+	culling->center_x[i] = sphere[0];
+	culling->center_y[i] = sphere[1];
+	culling->center_z[i] = sphere[2];
+	culling->radius[i] = sphere[3];
+	culling->meshes[i] = mesh;
+	culling->entities[i] = entity;
+	culling->lods[i] = lod;
+	culling->count++;
+
+	return true;
+}
+
+size_t layman_culling_frustum(struct layman_culling *culling, mat4 view_projection_matrix) {
+	// Normalized planes, a point is inside when `dot(plane.xyz, point) + plane.w >= 0`.
+	vec4 planes[6];
+	glm_frustum_planes(view_projection_matrix, planes);
+
+	size_t visible_count = 0;
+
+	#ifdef USE_SSE
+	for (size_t i = 0; i < culling->count; i += 4) {
+		__m128 x = _mm_loadu_ps(culling->center_x + i);
+		__m128 y = _mm_loadu_ps(culling->center_y + i);
+		__m128 z = _mm_loadu_ps(culling->center_z + i);
+		__m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(culling->radius + i));
+		__m128 inside = _mm_setzero_ps();
+
+		for (size_t p = 0; p < 6; p++) {
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes[p][0])), _mm_mul_ps(y, _mm_set1_ps(planes[p][1]))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(planes[p][2])), _mm_set1_ps(planes[p][3]))
+			);
+
+			__m128 plane_inside = _mm_cmpge_ps(distance, negative_radius);
+			inside = p == 0 ? plane_inside : _mm_and_ps(inside, plane_inside);
+		}
+
+		int mask = _mm_movemask_ps(inside);
+
+		for (size_t lane = 0; lane < 4 && i + lane < culling->count; lane++) {
+			culling->visible[i + lane] = (mask >> lane) & 1;
+			visible_count += culling->visible[i + lane];
+		}
+	}
+	#else
+	for (size_t i = 0; i < culling->count; i++) {
+		bool inside = true;
+
+		for (size_t p = 0; p < 6 && inside; p++) {
+			float distance = planes[p][0] * culling->center_x[i] + planes[p][1] * culling->center_y[i] + planes[p][2] * culling->center_z[i] + planes[p][3];
+			inside = distance >= -culling->radius[i];
+		}
+
+		culling->visible[i] = inside;
+		visible_count += inside;
+	}
+	#endif
+
+	return visible_count;
+}
+
+// Whether a matrix only rotates, uniformly scales and translates, keeping the facing of triangles as it is. Returns the
+// squared scale.
+static bool similarity(mat4 matrix, float *scale_squared) {
+	float xx = glm_vec3_dot(matrix[0], matrix[0]);
+	float yy = glm_vec3_dot(matrix[1], matrix[1]);
+	float zz = glm_vec3_dot(matrix[2], matrix[2]);
+	float tolerance = SIMILARITY_TOLERANCE * xx;
+
+	vec3 cross;
+	glm_vec3_cross(matrix[0], matrix[1], cross);
+
+	*scale_squared = xx;
+
+	return fabsf(yy - xx) <= tolerance && fabsf(zz - xx) <= tolerance
+		&& fabsf(glm_vec3_dot(matrix[0], matrix[1])) <= tolerance
+		&& fabsf(glm_vec3_dot(matrix[0], matrix[2])) <= tolerance
+		&& fabsf(glm_vec3_dot(matrix[1], matrix[2])) <= tolerance
+		&& glm_vec3_dot(cross, matrix[2]) > 0; // Mirroring flips the winding.
+}
+
+size_t layman_culling_meshlets(const struct layman_meshlets *meshlets, mat4 model_matrix, vec4 planes[6], vec3 camera, bool cones, uint8_t *visible) {
+	// The planes go to local space instead of every meshlet to world space, distances to them staying the same.
+	vec4 local_planes[6];
+	for (size_t p = 0; p < 6; p++) {
+		for (size_t k = 0; k < 3; k++) {
+			local_planes[p][k] = glm_vec3_dot(planes[p], model_matrix[k]);
+		}
+
+		local_planes[p][3] = glm_vec3_dot(planes[p], model_matrix[3]) + planes[p][3];
+	}
+
+	// The distances are still in world units, unlike the radii.
+	float scale = fmaxf(glm_vec3_norm(model_matrix[0]), fmaxf(glm_vec3_norm(model_matrix[1]), glm_vec3_norm(model_matrix[2])));
+
+	// The camera goes to local space too, which only keeps the cones as they are without shearing or mirroring. Cones
+	// that can't be tested are made to pass.
+	float scale_squared;
+	cones = cones && similarity(model_matrix, &scale_squared);
+
+	vec3 local_camera = GLM_VEC3_ZERO_INIT;
+	if (cones) {
+		vec3 offset;
+		glm_vec3_sub(camera, model_matrix[3], offset);
+		for (size_t k = 0; k < 3; k++) {
+			local_camera[k] = glm_vec3_dot(model_matrix[k], offset) / scale_squared;
+		}
+	}
+
+	size_t visible_count = 0;
+
+	#ifdef USE_SSE
+	for (size_t i = 0; i < meshlets->count; i += 4) {
+		__m128 x = _mm_loadu_ps(meshlets->center_x + i);
+		__m128 y = _mm_loadu_ps(meshlets->center_y + i);
+		__m128 z = _mm_loadu_ps(meshlets->center_z + i);
+		__m128 radius = _mm_loadu_ps(meshlets->radius + i);
+		__m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(radius, _mm_set1_ps(scale)));
+		__m128 inside = _mm_setzero_ps();
+
+		for (size_t p = 0; p < 6; p++) {
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(local_planes[p][0])), _mm_mul_ps(y, _mm_set1_ps(local_planes[p][1]))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(local_planes[p][2])), _mm_set1_ps(local_planes[p][3]))
+			);
+
+			__m128 plane_inside = _mm_cmpge_ps(distance, negative_radius);
+			inside = p == 0 ? plane_inside : _mm_and_ps(inside, plane_inside);
+		}
+
+		// Back-facing when the direction from the camera is within the complement of the cone, the sphere included.
+		if (cones) {
+			__m128 dx = _mm_sub_ps(x, _mm_set1_ps(local_camera[0]));
+			__m128 dy = _mm_sub_ps(y, _mm_set1_ps(local_camera[1]));
+			__m128 dz = _mm_sub_ps(z, _mm_set1_ps(local_camera[2]));
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+			__m128 dot = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(meshlets->axis_x + i)), _mm_mul_ps(dy, _mm_loadu_ps(meshlets->axis_y + i))),
+				_mm_mul_ps(dz, _mm_loadu_ps(meshlets->axis_z + i))
+			);
+
+			__m128 back_facing = _mm_cmpge_ps(dot, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(meshlets->cutoff + i), length), radius));
+			inside = _mm_andnot_ps(back_facing, inside);
+		}
+
+		int mask = _mm_movemask_ps(inside);
+
+		for (size_t lane = 0; lane < 4 && i + lane < meshlets->count; lane++) {
+			visible[i + lane] = (mask >> lane) & 1;
+			visible_count += visible[i + lane];
+		}
+	}
+	#else
+	for (size_t i = 0; i < meshlets->count; i++) {
+		bool inside = true;
+
+		for (size_t p = 0; p < 6 && inside; p++) {
+			float distance = local_planes[p][0] * meshlets->center_x[i] + local_planes[p][1] * meshlets->center_y[i] + local_planes[p][2] * meshlets->center_z[i] + local_planes[p][3];
+			inside = distance >= -meshlets->radius[i] * scale;
+		}
+
+		if (inside && cones) {
+			vec3 direction = {meshlets->center_x[i] - local_camera[0], meshlets->center_y[i] - local_camera[1], meshlets->center_z[i] - local_camera[2]};
+			vec3 axis = {meshlets->axis_x[i], meshlets->axis_y[i], meshlets->axis_z[i]};
+			inside = glm_vec3_dot(direction, axis) < meshlets->cutoff[i] * glm_vec3_norm(direction) + meshlets->radius[i];
+		}
+
+		visible[i] = inside;
+		visible_count += inside;
+	}
+	#endif
+
+	return visible_count;
+}
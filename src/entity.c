@@ -1,4 +1,5 @@
 #include "layman.h"
+#include <float.h>
 
 struct layman_entity *layman_entity_create(void) {
 	struct layman_entity *entity = malloc(sizeof *entity);
@@ -7,7 +8,13 @@ struct layman_entity *layman_entity_create(void) {
 	}
 
 	entity->model = NULL;
-	glm_vec3_zero(entity->position);
+	entity->lods = NULL;
+
+	entity->transform = layman_transform_create();
+	if (entity->transform == LAYMAN_TRANSFORM_NONE) {
+		free(entity);
+		return NULL;
+	}
 
 	return entity;
 }
@@ -18,11 +25,73 @@ struct layman_entity *layman_entity_create_from_model(const struct layman_model
 		return NULL;
 	}
 
+	entity->lods = calloc((model ? model->meshes_count : 0) + 1, sizeof *entity->lods);
+	if (!entity->lods) {
+		layman_entity_destroy(entity);
+		return NULL;
+	}
+
 	entity->model = model;
 
 	return entity;
 }
 
 void layman_entity_destroy(struct layman_entity *entity) {
+	if (!entity) {
+		return;
+	}
+
+	layman_transform_destroy(entity->transform);
+	free(entity->lods);
 	free(entity);
 }
+
+void layman_entity_translate(struct layman_entity *entity, const float translation[3]) {
+	layman_transform_set_translation(entity->transform, translation);
+}
+
+void layman_entity_rotate(struct layman_entity *entity, const float rotation[4]) {
+	layman_transform_set_rotation(entity->transform, rotation);
+}
+
+void layman_entity_scale(struct layman_entity *entity, const float scale[3]) {
+	layman_transform_set_scale(entity->transform, scale);
+}
+
+bool layman_entity_attach(struct layman_entity *entity, const struct layman_entity *parent) {
+	return layman_transform_set_parent(entity->transform, parent ? parent->transform : LAYMAN_TRANSFORM_NONE);
+}
+
+void layman_entity_model_matrix(const struct layman_entity *entity, mat4 model_matrix) {
+	layman_transform_world_matrix(entity->transform, model_matrix);
+}
+
+void layman_entity_normal_matrix(const struct layman_entity *entity, mat4 normal_matrix) {
+	layman_transform_normal_matrix(entity->transform, normal_matrix);
+}
+
+void layman_entity_bounds(const struct layman_entity *entity, vec3 min, vec3 max) {
+	mat4 model_matrix;
+	layman_entity_model_matrix(entity, model_matrix);
+
+	if (!entity->model) {
+		glm_vec3_copy(model_matrix[3], min);
+		glm_vec3_copy(model_matrix[3], max);
+		return;
+	}
+
+	// Transforming infinite boxes would only produce NaNs.
+	if (entity->model->aabb_min[0] == -FLT_MAX || entity->model->aabb_max[0] == FLT_MAX) {
+		glm_vec3_copy((vec3) { -FLT_MAX, -FLT_MAX, -FLT_MAX}, min);
+		glm_vec3_copy((vec3) { FLT_MAX, FLT_MAX, FLT_MAX}, max);
+		return;
+	}
+
+	vec3 local[2], world[2];
+	glm_vec3_copy((float *) entity->model->aabb_min, local[0]);
+	glm_vec3_copy((float *) entity->model->aabb_max, local[1]);
+	glm_aabb_transform(local, model_matrix, world);
+
+	glm_vec3_copy(world[0], min);
+	glm_vec3_copy(world[1], max);
+}
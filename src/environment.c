@@ -6,6 +6,36 @@ INCBIN(shaders_equirect2cube_main_frag, "../shaders/equirect2cube/main.frag");
 INCBIN(shaders_iblsampler_main_vert, "../shaders/iblsampler/main.vert");
 INCBIN(shaders_iblsampler_main_frag, "../shaders/iblsampler/main.frag");
 
+// Rough levels are blurry enough for the chain to stop at faces this small.
+#define SMALLEST_LEVEL 8
+
+// The fewest samples of the rough GGX levels.
+#define MIN_SAMPLES 8
+
+// What each quality costs, see layman_environment_quality().
+struct tier {
+	size_t cubemap_size;
+	size_t specular_size;
+	size_t lambertian_size;
+	size_t lut_size;
+	unsigned int samples;
+	unsigned int lut_samples; // Without any filtering, the lookup tables need more.
+};
+
+static const struct tier tiers[] = {
+	[LAYMAN_ENVIRONMENT_QUALITY_LOW] = {512, 128, 16, 64, 32, 128},
+	[LAYMAN_ENVIRONMENT_QUALITY_MEDIUM] = {1024, 256, 32, 128, 64, 256},
+	[LAYMAN_ENVIRONMENT_QUALITY_HIGH] = {2048, 512, 64, 256, 128, 512},
+};
+
+static enum layman_environment_quality quality = LAYMAN_ENVIRONMENT_QUALITY_HIGH;
+
+void layman_environment_quality(enum layman_environment_quality new) {
+	if (new <= LAYMAN_ENVIRONMENT_QUALITY_HIGH) {
+		quality = new;
+	}
+}
+
 // TODO: Mesh cube.
 void renderCube() {
 	static GLuint cubeVAO, cubeVBO;
@@ -76,7 +106,8 @@ void renderCube() {
 	glDrawArrays(GL_TRIANGLES, 0, 36);
 }
 
-static struct layman_texture *convert_equirectangular_to_cubemap(const struct layman_texture *equirectangular) {
+// The cubemap gets its whole mip chain, which the prefiltering samples from.
+static struct layman_texture *convert_equirectangular_to_cubemap(const struct layman_texture *equirectangular, size_t size) {
 	// Load & convert equirectangular environment map to a cubemap texture.
 	struct layman_shader *equirect2cube_shader = layman_shader_load_from_memory(
 		shaders_equirect2cube_main_vert_data, shaders_equirect2cube_main_vert_size,
@@ -90,7 +121,7 @@ static struct layman_texture *convert_equirectangular_to_cubemap(const struct la
 
 	layman_shader_switch(equirect2cube_shader);
 
-	int width = 2048, height = 2048;
+	int width = size, height = size;
 
 	struct layman_framebuffer *fb = layman_framebuffer_create(width, height);
 	if (!fb) {
@@ -98,19 +129,13 @@ static struct layman_texture *convert_equirectangular_to_cubemap(const struct la
 		return NULL;
 	}
 
-	GLuint cubemap_id;
-	glGenTextures(1, &cubemap_id);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_id);
-	for (size_t face = 0; face < 6; face++) {
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+	struct layman_texture *cubemap = layman_texture_create(LAYMAN_TEXTURE_KIND_CUBEMAP, width, height, true, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGB, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB16F);
+	if (!cubemap) {
+		layman_framebuffer_destroy(fb);
+		layman_shader_destroy(equirect2cube_shader);
+		return NULL;
 	}
 
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
 	mat4 projection;
 	glm_perspective(glm_rad(90), 1, 0.1, 1000.0, projection);
 
@@ -136,24 +161,38 @@ static struct layman_texture *convert_equirectangular_to_cubemap(const struct la
 	for (unsigned int i = 0; i < 6; ++i) {
 		GLint view_location = glGetUniformLocation(equirect2cube_shader->program_id, "view");
 		glUniformMatrix4fv(view_location, 1, false, (float *) views[i]);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, cubemap_id, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, cubemap->gl_id, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		renderCube();
 	}
 
-	layman_shader_destroy(equirect2cube_shader);
+	glActiveTexture(cubemap->gl_unit);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap->gl_id);
+	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
-	// TODO: This should use the texture module and not be created manually here.
-	struct layman_texture *cubemap = malloc(sizeof *cubemap);
-	cubemap->gl_id = cubemap_id;
-	cubemap->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_CUBEMAP;
-	cubemap->kind = LAYMAN_TEXTURE_KIND_CUBEMAP;
-	cubemap->gl_target = GL_TEXTURE_CUBE_MAP;
-	cubemap->width = width;
+	layman_framebuffer_destroy(fb);
+	layman_shader_destroy(equirect2cube_shader);
 
 	return cubemap;
 }
 
+// Attaches the faces of a level of a cubemap to the first six outputs, or detaches them.
+static void attach_faces(const struct layman_texture *cubemap, unsigned int level) {
+	for (size_t face = 0; face < 6; face++) {
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + face, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, cubemap ? cubemap->gl_id : 0, level);
+	}
+}
+
+// A mirror-like level only needs the one sample in its direction, wider lobes take more.
+// They read coarser mips of the source as they widen, which keeps the count low.
+static unsigned int ggx_samples(const struct tier *tier, float roughness) {
+	if (roughness == 0) {
+		return 1;
+	}
+
+	return MIN_SAMPLES + (unsigned int) ((float) (tier->samples - MIN_SAMPLES) * roughness);
+}
+
 struct layman_environment *layman_environment_create_from_hdr(const struct layman_window *window, const char *filepath) {
 	layman_window_use(window);
 
@@ -170,7 +209,16 @@ struct layman_environment *layman_environment_create_from_hdr(const struct layma
 		return NULL;
 	}
 
-	environment->cubemap = convert_equirectangular_to_cubemap(equirectangular);
+	environment->lambertian = NULL;
+	environment->lambertian_lut = NULL;
+	environment->ggx = NULL;
+	environment->ggx_lut = NULL;
+	environment->charlie = NULL;
+	environment->charlie_lut = NULL;
+
+	const struct tier *tier = &tiers[quality];
+
+	environment->cubemap = convert_equirectangular_to_cubemap(equirectangular, tier->cubemap_size);
 	if (!environment->cubemap) {
 		layman_texture_destroy(equirectangular);
 		free(environment);
@@ -193,98 +241,56 @@ struct layman_environment *layman_environment_create_from_hdr(const struct layma
 		return NULL;
 	}
 
-	environment->mip_count = 10;
-	int sample_count = 1024;
-	size_t width = 1024, height = 1024;
+	environment->mip_count = 1;
+	while ((tier->specular_size >> environment->mip_count) >= SMALLEST_LEVEL) {
+		environment->mip_count++;
+	}
 
 	layman_shader_switch(iblsampler_shader);
 
 	GLint pfp_roughness_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_roughness");
 	GLint pfp_samplecount_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_sampleCount");
-	GLint pfp_miplevel_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_currentMipLevel");
 	GLint pfp_width_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_width");
+	GLint pfp_outputwidth_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_outputWidth");
 	GLint pfp_lodbias_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_lodBias");
 	GLint pfp_distribution_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_distribution");
+	GLint pfp_lut_location = glGetUniformLocation(iblsampler_shader->program_id, "pfp_lut");
 
-	struct layman_framebuffer *fb = layman_framebuffer_create(width, height);
+	struct layman_framebuffer *fb = layman_framebuffer_create(tier->specular_size, tier->specular_size);
 	if (!fb) {
 		fprintf(stderr, "FB error\n");
+		layman_shader_destroy(iblsampler_shader);
 		layman_environment_destroy(environment);
 		layman_window_unuse(window);
 		return NULL;
 	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, fb->fbo);
-	glViewport(0, 0, width, height);
 
-	// Lambertian
-	GLuint lambertian_id;
-	glGenTextures(1, &lambertian_id);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, lambertian_id);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, environment->mip_count - 1);
-	for (size_t mip = 0; mip < environment->mip_count; mip++) {
-		for (size_t face = 0; face < 6; face++) {
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGBA16F, width >> mip, height >> mip, 0, GL_RGBA, GL_FLOAT, NULL);
-		}
-	}
-
-	GLuint lambertian_lut_id;
-	glGenTextures(1, &lambertian_lut_id);
-	glBindTexture(GL_TEXTURE_2D, lambertian_lut_id);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-
-	// GGX
-	GLuint ggx_id;
-	glGenTextures(1, &ggx_id);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, ggx_id);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, environment->mip_count - 1);
-	for (size_t mip = 0; mip < environment->mip_count; mip++) {
-		for (size_t face = 0; face < 6; face++) {
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGBA16F, width >> mip, height >> mip, 0, GL_RGBA, GL_FLOAT, NULL);
-		}
-	}
-
-	GLuint ggx_lut_id;
-	glGenTextures(1, &ggx_lut_id);
-	glBindTexture(GL_TEXTURE_2D, ggx_lut_id);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// Charlie
-	GLuint charlie_id;
-	glGenTextures(1, &charlie_id);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, charlie_id);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, environment->mip_count - 1);
-	for (size_t mip = 0; mip < environment->mip_count; mip++) {
-		for (size_t face = 0; face < 6; face++) {
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, mip, GL_RGBA16F, width >> mip, height >> mip, 0, GL_RGBA, GL_FLOAT, NULL);
-		}
+	// Prefiltered cubemaps, one level per roughness, each with the lookup table of its distribution.
+	// Irradiance has neither roughness nor much detail, a single small level is plenty.
+	environment->lambertian = layman_texture_create_with_levels(LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN, tier->lambertian_size, tier->lambertian_size, 1, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGBA, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA16F);
+	environment->lambertian_lut = layman_texture_create_with_levels(LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN_LUT, tier->lut_size, tier->lut_size, 1, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGB, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB16F);
+	environment->ggx = layman_texture_create_with_levels(LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX, tier->specular_size, tier->specular_size, environment->mip_count, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGBA, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA16F);
+	environment->ggx_lut = layman_texture_create_with_levels(LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX_LUT, tier->lut_size, tier->lut_size, 1, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGB, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB16F);
+	environment->charlie = layman_texture_create_with_levels(LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE, tier->specular_size, tier->specular_size, environment->mip_count, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGBA, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA16F);
+	environment->charlie_lut = layman_texture_create_with_levels(LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE_LUT, tier->lut_size, tier->lut_size, 1, LAYMAN_TEXTURE_TYPE_FLOAT, LAYMAN_TEXTURE_FORMAT_RGB, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB16F);
+
+	if (!environment->lambertian || !environment->lambertian_lut || !environment->ggx || !environment->ggx_lut || !environment->charlie || !environment->charlie_lut) {
+		layman_framebuffer_destroy(fb);
+		layman_shader_destroy(iblsampler_shader);
+		layman_environment_destroy(environment);
+		layman_window_unuse(window);
+		return NULL;
 	}
 
-	GLuint charlie_lut_id;
-	glGenTextures(1, &charlie_lut_id);
-	glBindTexture(GL_TEXTURE_2D, charlie_lut_id);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
+	// The texture module already clamps cubemaps to their edges.
 	layman_texture_switch(environment->cubemap);
 	GLint cubemap_location = glGetUniformLocation(iblsampler_shader->program_id, "uCubeMap");
 	glUniform1i(cubemap_location, environment->cubemap->kind);
 
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	glUniform1ui(pfp_samplecount_location, sample_count);
-	glUniform1ui(pfp_width_location, width);
-	// glUniform1ui(pfp_width_location, environment->cubemap->width); // FIXME: The cubemap width or current mip?
+	// Filtered importance sampling: the solid angle of each sample picks the mip of the source it reads.
+	glUniform1ui(pfp_width_location, environment->cubemap->width);
 	glUniform1f(pfp_lodbias_location, 0);
 
 	const GLenum buffers[] = {
@@ -310,81 +316,57 @@ struct layman_environment *layman_environment_create_from_hdr(const struct layma
 	GLuint VAO;
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
-	// glDisable(GL_CULL_FACE);
-
-	for (int mip = environment->mip_count - 1; mip != -1; mip--) {
-		glUniform1f(pfp_roughness_location, (float) mip / (float) (environment->mip_count - 1));
-		glUniform1ui(pfp_miplevel_location, mip);
 
-		// Lambertian
-		glUniform1ui(pfp_distribution_location, 0);
-		for (size_t face = 0; face < 6; face++) {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + face, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, lambertian_id, mip);
-		}
-
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT6, GL_TEXTURE_2D, lambertian_lut_id, 0);
-
-		glDrawArrays(GL_TRIANGLES, 0, 3);
+	// Lambertian
+	glUniform1i(pfp_lut_location, false);
+	glUniform1ui(pfp_distribution_location, 0);
+	glUniform1ui(pfp_samplecount_location, tier->samples);
+	glUniform1ui(pfp_outputwidth_location, tier->lambertian_size);
+	attach_faces(environment->lambertian, 0);
+	glViewport(0, 0, tier->lambertian_size, tier->lambertian_size);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	for (unsigned int mip = 0; mip < environment->mip_count; mip++) {
+		float roughness = (float) mip / (float) (environment->mip_count - 1);
+		size_t size = tier->specular_size >> mip;
+
+		glUniform1f(pfp_roughness_location, roughness);
+		glUniform1ui(pfp_outputwidth_location, size);
+		glViewport(0, 0, size, size);
 
 		// GGX
 		glUniform1ui(pfp_distribution_location, 1);
-		for (size_t face = 0; face < 6; face++) {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + face, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, ggx_id, mip);
-		}
-
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT6, GL_TEXTURE_2D, ggx_lut_id, 0);
-
+		glUniform1ui(pfp_samplecount_location, ggx_samples(tier, roughness));
+		attach_faces(environment->ggx, mip);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 
-		// Charlie
+		// Charlie, whose lobe hugs the horizon whatever the roughness, keeps every sample.
 		glUniform1ui(pfp_distribution_location, 2);
-		for (size_t face = 0; face < 6; face++) {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + face, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, charlie_id, mip);
-		}
+		glUniform1ui(pfp_samplecount_location, tier->samples);
+		attach_faces(environment->charlie, mip);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
 
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT6, GL_TEXTURE_2D, charlie_lut_id, 0);
+	// Lookup tables, once each and without the faces.
+	const struct layman_texture *luts[] = {
+		environment->lambertian_lut,
+		environment->ggx_lut,
+		environment->charlie_lut,
+	};
 
+	attach_faces(NULL, 0);
+	glUniform1i(pfp_lut_location, true);
+	glUniform1ui(pfp_samplecount_location, tier->lut_samples);
+	glViewport(0, 0, tier->lut_size, tier->lut_size);
+
+	for (unsigned int distribution = 0; distribution < 3; distribution++) {
+		glUniform1ui(pfp_distribution_location, distribution);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT6, GL_TEXTURE_2D, luts[distribution]->gl_id, 0);
 		glDrawArrays(GL_TRIANGLES, 0, 3);
 	}
 
-	// glEnable(GL_CULL_FACE);
-
-	environment->lambertian = malloc(sizeof *environment->lambertian);
-	environment->lambertian->gl_id = lambertian_id;
-	environment->lambertian->kind = LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN;
-	environment->lambertian->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN;
-	environment->lambertian->gl_target = GL_TEXTURE_CUBE_MAP;
-
-	environment->lambertian_lut = malloc(sizeof *environment->lambertian_lut);
-	environment->lambertian_lut->gl_id = lambertian_lut_id;
-	environment->lambertian_lut->kind = LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN_LUT;
-	environment->lambertian_lut->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN_LUT;
-	environment->lambertian_lut->gl_target = GL_TEXTURE_2D;
-
-	environment->ggx = malloc(sizeof *environment->ggx);
-	environment->ggx->gl_id = ggx_id;
-	environment->ggx->kind = LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX;
-	environment->ggx->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX;
-	environment->ggx->gl_target = GL_TEXTURE_CUBE_MAP;
-
-	environment->ggx_lut = malloc(sizeof *environment->ggx_lut);
-	environment->ggx_lut->gl_id = ggx_lut_id;
-	environment->ggx_lut->kind = LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX_LUT;
-	environment->ggx_lut->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX_LUT;
-	environment->ggx_lut->gl_target = GL_TEXTURE_2D;
-
-	environment->charlie = malloc(sizeof *environment->charlie);
-	environment->charlie->gl_id = charlie_id;
-	environment->charlie->kind = LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE;
-	environment->charlie->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE;
-	environment->charlie->gl_target = GL_TEXTURE_CUBE_MAP;
-
-	environment->charlie_lut = malloc(sizeof *environment->charlie_lut);
-	environment->charlie_lut->gl_id = charlie_lut_id;
-	environment->charlie_lut->kind = LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE_LUT;
-	environment->charlie_lut->gl_unit = GL_TEXTURE0 + LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE_LUT;
-	environment->charlie_lut->gl_target = GL_TEXTURE_2D;
-
+	glDeleteVertexArrays(1, &VAO);
+	layman_framebuffer_destroy(fb);
 	layman_shader_destroy(iblsampler_shader);
 
 	layman_window_unuse(window);
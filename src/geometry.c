@@ -0,0 +1,180 @@
+#include "layman.h"
+
+#define VERTICES_CAPACITY_MIN 65536
+#define INDICES_CAPACITY_MIN (3 * VERTICES_CAPACITY_MIN)
+
+// Every vertex stream of the geometry, in the order of `vbos`.
+static const struct {
+	enum layman_mesh_attribute attribute;
+	GLint components;
+} streams[] = {
+	{LAYMAN_MESH_ATTRIBUTE_POSITION, 3},
+	{LAYMAN_MESH_ATTRIBUTE_NORMAL, 3},
+	{LAYMAN_MESH_ATTRIBUTE_UV, 2},
+	{LAYMAN_MESH_ATTRIBUTE_TANGENT, 4},
+};
+
+static GLuint mesh_vbo(const struct layman_mesh *mesh, size_t stream) {
+	GLuint vbos[] = {mesh->vbo_positions, mesh->vbo_normals, mesh->vbo_uvs, mesh->vbo_tangents};
+	return vbos[stream];
+}
+
+// Replaces a buffer by a larger one, keeping the part of its content that is in use.
+static GLuint resize(GLuint buffer, size_t used, size_t new_size) {
+	GLuint new_buffer;
+	glGenBuffers(1, &new_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, new_buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, new_size, NULL, GL_STATIC_DRAW);
+
+	if (used > 0) {
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+	}
+
+	glDeleteBuffers(1, &buffer);
+
+	return new_buffer;
+}
+
+static void reserve_vertices(struct layman_geometry *geometry, size_t count) {
+	if (geometry->vertices_count + count <= geometry->vertices_capacity) {
+		return;
+	}
+
+	// Grow geometrically to keep the copies of the previous content rare.
+	size_t new_capacity = 2 * geometry->vertices_capacity;
+	if (new_capacity < geometry->vertices_count + count) {
+		new_capacity = geometry->vertices_count + count;
+	}
+	if (new_capacity < VERTICES_CAPACITY_MIN) {
+		new_capacity = VERTICES_CAPACITY_MIN;
+	}
+
+	layman_geometry_switch(geometry);
+
+	for (size_t s = 0; s < ARRAY_COUNT(streams); s++) {
+		size_t vertex_size = streams[s].components * sizeof (float);
+		geometry->vbos[s] = resize(geometry->vbos[s], geometry->vertices_count * vertex_size, new_capacity * vertex_size);
+
+		glBindBuffer(GL_ARRAY_BUFFER, geometry->vbos[s]);
+		glVertexAttribPointer(streams[s].attribute, streams[s].components, GL_FLOAT, false, 0, 0);
+	}
+
+	geometry->vertices_capacity = new_capacity;
+}
+
+static void reserve_indices(struct layman_geometry *geometry, size_t count) {
+	if (geometry->indices_count + count <= geometry->indices_capacity) {
+		return;
+	}
+
+	size_t new_capacity = 2 * geometry->indices_capacity;
+	if (new_capacity < geometry->indices_count + count) {
+		new_capacity = geometry->indices_count + count;
+	}
+	if (new_capacity < INDICES_CAPACITY_MIN) {
+		new_capacity = INDICES_CAPACITY_MIN;
+	}
+
+	layman_geometry_switch(geometry);
+
+	geometry->ebo_indices = resize(geometry->ebo_indices, geometry->indices_count * sizeof (unsigned short), new_capacity * sizeof (unsigned short));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry->ebo_indices);
+
+	geometry->indices_capacity = new_capacity;
+}
+
+struct layman_geometry *layman_geometry_create(GLuint instances_buffer) {
+	struct layman_geometry *geometry = malloc(sizeof *geometry);
+	if (!geometry) {
+		return NULL;
+	}
+
+	static unsigned int next_id = 1; // Zero means a mesh wasn't packed.
+	geometry->id = next_id++;
+
+	for (size_t s = 0; s < ARRAY_COUNT(streams); s++) {
+		geometry->vbos[s] = 0;
+	}
+
+	geometry->ebo_indices = 0;
+	geometry->vertices_count = 0;
+	geometry->vertices_capacity = 0;
+	geometry->indices_count = 0;
+	geometry->indices_capacity = 0;
+
+	glGenVertexArrays(1, &geometry->vao);
+	layman_geometry_switch(geometry);
+
+	for (size_t s = 0; s < ARRAY_COUNT(streams); s++) {
+		glEnableVertexAttribArray(streams[s].attribute);
+	}
+
+	// Every draw command selects its own range of instances, so this only changes along with the buffer.
+	layman_mesh_enable_instances();
+	layman_mesh_point_instances(instances_buffer, 0);
+
+	reserve_vertices(geometry, VERTICES_CAPACITY_MIN);
+	reserve_indices(geometry, INDICES_CAPACITY_MIN);
+
+	layman_geometry_switch(NULL);
+
+	return geometry;
+}
+
+void layman_geometry_destroy(struct layman_geometry *geometry) {
+	if (!geometry) {
+		return;
+	}
+
+	layman_geometry_switch(NULL);
+
+	glDeleteBuffers(ARRAY_COUNT(geometry->vbos), geometry->vbos);
+	glDeleteBuffers(1, &geometry->ebo_indices);
+	glDeleteVertexArrays(1, &geometry->vao);
+
+	free(geometry);
+}
+
+void layman_geometry_switch(const struct layman_geometry *geometry) {
+	// The meshes bind their own vertex arrays; their cache must not believe one of them is still bound.
+	layman_mesh_switch(NULL);
+
+	glBindVertexArray(geometry ? geometry->vao : 0);
+}
+
+void layman_geometry_bind_instances(const struct layman_geometry *geometry, GLuint instances_buffer) {
+	layman_geometry_switch(geometry);
+	layman_mesh_point_instances(instances_buffer, 0);
+}
+
+bool layman_geometry_add(struct layman_geometry *geometry, struct layman_mesh *mesh) {
+	if (!mesh->packable) {
+		return false;
+	}
+
+	reserve_vertices(geometry, mesh->vertices_count);
+	reserve_indices(geometry, mesh->indices_count);
+
+	for (size_t s = 0; s < ARRAY_COUNT(streams); s++) {
+		size_t vertex_size = streams[s].components * sizeof (float);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, mesh_vbo(mesh, s));
+		glBindBuffer(GL_COPY_WRITE_BUFFER, geometry->vbos[s]);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, geometry->vertices_count * vertex_size, mesh->vertices_count * vertex_size);
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, mesh->ebo_indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, geometry->ebo_indices);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, geometry->indices_count * sizeof (unsigned short), mesh->indices_count * sizeof (unsigned short));
+
+	// The indices stay relative to the mesh, the draw commands offset them by the base vertex.
+	mesh->geometry_id = geometry->id;
+	mesh->geometry_first_index = geometry->indices_count;
+	mesh->geometry_base_vertex = geometry->vertices_count;
+
+	geometry->vertices_count += mesh->vertices_count;
+	geometry->indices_count += mesh->indices_count;
+
+	return true;
+}
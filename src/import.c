@@ -0,0 +1,47 @@
+#include "layman.h"
+#include "layman/import.h"
+
+const enum layman_texture_kind layman_import_texture_kinds[LAYMAN_IMPORT_TEXTURES] = {
+	LAYMAN_TEXTURE_KIND_ALBEDO,
+	LAYMAN_TEXTURE_KIND_METALLIC_ROUGHNESS,
+	LAYMAN_TEXTURE_KIND_NORMAL,
+	LAYMAN_TEXTURE_KIND_OCCLUSION,
+	LAYMAN_TEXTURE_KIND_EMISSION,
+};
+
+const cgltf_image *layman_import_view_image(const cgltf_texture_view *view) {
+	if (!view->texture || !view->texture->image || !view->texture->image->buffer_view) {
+		return NULL;
+	}
+
+	return view->texture->image;
+}
+
+const cgltf_image *layman_import_texture(const cgltf_material *material, size_t texture) {
+	const cgltf_texture_view *views[LAYMAN_IMPORT_TEXTURES] = {
+		&material->pbr_metallic_roughness.base_color_texture,
+		&material->pbr_metallic_roughness.metallic_roughness_texture,
+		&material->normal_texture,
+		&material->occlusion_texture,
+		&material->emissive_texture,
+	};
+
+	if (layman_import_texture_kinds[texture] == LAYMAN_TEXTURE_KIND_OCCLUSION && layman_import_occlusion_packed(material)) {
+		return NULL;
+	}
+
+	return layman_import_view_image(views[texture]);
+}
+
+bool layman_import_occlusion_packed(const cgltf_material *material) {
+	const cgltf_texture_view *occlusion = &material->occlusion_texture;
+	const cgltf_texture_view *metallic_roughness = &material->pbr_metallic_roughness.metallic_roughness_texture;
+
+	const cgltf_image *image = layman_import_view_image(occlusion);
+	return image && image == layman_import_view_image(metallic_roughness) && occlusion->texcoord == metallic_roughness->texcoord;
+}
+
+const unsigned char *layman_import_image_data(const cgltf_data *gltf, const cgltf_image *image) {
+	const void *buffer = image->buffer_view->buffer->data ? image->buffer_view->buffer->data : gltf->bin;
+	return (const unsigned char *) buffer + image->buffer_view->offset;
+}
@@ -1,11 +1,18 @@
 #include "layman.h"
 
+// Every material shared through layman_material_acquire().
+static struct layman_material **cache;
+static size_t cache_count;
+
 struct layman_material *layman_material_create(void) {
 	struct layman_material *material = malloc(sizeof *material);
 	if (!material) {
 		return NULL;
 	}
 
+	static unsigned int next_id = 0;
+	material->id = next_id++;
+
 	glm_vec4_one(material->base_color_factor);
 	material->base_color_texture = NULL;
 	material->metallic_roughness_texture = NULL;
@@ -15,22 +22,89 @@ struct layman_material *layman_material_create(void) {
 	material->normal_scale = 1;
 	material->occlusion_texture = NULL;
 	material->occlusion_strength = 1;
+	material->occlusion_packed = false;
 	material->emissive_texture = NULL;
-	glm_vec3_one(material->emissive_factor);
+	glm_vec3_zero(material->emissive_factor);
+	material->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE;
+	material->alpha_cutoff = 0.5f;
+	material->unlit = false;
+	material->double_sided = false;
+	material->references = 0;
 
 	return material;
 }
 
 void layman_material_destroy(struct layman_material *material) {
-	layman_texture_destroy(material->base_color_texture);
-	layman_texture_destroy(material->metallic_roughness_texture);
-	layman_texture_destroy(material->normal_texture);
-	layman_texture_destroy(material->occlusion_texture);
-	layman_texture_destroy(material->emissive_texture);
+	// Textures are shared with other materials.
+	layman_texture_release(material->base_color_texture);
+	layman_texture_release(material->metallic_roughness_texture);
+	layman_texture_release(material->normal_texture);
+	layman_texture_release(material->occlusion_texture);
+	layman_texture_release(material->emissive_texture);
 
 	free(material);
 }
 
+// Whether two materials render the same, everything but their ids is compared.
+static bool same(const struct layman_material *a, const struct layman_material *b) {
+	return glm_vec4_eqv((float *) a->base_color_factor, (float *) b->base_color_factor) &&
+	       a->base_color_texture == b->base_color_texture &&
+	       a->metallic_roughness_texture == b->metallic_roughness_texture &&
+	       a->metallic_factor == b->metallic_factor &&
+	       a->roughness_factor == b->roughness_factor &&
+	       a->normal_texture == b->normal_texture &&
+	       a->normal_scale == b->normal_scale &&
+	       a->occlusion_texture == b->occlusion_texture &&
+	       a->occlusion_strength == b->occlusion_strength &&
+	       a->occlusion_packed == b->occlusion_packed &&
+	       a->emissive_texture == b->emissive_texture &&
+	       glm_vec3_eqv((float *) a->emissive_factor, (float *) b->emissive_factor) &&
+	       a->alpha_mode == b->alpha_mode &&
+	       a->alpha_cutoff == b->alpha_cutoff &&
+	       a->unlit == b->unlit &&
+	       a->double_sided == b->double_sided;
+}
+
+struct layman_material *layman_material_acquire(struct layman_material *material) {
+	for (size_t i = 0; i < cache_count; i++) {
+		if (same(cache[i], material)) {
+			layman_material_destroy(material);
+			cache[i]->references++;
+			return cache[i];
+		}
+	}
+
+	struct layman_material **new_cache = realloc(cache, (cache_count + 1) * sizeof *cache);
+	if (!new_cache) {
+		layman_material_destroy(material);
+		return NULL;
+	}
+
+	cache = new_cache;
+
+	material->references = 1;
+	cache[cache_count] = material;
+	cache_count++;
+
+	return material;
+}
+
+void layman_material_release(struct layman_material *material) {
+	if (!material || --material->references > 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < cache_count; i++) {
+		if (cache[i] == material) {
+			cache[i] = cache[cache_count - 1];
+			cache_count--;
+			break;
+		}
+	}
+
+	layman_material_destroy(material);
+}
+
 void layman_material_switch(const struct layman_material *new) {
 	thread_local static const struct layman_material *current;
 
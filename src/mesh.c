@@ -1,5 +1,13 @@
 #include "layman.h"
 #include "incbin.h"
+#include <float.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define USE_SSE
+#endif
 
 INCBIN(shaders_pbr_main_vert, "../shaders/pbr/main.vert");
 INCBIN(shaders_pbr_main_frag, "../shaders/pbr/main.frag");
@@ -29,6 +37,85 @@ INCBIN(shaders_pbr_main_frag, "../shaders/pbr/main.frag");
    }
  */
 
+// Long enough for every define describe() can emit.
+#define DEFINES_LENGTH_MAX 512
+
+// Writes the defines selecting the shader permutation of a mesh, such that fragments only pay for what it really has.
+// Textures are only sampled when there are UVs to sample them with.
+static void describe(const struct layman_mesh *mesh, char *defines, size_t size) {
+	const struct layman_material *material = mesh->material;
+	const char *names[16];
+	size_t count = 0;
+
+	// Attributes.
+	bool uvs = LAYMAN_MESH_HAS(mesh, LAYMAN_MESH_ATTRIBUTE_UV);
+	if (LAYMAN_MESH_HAS(mesh, LAYMAN_MESH_ATTRIBUTE_NORMAL)) {
+		names[count++] = "HAS_NORMALS";
+
+		if (mesh->format.encodings[LAYMAN_MESH_ATTRIBUTE_NORMAL] == LAYMAN_VERTEX_ENCODING_OCTAHEDRAL) {
+			names[count++] = "HAS_NORMALS_OCTAHEDRAL";
+		}
+	}
+	if (LAYMAN_MESH_HAS(mesh, LAYMAN_MESH_ATTRIBUTE_TANGENT)) {
+		names[count++] = "HAS_TANGENTS";
+	}
+	if (uvs) {
+		names[count++] = "HAS_UV_SET1";
+	}
+
+	// Material.
+	names[count++] = "MATERIAL_METALLICROUGHNESS";
+
+	if (material) {
+		if (material->base_color_texture && uvs) {
+			names[count++] = "HAS_BASE_COLOR_MAP";
+		}
+		if (material->metallic_roughness_texture && uvs) {
+			names[count++] = "HAS_METALLIC_ROUGHNESS_MAP";
+		}
+		if (material->normal_texture && uvs) {
+			names[count++] = "HAS_NORMAL_MAP";
+
+			// Two channels normal maps leave Z for the shader to rebuild.
+			GLenum format = material->normal_texture->gl_internal_format;
+			if (format == GL_RG8 || format == GL_COMPRESSED_RG_RGTC2) {
+				names[count++] = "HAS_NORMAL_MAP_RG";
+			}
+		}
+		if (material->occlusion_texture && uvs) {
+			names[count++] = "HAS_OCCLUSION_MAP";
+		}
+		if (material->occlusion_packed && material->metallic_roughness_texture && uvs) {
+			names[count++] = "HAS_OCCLUSION_IN_METALLIC_ROUGHNESS_MAP";
+		}
+		if (material->emissive_texture && uvs) {
+			names[count++] = "HAS_EMISSIVE_MAP";
+		}
+		if (material->unlit) {
+			names[count++] = "MATERIAL_UNLIT";
+		}
+	}
+
+	switch (material ? material->alpha_mode : LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE) {
+	    case LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE:
+		    names[count++] = "ALPHAMODE_OPAQUE";
+		    break;
+
+	    case LAYMAN_MATERIAL_ALPHA_MODE_MASK:
+		    names[count++] = "ALPHAMODE_MASK";
+		    break;
+
+	    case LAYMAN_MATERIAL_ALPHA_MODE_BLEND:
+		    break;
+	}
+
+	size_t length = 0;
+	defines[0] = '\0';
+	for (size_t i = 0; i < count; i++) {
+		length += snprintf(defines + length, size - length, "#define %s\n", names[i]);
+	}
+}
+
 struct layman_mesh *layman_mesh_create(void) {
 	struct layman_mesh *mesh = malloc(sizeof *mesh);
 	if (!mesh) {
@@ -42,15 +129,26 @@ struct layman_mesh *layman_mesh_create(void) {
 	mesh->ebo_indices = 0;
 	mesh->vbo_tangents = 0;
 	mesh->vbo_bitangents = 0;
+	mesh->vbo_vertices = 0;
+	mesh->vertices_count = 0;
+	mesh->indices_count = 0;
+	mesh->indices_format = LAYMAN_MESH_INDEX_FORMAT_UINT16;
+	mesh->format = layman_vertex_format_float(0);
+	mesh->lods_count = 0;
+	mesh->meshlets = NULL;
+
+	mesh->packable = false;
+	mesh->geometry_id = 0;
+	mesh->geometry_first_index = 0;
+	mesh->geometry_base_vertex = 0;
 
 	mesh->material = NULL;
 
-	// TODO: Shader caching based on the #defines that it needs. Each mesh having their own shader is a bit wasteful otherwise.
-	mesh->shader = layman_shader_load_from_memory(shaders_pbr_main_vert_data, shaders_pbr_main_vert_size, shaders_pbr_main_frag_data, shaders_pbr_main_frag_size, NULL, 0);
-	if (!mesh->shader) {
-		free(mesh);
-		return NULL;
-	}
+	// Unknown bounds, never culled.
+	layman_mesh_assign_bounds(mesh, (vec3) { -FLT_MAX, -FLT_MAX, -FLT_MAX}, (vec3) { FLT_MAX, FLT_MAX, FLT_MAX});
+
+	// Acquired once the attributes and material are known.
+	mesh->shader = NULL;
 
 	// Vertex Array Object (VAO).
 	// This contains multiple buffers and is the preferred way to change from one group of buffers to another when rendering models.
@@ -59,7 +157,17 @@ struct layman_mesh *layman_mesh_create(void) {
 	return mesh;
 }
 
-struct layman_mesh *layman_mesh_create_from_raw(const float *vertices, size_t vertices_count, size_t vertices_stride, const float *normals, size_t normals_count, size_t normals_stride, const float *uvs, size_t uvs_count, size_t uvs_stride, const unsigned short *indices, size_t indices_count, const float *tangents, size_t tangents_count, size_t tangents_stride) {
+// Picks the shader permutation of a mesh once its attributes and material are known.
+// Meshes needing the same permutation share its program.
+static bool acquire_shader(struct layman_mesh *mesh) {
+	char defines[DEFINES_LENGTH_MAX];
+	describe(mesh, defines, sizeof defines);
+
+	mesh->shader = layman_shader_acquire(shaders_pbr_main_vert_data, shaders_pbr_main_vert_size, shaders_pbr_main_frag_data, shaders_pbr_main_frag_size, NULL, 0, defines);
+	return mesh->shader != NULL;
+}
+
+struct layman_mesh *layman_mesh_create_from_raw(const float *vertices, size_t vertices_count, size_t vertices_stride, const float *normals, size_t normals_count, size_t normals_stride, const float *uvs, size_t uvs_count, size_t uvs_stride, const void *indices, size_t indices_count, enum layman_mesh_index_format indices_format, const float *tangents, size_t tangents_count, size_t tangents_stride, const struct layman_material *material) {
 	struct layman_mesh *mesh = layman_mesh_create();
 	if (!mesh) {
 		return NULL;
@@ -73,9 +181,11 @@ struct layman_mesh *layman_mesh_create_from_raw(const float *vertices, size_t ve
 	glBufferData(GL_ARRAY_BUFFER, vertices_count * 3 * sizeof (float), vertices, GL_STATIC_DRAW);
 	glVertexAttribPointer(LAYMAN_MESH_ATTRIBUTE_POSITION, 3, GL_FLOAT, false, vertices_stride, 0);
 	glEnableVertexAttribArray(LAYMAN_MESH_ATTRIBUTE_POSITION);
+	mesh->format.attributes |= 1 << LAYMAN_MESH_ATTRIBUTE_POSITION;
 
 	// Normals.
 	if (normals_count > 0) {
+		mesh->format.attributes |= 1 << LAYMAN_MESH_ATTRIBUTE_NORMAL;
 		glGenBuffers(1, &mesh->vbo_normals);
 		glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo_normals);
 		glBufferData(GL_ARRAY_BUFFER, normals_count * 3 * sizeof (float), normals, GL_STATIC_DRAW);
@@ -85,6 +195,7 @@ struct layman_mesh *layman_mesh_create_from_raw(const float *vertices, size_t ve
 
 	// UVs.
 	if (uvs_count > 0) {
+		mesh->format.attributes |= 1 << LAYMAN_MESH_ATTRIBUTE_UV;
 		glGenBuffers(1, &mesh->vbo_uvs);
 		glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo_uvs);
 		glBufferData(GL_ARRAY_BUFFER, uvs_count * 2 * sizeof (float), uvs, GL_STATIC_DRAW);
@@ -97,11 +208,14 @@ struct layman_mesh *layman_mesh_create_from_raw(const float *vertices, size_t ve
 	// That guy gets used by glDrawElements for the rendering, but isn't useful to the shader, as far as I know.
 	glGenBuffers(1, &mesh->ebo_indices);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo_indices);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_count * 1 * sizeof (unsigned short), indices, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_count * layman_mesh_index_size(indices_format), indices, GL_STATIC_DRAW);
 	mesh->indices_count = indices_count;
+	mesh->indices_format = indices_format;
+	layman_mesh_assign_lods(mesh, &(struct layman_mesh_lod) {0, indices_count, 0.0f}, 1);
 
 	// Tangents.
 	if (tangents_count > 0) {
+		mesh->format.attributes |= 1 << LAYMAN_MESH_ATTRIBUTE_TANGENT;
 		glGenBuffers(1, &mesh->vbo_tangents);
 		glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo_tangents);
 		glBufferData(GL_ARRAY_BUFFER, tangents_count * 4 * sizeof (float), tangents, GL_STATIC_DRAW);
@@ -109,9 +223,126 @@ struct layman_mesh *layman_mesh_create_from_raw(const float *vertices, size_t ve
 		glEnableVertexAttribArray(LAYMAN_MESH_ATTRIBUTE_TANGENT);
 	}
 
+	// Instances.
+	// The buffer is provided by the renderer right before drawing, see layman_mesh_bind_instances().
+	layman_mesh_enable_instances();
+
+	// Shared geometry buffers hold every attribute, tightly packed, and 16-bit indices.
+	#define TIGHT(stride, components) ((stride) == 0 || (stride) == (components) * sizeof (float))
+	mesh->vertices_count = vertices_count;
+	mesh->packable = indices_format == LAYMAN_MESH_INDEX_FORMAT_UINT16
+		&& TIGHT(vertices_stride, 3)
+		&& normals_count == vertices_count && TIGHT(normals_stride, 3)
+		&& uvs_count == vertices_count && TIGHT(uvs_stride, 2)
+		&& tangents_count == vertices_count && TIGHT(tangents_stride, 4);
+	#undef TIGHT
+
+	mesh->material = material;
+
+	if (!acquire_shader(mesh)) {
+		layman_mesh_destroy(mesh);
+		return NULL;
+	}
+
+	return mesh;
+}
+
+struct layman_mesh *layman_mesh_create_interleaved(const struct layman_vertex_format *format, const void *const streams[LAYMAN_VERTEX_STREAMS], size_t vertices_count, const void *indices, size_t indices_count, enum layman_mesh_index_format indices_format, const struct layman_material *material) {
+	struct layman_mesh *mesh = layman_mesh_create();
+	if (!mesh) {
+		return NULL;
+	}
+
+	layman_mesh_switch(mesh);
+
+	// Vertices.
+	// The interleaved attributes go to their own buffer, split positions to the one separate meshes also use.
+	GLuint *buffers[LAYMAN_VERTEX_STREAMS] = {&mesh->vbo_vertices, &mesh->vbo_positions};
+	for (size_t s = 0; s < LAYMAN_VERTEX_STREAMS; s++) {
+		size_t stride = layman_vertex_size(format, s);
+		if (stride == 0) {
+			continue;
+		}
+
+		glGenBuffers(1, buffers[s]);
+		glBindBuffer(GL_ARRAY_BUFFER, *buffers[s]);
+		glBufferData(GL_ARRAY_BUFFER, vertices_count * stride, streams[s], GL_STATIC_DRAW);
+	}
+
+	layman_vertex_point(format, (GLuint[]) {mesh->vbo_vertices, mesh->vbo_positions});
+
+	// Indices.
+	glGenBuffers(1, &mesh->ebo_indices);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo_indices);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_count * layman_mesh_index_size(indices_format), indices, GL_STATIC_DRAW);
+
+	// Instances.
+	layman_mesh_enable_instances();
+
+	mesh->vertices_count = vertices_count;
+	mesh->indices_count = indices_count;
+	mesh->indices_format = indices_format;
+	layman_mesh_assign_lods(mesh, &(struct layman_mesh_lod) {0, indices_count, 0.0f}, 1);
+	mesh->format = *format;
+	mesh->material = material;
+
+	if (!acquire_shader(mesh)) {
+		layman_mesh_destroy(mesh);
+		return NULL;
+	}
+
 	return mesh;
 }
 
+size_t layman_mesh_index_size(enum layman_mesh_index_format format) {
+	switch (format) {
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT8:
+		    return sizeof (uint8_t);
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT16:
+		    return sizeof (uint16_t);
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT32:
+		    return sizeof (uint32_t);
+	}
+
+	return 0;
+}
+
+GLenum layman_mesh_index_type(enum layman_mesh_index_format format) {
+	switch (format) {
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT8:
+		    return GL_UNSIGNED_BYTE;
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT16:
+		    return GL_UNSIGNED_SHORT;
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT32:
+		    return GL_UNSIGNED_INT;
+	}
+
+	return GL_NONE;
+}
+
+enum layman_mesh_index_format layman_mesh_index_format_fit(size_t vertices_count) {
+	return vertices_count <= UINT16_MAX + 1 ? LAYMAN_MESH_INDEX_FORMAT_UINT16 : LAYMAN_MESH_INDEX_FORMAT_UINT32;
+}
+
+void layman_mesh_narrow_indices(const uint32_t *indices, size_t count, enum layman_mesh_index_format format, void *destination) {
+	// Going forward never writes over an index not read yet, even in place.
+	for (size_t i = 0; i < count; i++) {
+		uint32_t index = indices[i];
+
+		switch (format) {
+		    case LAYMAN_MESH_INDEX_FORMAT_UINT8:
+			    ((uint8_t *) destination)[i] = index;
+			    break;
+		    case LAYMAN_MESH_INDEX_FORMAT_UINT16:
+			    ((uint16_t *) destination)[i] = index;
+			    break;
+		    case LAYMAN_MESH_INDEX_FORMAT_UINT32:
+			    ((uint32_t *) destination)[i] = index;
+			    break;
+		}
+	}
+}
+
 void layman_mesh_switch(const struct layman_mesh *new) {
 	thread_local static const struct layman_mesh *current;
 
@@ -131,13 +362,132 @@ void layman_mesh_switch(const struct layman_mesh *new) {
 	}
 }
 
+void layman_mesh_assign_lods(struct layman_mesh *mesh, const struct layman_mesh_lod *lods, size_t count) {
+	count = count < LAYMAN_MESH_LODS ? count : LAYMAN_MESH_LODS;
+	memcpy(mesh->lods, lods, count * sizeof *lods);
+	mesh->lods_count = count;
+}
+
+void layman_mesh_assign_meshlets(struct layman_mesh *mesh, const struct layman_meshlet *meshlets, size_t count) {
+	layman_meshlets_destroy(mesh->meshlets);
+	mesh->meshlets = count > 0 ? layman_meshlets_create(meshlets, count) : NULL;
+}
+
+void layman_mesh_assign_bounds(struct layman_mesh *mesh, const vec3 min, const vec3 max) {
+	glm_vec3_copy((float *) min, mesh->aabb_min);
+	glm_vec3_copy((float *) max, mesh->aabb_max);
+
+	// Infinite boxes would overflow into NaNs below.
+	if (min[0] == -FLT_MAX || max[0] == FLT_MAX) {
+		glm_vec3_zero(mesh->sphere_center);
+		mesh->sphere_radius = FLT_MAX;
+		return;
+	}
+
+	// Not the tightest sphere, but it only needs to be conservative.
+	vec3 half_diagonal;
+	glm_vec3_center((float *) min, (float *) max, mesh->sphere_center);
+	glm_vec3_sub((float *) max, mesh->sphere_center, half_diagonal);
+	mesh->sphere_radius = glm_vec3_norm(half_diagonal);
+}
+
+void layman_mesh_positions_bounds(const float *positions, size_t count, size_t stride, vec3 aabb_min, vec3 aabb_max) {
+	if (count == 0) {
+		glm_vec3_copy((vec3) { FLT_MAX, FLT_MAX, FLT_MAX}, aabb_min);
+		glm_vec3_copy((vec3) { -FLT_MAX, -FLT_MAX, -FLT_MAX}, aabb_max);
+		return;
+	}
+
+	if (stride == 0) {
+		stride = 3 * sizeof (float);
+	}
+
+	const unsigned char *cursor = (const unsigned char *) positions;
+
+	#ifdef USE_SSE
+	// The fourth lane is whatever follows the position in memory; it's ignored.
+	// Every position but the last is guaranteed to be followed by at least one more float.
+	__m128 min = _mm_set_ps(0, positions[2], positions[1], positions[0]);
+	__m128 max = min;
+
+	for (size_t i = 1; i + 1 < count; i++) {
+		__m128 position = _mm_loadu_ps((const float *) (cursor + i * stride));
+		min = _mm_min_ps(min, position);
+		max = _mm_max_ps(max, position);
+	}
+
+	const float *last = (const float *) (cursor + (count - 1) * stride);
+	__m128 position = _mm_set_ps(0, last[2], last[1], last[0]);
+	min = _mm_min_ps(min, position);
+	max = _mm_max_ps(max, position);
+
+	float lanes_min[4], lanes_max[4];
+	_mm_storeu_ps(lanes_min, min);
+	_mm_storeu_ps(lanes_max, max);
+	glm_vec3_copy(lanes_min, aabb_min);
+	glm_vec3_copy(lanes_max, aabb_max);
+	#else
+	glm_vec3_copy((float *) positions, aabb_min);
+	glm_vec3_copy((float *) positions, aabb_max);
+
+	for (size_t i = 1; i < count; i++) {
+		float *position = (float *) (cursor + i * stride);
+		glm_vec3_minv(aabb_min, position, aabb_min);
+		glm_vec3_maxv(aabb_max, position, aabb_max);
+	}
+	#endif
+}
+
+void layman_mesh_compute_bounds(struct layman_mesh *mesh, const float *positions, size_t count, size_t stride) {
+	if (count == 0) {
+		return;
+	}
+
+	vec3 aabb_min, aabb_max;
+	layman_mesh_positions_bounds(positions, count, stride, aabb_min, aabb_max);
+	layman_mesh_assign_bounds(mesh, aabb_min, aabb_max);
+}
+
+void layman_mesh_bind_instances(const struct layman_mesh *mesh, GLuint buffer, size_t first) {
+	layman_mesh_switch(mesh);
+	layman_mesh_point_instances(buffer, first);
+}
+
+void layman_mesh_enable_instances(void) {
+	for (size_t column = 0; column < 4; column++) {
+		glEnableVertexAttribArray(LAYMAN_MESH_ATTRIBUTE_MODEL_MATRIX + column);
+		glVertexAttribDivisor(LAYMAN_MESH_ATTRIBUTE_MODEL_MATRIX + column, 1);
+		glEnableVertexAttribArray(LAYMAN_MESH_ATTRIBUTE_NORMAL_MATRIX + column);
+		glVertexAttribDivisor(LAYMAN_MESH_ATTRIBUTE_NORMAL_MATRIX + column, 1);
+	}
+}
+
+void layman_mesh_point_instances(GLuint buffer, size_t first) {
+	// Attribute pointers are captured by the VAO along with the buffer bound at the time of the call.
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	size_t stride = sizeof (struct layman_instance);
+	size_t base = first * stride;
+
+	for (size_t column = 0; column < 4; column++) {
+		size_t model_offset = base + offsetof(struct layman_instance, model_matrix) + column * sizeof (vec4);
+		size_t normal_offset = base + offsetof(struct layman_instance, normal_matrix) + column * sizeof (vec4);
+
+		glVertexAttribPointer(LAYMAN_MESH_ATTRIBUTE_MODEL_MATRIX + column, 4, GL_FLOAT, false, stride, (void *) model_offset);
+		glVertexAttribPointer(LAYMAN_MESH_ATTRIBUTE_NORMAL_MATRIX + column, 4, GL_FLOAT, false, stride, (void *) normal_offset);
+	}
+}
+
 void layman_mesh_destroy(struct layman_mesh *mesh) {
-	layman_shader_destroy(mesh->shader);
+	layman_shader_release(mesh->shader);
+	layman_meshlets_destroy(mesh->meshlets);
 
 	glDeleteBuffers(1, &mesh->ebo_indices);
 	glDeleteBuffers(1, &mesh->vbo_positions);
 	glDeleteBuffers(1, &mesh->vbo_normals);
+	glDeleteBuffers(1, &mesh->vbo_uvs);
 	glDeleteBuffers(1, &mesh->vbo_tangents);
 	glDeleteBuffers(1, &mesh->vbo_bitangents);
+	glDeleteBuffers(1, &mesh->vbo_vertices);
 	glDeleteVertexArrays(1, &mesh->vao);
 }
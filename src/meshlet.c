@@ -0,0 +1,335 @@
+#include "layman.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// Meshlets stop growing out of the triangles around their first one once that many triangles are in, anything else
+// left scattered around the mesh joins smaller ones rather than making meshlets of its own.
+#define MIN_TRIANGLES (LAYMAN_MESHLET_TRIANGLES / 4)
+
+#define NONE UINT32_MAX
+
+// The meshlet being grown.
+struct growth {
+	uint32_t id;
+	size_t vertices_count;
+	size_t triangles_count;
+
+	uint32_t *candidates; // Triangles sharing a vertex with the meshlet, some already taken.
+	size_t candidates_count;
+};
+
+static const float *position(const float *positions, size_t stride, uint32_t vertex) {
+	return (const float *) ((const unsigned char *) positions + vertex * stride);
+}
+
+// Unit normals of the triangles, null for degenerate ones.
+static void compute_normals(const uint32_t *indices, size_t triangles_count, const float *positions, size_t stride, vec3 *normals) {
+	for (size_t t = 0; t < triangles_count; t++) {
+		const float *p0 = position(positions, stride, indices[t * 3 + 0]);
+		const float *p1 = position(positions, stride, indices[t * 3 + 1]);
+		const float *p2 = position(positions, stride, indices[t * 3 + 2]);
+
+		vec3 edge1, edge2;
+		glm_vec3_sub((float *) p1, (float *) p0, edge1);
+		glm_vec3_sub((float *) p2, (float *) p0, edge2);
+		glm_vec3_cross(edge1, edge2, normals[t]);
+
+		float length = glm_vec3_norm(normals[t]);
+		if (length > 0) {
+			glm_vec3_scale(normals[t], 1.0f / length, normals[t]);
+		} else {
+			glm_vec3_zero(normals[t]);
+		}
+	}
+}
+
+// The vertices of a triangle not in the meshlet yet.
+static size_t new_vertices(const uint32_t *triangle, const uint32_t *vertex_meshlets, uint32_t id) {
+	size_t count = vertex_meshlets[triangle[0]] != id;
+	count += vertex_meshlets[triangle[1]] != id && triangle[1] != triangle[0];
+	count += vertex_meshlets[triangle[2]] != id && triangle[2] != triangle[0] && triangle[2] != triangle[1];
+	return count;
+}
+
+// Adds a triangle to the meshlet, its neighbours becoming candidates.
+static void take(struct growth *growth, uint32_t triangle, const uint32_t *indices, const struct layman_adjacency *adjacency, uint32_t *triangle_meshlets, uint32_t *listed, uint32_t *vertex_meshlets) {
+	triangle_meshlets[triangle] = growth->id;
+	growth->triangles_count++;
+
+	for (size_t k = 0; k < 3; k++) {
+		uint32_t vertex = indices[triangle * 3 + k];
+		if (vertex_meshlets[vertex] == growth->id) {
+			continue;
+		}
+
+		vertex_meshlets[vertex] = growth->id;
+		growth->vertices_count++;
+
+		for (uint32_t j = adjacency->offsets[vertex]; j < adjacency->offsets[vertex + 1]; j++) {
+			uint32_t neighbour = adjacency->triangles[j];
+			if (triangle_meshlets[neighbour] == NONE && listed[neighbour] != growth->id) {
+				listed[neighbour] = growth->id;
+				growth->candidates[growth->candidates_count++] = neighbour;
+			}
+		}
+	}
+}
+
+// Picks the candidate adding the fewest vertices, then the earliest. Following the order tuned for the vertex cache
+// keeps most of what it gained, weighing in distances or normals costs more there than it gains in culling.
+static uint32_t pick(struct growth *growth, const uint32_t *indices, const uint32_t *triangle_meshlets, const uint32_t *vertex_meshlets) {
+	uint32_t best = NONE;
+	size_t best_extra = SIZE_MAX;
+
+	for (size_t c = 0; c < growth->candidates_count; c++) {
+		uint32_t triangle = growth->candidates[c];
+
+		// Taken since it was listed.
+		if (triangle_meshlets[triangle] != NONE) {
+			growth->candidates[c--] = growth->candidates[--growth->candidates_count];
+			continue;
+		}
+
+		size_t extra = new_vertices(indices + triangle * 3, vertex_meshlets, growth->id);
+		if (growth->vertices_count + extra > LAYMAN_MESHLET_VERTICES) {
+			continue;
+		}
+
+		if (extra < best_extra || (extra == best_extra && triangle < best)) {
+			best = triangle;
+			best_extra = extra;
+		}
+	}
+
+	return best;
+}
+
+static int compare_triangles(const void *a, const void *b) {
+	uint32_t first = *(const uint32_t *) a;
+	uint32_t second = *(const uint32_t *) b;
+	return first < second ? -1 : first > second;
+}
+
+// Bounding sphere around the center of the bounding box, and normal cone around the average normal.
+static void compute_bounds(struct layman_meshlet *meshlet, const uint32_t *indices, const float *positions, size_t stride, const vec3 *normals, const uint32_t *triangles) {
+	size_t triangles_count = meshlet->indices_count / 3;
+
+	vec3 min = {FLT_MAX, FLT_MAX, FLT_MAX};
+	vec3 max = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+	vec3 normal = GLM_VEC3_ZERO_INIT;
+	for (size_t t = 0; t < triangles_count; t++) {
+		for (size_t k = 0; k < 3; k++) {
+			const float *p = position(positions, stride, indices[triangles[t] * 3 + k]);
+			glm_vec3_minv(min, (float *) p, min);
+			glm_vec3_maxv(max, (float *) p, max);
+		}
+
+		glm_vec3_add(normal, (float *) normals[triangles[t]], normal);
+	}
+
+	vec3 center;
+	glm_vec3_center(min, max, center);
+
+	float radius = 0;
+	for (size_t t = 0; t < triangles_count; t++) {
+		for (size_t k = 0; k < 3; k++) {
+			const float *p = position(positions, stride, indices[triangles[t] * 3 + k]);
+			radius = fmaxf(radius, glm_vec3_distance(center, (float *) p));
+		}
+	}
+
+	glm_vec3_copy(center, meshlet->center);
+	meshlet->radius = radius;
+
+	// The cone must hold every triangle, degenerate ones aside. Past a half-angle of 90°, some of them always face the
+	// camera.
+	float length = glm_vec3_norm(normal);
+	float min_dot = 1;
+	if (length > 0) {
+		glm_vec3_scale(normal, 1.0f / length, normal);
+
+		for (size_t t = 0; t < triangles_count; t++) {
+			const float *n = normals[triangles[t]];
+			if (n[0] != 0 || n[1] != 0 || n[2] != 0) {
+				min_dot = fminf(min_dot, glm_vec3_dot(normal, (float *) n));
+			}
+		}
+	}
+
+	if (length > 0 && min_dot > 0) {
+		glm_vec3_copy(normal, meshlet->axis);
+		meshlet->cutoff = sqrtf(1.0f - min_dot * min_dot);
+	} else {
+		glm_vec3_zero(meshlet->axis);
+		meshlet->cutoff = 1;
+	}
+}
+
+size_t layman_meshlet_build(uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, struct layman_meshlet **meshlets) {
+	stride = stride ? stride : 3 * sizeof (float);
+	size_t triangles_count = indices_count / 3;
+
+	for (size_t i = 0; i < triangles_count * 3; i++) {
+		if (indices[i] >= vertices_count) {
+			return 0;
+		}
+	}
+
+	if (triangles_count == 0) {
+		return 0;
+	}
+
+	struct layman_adjacency adjacency;
+	if (!layman_adjacency_create(&adjacency, triangles_count * 3, vertices_count)) {
+		return 0;
+	}
+
+	vec3 *normals = malloc(triangles_count * sizeof *normals);
+	uint32_t *triangle_meshlets = malloc(triangles_count * sizeof *triangle_meshlets);
+	uint32_t *listed = malloc(triangles_count * sizeof *listed);
+	uint32_t *vertex_meshlets = malloc(vertices_count * sizeof *vertex_meshlets);
+	uint32_t *order = malloc(triangles_count * sizeof *order);
+	uint32_t *candidates = malloc(triangles_count * sizeof *candidates);
+	uint32_t *reordered = malloc(triangles_count * 3 * sizeof *reordered);
+	*meshlets = malloc(triangles_count * sizeof **meshlets); // At worst, a meshlet per triangle.
+	if (!normals || !triangle_meshlets || !listed || !vertex_meshlets || !order || !candidates || !reordered || !*meshlets) {
+		layman_adjacency_destroy(&adjacency);
+		free(normals);
+		free(triangle_meshlets);
+		free(listed);
+		free(vertex_meshlets);
+		free(order);
+		free(candidates);
+		free(reordered);
+		free(*meshlets);
+		*meshlets = NULL;
+		return 0;
+	}
+
+	layman_adjacency_build(&adjacency, indices, triangles_count * 3, vertices_count);
+	compute_normals(indices, triangles_count, positions, stride, normals);
+	memset(triangle_meshlets, 0xFF, triangles_count * sizeof *triangle_meshlets);
+	memset(listed, 0xFF, triangles_count * sizeof *listed);
+	memset(vertex_meshlets, 0xFF, vertices_count * sizeof *vertex_meshlets);
+
+	size_t meshlets_count = 0;
+	size_t ordered_count = 0;
+	size_t next = 0; // First triangle possibly left.
+
+	while (ordered_count < triangles_count) {
+		struct growth growth = {
+			.id = meshlets_count,
+			.candidates = candidates,
+		};
+
+		size_t first = ordered_count;
+
+		while (growth.triangles_count < LAYMAN_MESHLET_TRIANGLES) {
+			uint32_t triangle = growth.triangles_count > 0 ? pick(&growth, indices, triangle_meshlets, vertex_meshlets) : NONE;
+
+			// Nothing around fits, start over from the next triangle left if the meshlet is still small.
+			if (triangle == NONE) {
+				while (next < triangles_count && triangle_meshlets[next] != NONE) {
+					next++;
+				}
+
+				bool small = growth.triangles_count < MIN_TRIANGLES && growth.vertices_count + 3 <= LAYMAN_MESHLET_VERTICES;
+				if (next == triangles_count || (growth.triangles_count > 0 && !small)) {
+					break;
+				}
+
+				triangle = next;
+			}
+
+			take(&growth, triangle, indices, &adjacency, triangle_meshlets, listed, vertex_meshlets);
+			order[ordered_count++] = triangle;
+		}
+
+		// Back to the order the triangles came in, tuned for the vertex cache.
+		qsort(order + first, ordered_count - first, sizeof *order, compare_triangles);
+
+		struct layman_meshlet *meshlet = *meshlets + meshlets_count++;
+		meshlet->first_index = first * 3;
+		meshlet->indices_count = (ordered_count - first) * 3;
+		compute_bounds(meshlet, indices, positions, stride, (const vec3 *) normals, order + first);
+	}
+
+	for (size_t t = 0; t < triangles_count; t++) {
+		memcpy(reordered + t * 3, indices + order[t] * 3, 3 * sizeof *reordered);
+	}
+
+	memcpy(indices, reordered, triangles_count * 3 * sizeof *indices);
+
+	layman_adjacency_destroy(&adjacency);
+	free(normals);
+	free(triangle_meshlets);
+	free(listed);
+	free(vertex_meshlets);
+	free(order);
+	free(candidates);
+	free(reordered);
+
+	// Trimming can't fail in practice, the meshlets are fine where they are otherwise.
+	struct layman_meshlet *trimmed = realloc(*meshlets, meshlets_count * sizeof **meshlets);
+	if (trimmed) {
+		*meshlets = trimmed;
+	}
+
+	return meshlets_count;
+}
+
+struct layman_meshlets *layman_meshlets_create(const struct layman_meshlet *source, size_t count) {
+	struct layman_meshlets *meshlets = malloc(sizeof *meshlets);
+	if (!meshlets) {
+		return NULL;
+	}
+
+	// The bounds share an allocation, as do the ranges.
+	size_t padded = (count + 3) / 4 * 4;
+	float *bounds = calloc(padded * 8, sizeof *bounds);
+	uint32_t *ranges = calloc(padded * 2, sizeof *ranges);
+	if (!bounds || !ranges) {
+		free(bounds);
+		free(ranges);
+		free(meshlets);
+		return NULL;
+	}
+
+	meshlets->center_x = bounds;
+	meshlets->center_y = bounds + padded;
+	meshlets->center_z = bounds + padded * 2;
+	meshlets->radius = bounds + padded * 3;
+	meshlets->axis_x = bounds + padded * 4;
+	meshlets->axis_y = bounds + padded * 5;
+	meshlets->axis_z = bounds + padded * 6;
+	meshlets->cutoff = bounds + padded * 7;
+	meshlets->first_index = ranges;
+	meshlets->indices_count = ranges + padded;
+	meshlets->count = count;
+
+	for (size_t i = 0; i < count; i++) {
+		meshlets->center_x[i] = source[i].center[0];
+		meshlets->center_y[i] = source[i].center[1];
+		meshlets->center_z[i] = source[i].center[2];
+		meshlets->radius[i] = source[i].radius;
+		meshlets->axis_x[i] = source[i].axis[0];
+		meshlets->axis_y[i] = source[i].axis[1];
+		meshlets->axis_z[i] = source[i].axis[2];
+		meshlets->cutoff[i] = source[i].cutoff;
+		meshlets->first_index[i] = source[i].first_index;
+		meshlets->indices_count[i] = source[i].indices_count;
+	}
+
+	return meshlets;
+}
+
+void layman_meshlets_destroy(struct layman_meshlets *meshlets) {
+	if (!meshlets) {
+		return;
+	}
+
+	free(meshlets->center_x);
+	free(meshlets->first_index);
+	free(meshlets);
+}
@@ -1,5 +1,260 @@
 #include "gltf.h"
 #include "layman.h"
+#include "layman/import.h"
+#include <float.h>
+#include <stddef.h>
+
+// LODs generated for every mesh, the full detail included, and the ratio of the triangles of each to the one before.
+#define MODEL_LODS 4
+#define MODEL_LODS_RATIO 0.5f
+
+// Encoded images of the glTF file to decode.
+struct decoding {
+	const cgltf_data *gltf;
+	struct layman_image *images; // By glTF image index.
+	size_t *indices;             // Of the images to decode.
+};
+
+static void decode_image(size_t index, void *data) {
+	struct decoding *decoding = data;
+	size_t image_i = decoding->indices[index];
+	const cgltf_image *image = decoding->gltf->images + image_i;
+
+	// Failures are left for the upload to report, it decodes again and fails the same way.
+	layman_image_decode(decoding->images + image_i, layman_import_image_data(decoding->gltf, image), image->buffer_view->size);
+}
+
+// Decodes every image the materials need in parallel, only leaving the uploads for the thread owning the context.
+// Images already uploaded by a previous model are skipped. When there's a staging ring, the images are decoded straight
+// into it and streamed in later instead.
+// Returns `NULL` when out of memory, the textures then get decoded one by one as they're loaded.
+static struct layman_image *decode_images(const cgltf_data *gltf, struct layman_streaming *streaming) {
+	struct layman_image *images = calloc(gltf->images_count, sizeof *images);
+	size_t *indices = malloc(gltf->images_count * sizeof *indices);
+	bool *queued = calloc(gltf->images_count, sizeof *queued);
+	bool *compressed = calloc(gltf->images_count, sizeof *compressed);
+	if (!images || !indices || !queued || !compressed) {
+		free(images);
+		free(indices);
+		free(queued);
+		free(compressed);
+		return NULL;
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < gltf->materials_count; i++) {
+		for (size_t j = 0; j < LAYMAN_IMPORT_TEXTURES; j++) {
+			enum layman_texture_kind kind = layman_import_texture_kinds[j];
+			const cgltf_image *image = layman_import_texture(gltf->materials + i, j);
+			if (!image || layman_texture_cached(kind, layman_import_image_data(gltf, image), image->buffer_view->size)) {
+				continue;
+			}
+
+			// Images used several times get decoded once.
+			size_t image_i = image - gltf->images;
+			if (!queued[image_i]) {
+				queued[image_i] = true;
+				indices[count++] = image_i;
+			}
+
+			if (layman_texture_compressed(kind)) {
+				compressed[image_i] = true;
+			}
+		}
+	}
+
+	// Reserving staging memory isn't thread-safe, writing to it is.
+	// Images to compress are read back by the encoder, they stay out of the write-combined staging memory.
+	if (streaming) {
+		for (size_t i = 0; i < count; i++) {
+			const cgltf_image *image = gltf->images + indices[i];
+			if (!compressed[indices[i]]) {
+				layman_image_stage(images + indices[i], streaming, layman_import_image_data(gltf, image), image->buffer_view->size);
+			}
+		}
+	}
+
+	layman_parallel_for(count, decode_image, &(struct decoding) {gltf, images, indices});
+
+	free(indices);
+	free(queued);
+	free(compressed);
+
+	return images;
+}
+
+static void free_images(const cgltf_data *gltf, struct layman_image *images) {
+	if (!images) {
+		return;
+	}
+
+	for (size_t i = 0; i < gltf->images_count; i++) {
+		layman_image_free(images + i);
+	}
+
+	free(images);
+}
+
+// Loads one of the textures of a material, see layman_import_texture(), if it has it.
+static struct layman_texture *load_texture(const cgltf_data *gltf, const struct layman_image *images, const cgltf_material *source, size_t texture) {
+	const cgltf_image *image = layman_import_texture(source, texture);
+	if (!image) {
+		return NULL;
+	}
+
+	// Images not decoded in parallel, because cached or because it failed, go through the usual path.
+	const struct layman_image *decoded = images ? images + (image - gltf->images) : NULL;
+	return layman_texture_acquire(layman_import_texture_kinds[texture], layman_import_image_data(gltf, image), image->buffer_view->size, decoded && decoded->pixels ? decoded : NULL);
+}
+
+// Loads a glTF material, or creates the default one when there's none.
+static struct layman_material *load_material(const cgltf_data *gltf, const struct layman_image *images, const cgltf_material *source) {
+	struct layman_material *material = layman_material_create();
+	if (!material) {
+		return NULL;
+	}
+
+	// The default material.
+	if (!source) {
+		return material;
+	}
+
+	const cgltf_pbr_metallic_roughness *pbr = &source->pbr_metallic_roughness;
+
+	VEC4_ASSIGN(material->base_color_factor, pbr->base_color_factor[0], pbr->base_color_factor[1], pbr->base_color_factor[2], pbr->base_color_factor[3]);
+	material->metallic_factor = pbr->metallic_factor;
+	material->roughness_factor = pbr->roughness_factor;
+	material->normal_scale = source->normal_texture.scale;
+	material->occlusion_strength = source->occlusion_texture.scale;
+	VEC3_ASSIGN(material->emissive_factor, source->emissive_factor[0], source->emissive_factor[1], source->emissive_factor[2]);
+
+	// Only the textures actually present get loaded, the shader permutation skips the others.
+	// In the order of `layman_import_texture_kinds`.
+	struct layman_texture **slots[] = {
+		&material->base_color_texture,
+		&material->metallic_roughness_texture,
+		&material->normal_texture,
+		&material->occlusion_texture,
+		&material->emissive_texture,
+	};
+
+	for (size_t i = 0; i < ARRAY_COUNT(slots); i++) {
+		*slots[i] = load_texture(gltf, images, source, i);
+	}
+
+	material->occlusion_packed = layman_import_occlusion_packed(source);
+
+	switch (source->alpha_mode) {
+	    case cgltf_alpha_mode_opaque:
+		    material->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE;
+		    break;
+
+	    case cgltf_alpha_mode_mask:
+		    material->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_MASK;
+		    break;
+
+	    case cgltf_alpha_mode_blend:
+		    material->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_BLEND;
+		    break;
+	}
+
+	material->alpha_cutoff = source->alpha_cutoff;
+	material->unlit = source->unlit; // KHR_materials_unlit.
+	material->double_sided = source->double_sided;
+
+	return material;
+}
+
+// Loads every material of a glTF file once, followed by the default material.
+static bool load_materials(struct layman_model *model, const cgltf_data *gltf, const struct layman_image *images) {
+	size_t materials_count = gltf->materials_count + 1;
+
+	model->materials = malloc(materials_count * sizeof *model->materials);
+	if (!model->materials) {
+		return false;
+	}
+
+	model->materials_count = materials_count;
+	for (size_t i = 0; i < materials_count; i++) {
+		model->materials[i] = NULL;
+	}
+
+	for (size_t i = 0; i < materials_count; i++) {
+		model->materials[i] = load_material(gltf, images, i < gltf->materials_count ? gltf->materials + i : NULL);
+		if (model->materials[i]) {
+			model->materials[i] = layman_material_acquire(model->materials[i]);
+		}
+		if (!model->materials[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void unload_materials(struct layman_model *model) {
+	for (size_t i = 0; i < model->materials_count; i++) {
+		layman_material_release(model->materials[i]);
+	}
+
+	free(model->materials);
+
+	model->materials = NULL;
+	model->materials_count = 0;
+}
+
+// A vertex stream of a primitive, as found in the glTF buffers.
+struct stream {
+	const float **data;
+	size_t *stride;
+	size_t count;
+	size_t components;
+};
+
+// Reorders a primitive for the vertex cache, overdraw and vertex fetches, see layman_optimizer_optimize().
+// The indices are rewritten in place, the streams replaced by reordered copies, tightly packed, which go to `copies` for
+// the caller to free. Positions come first.
+// Returns `false` when the primitive is left as authored: a stream not covering every vertex, indices making no sense
+// or not enough memory.
+static bool optimize_primitive(struct stream *streams, size_t streams_count, uint32_t *indices, size_t indices_count, void **copies) {
+	size_t vertices_count = streams[0].count;
+	for (size_t s = 0; s < streams_count; s++) {
+		if (*streams[s].data && streams[s].count != vertices_count) {
+			return false;
+		}
+	}
+
+	// The optimizer only touches the indices on success, which needs the copies ready first.
+	uint32_t *remap = malloc(vertices_count * sizeof *remap);
+	bool done = remap != NULL;
+	for (size_t s = 0; s < streams_count && done; s++) {
+		if (*streams[s].data) {
+			copies[s] = malloc(vertices_count * streams[s].components * sizeof (float));
+			done = copies[s] != NULL;
+		}
+	}
+
+	done = done && layman_optimizer_optimize(indices, indices_count, *streams[0].data, *streams[0].stride, vertices_count, remap);
+
+	if (done) {
+		for (size_t s = 0; s < streams_count; s++) {
+			if (*streams[s].data) {
+				layman_optimizer_remap(*streams[s].data, streams[s].components * sizeof (float), *streams[s].stride, vertices_count, remap, copies[s]);
+				*streams[s].data = copies[s];
+				*streams[s].stride = 0;
+			}
+		}
+	} else {
+		for (size_t s = 0; s < streams_count; s++) {
+			free(copies[s]);
+			copies[s] = NULL;
+		}
+	}
+
+	free(remap);
+
+	return done;
+}
 
 bool load_meshes(struct layman_model *model, const cgltf_data *gltf) {
 	size_t mesh_count = 0;
@@ -42,8 +297,6 @@ bool load_meshes(struct layman_model *model, const cgltf_data *gltf) {
 			const float *normals = NULL;
 			size_t normals_count = 0;
 			size_t normals_stride = 0;
-			const unsigned short *indices = NULL;
-			size_t indices_count = 0;
 			const float *uvs = NULL;
 			size_t uvs_count = 0;
 			size_t uvs_stride = 0;
@@ -100,13 +353,51 @@ bool load_meshes(struct layman_model *model, const cgltf_data *gltf) {
 				}
 			}
 
-			if (primitive->indices->component_type != cgltf_component_type_r_16u) {
-				fprintf(stderr, "Unsupported mesh indices type\n");
+			// Indices of any width, made up for primitives without. Read as 32-bit for the optimizer, then narrowed to the
+			// smallest format addressing every vertex.
+			size_t indices_count = primitive->indices ? primitive->indices->count : vertices_count;
+			uint32_t *indices = malloc(indices_count * sizeof *indices + 1);
+			if (!indices) {
 				return false;
 			}
 
-			indices = gltf->bin + primitive->indices->buffer_view->offset;
-			indices_count = primitive->indices->count;
+			for (size_t i = 0; i < indices_count; i++) {
+				indices[i] = primitive->indices ? cgltf_accessor_read_index(primitive->indices, i) : i;
+			}
+
+			// Reordered copies of everything, freed once uploaded.
+			struct stream streams[] = {
+				{&vertices, &vertices_stride, vertices_count, 3},
+				{&normals, &normals_stride, normals_count, 3},
+				{&uvs, &uvs_stride, uvs_count, 2},
+				{&tangents, &tangents_stride, tangents_count, 4},
+			};
+			void *copies[ARRAY_COUNT(streams) + 1] = {0};
+			optimize_primitive(streams, ARRAY_COUNT(streams), indices, indices_count, copies);
+
+			// Coarser LODs go right after the full detail, in the same index buffer.
+			struct layman_mesh_lod lods[LAYMAN_MESH_LODS] = {{0, indices_count, 0.0f}};
+			size_t lods_count = 1;
+			if (vertices) {
+				lods_count = layman_simplifier_chain(&indices, indices_count, vertices, vertices_stride, vertices_count, MODEL_LODS, MODEL_LODS_RATIO, lods);
+			}
+
+			// The full detail gets split into meshlets, culled one by one. Coarser LODs are too small on screen to gain much.
+			struct layman_meshlet *meshlets = NULL;
+			size_t meshlets_count = 0;
+			if (vertices) {
+				meshlets_count = layman_meshlet_build(indices, lods[0].indices_count, vertices, vertices_stride, vertices_count, &meshlets);
+			}
+
+			size_t all_indices_count = lods[lods_count - 1].first_index + lods[lods_count - 1].indices_count;
+
+			enum layman_mesh_index_format indices_format = layman_mesh_index_format_fit(vertices_count);
+			layman_mesh_narrow_indices(indices, all_indices_count, indices_format, indices);
+			copies[ARRAY_COUNT(streams)] = indices;
+
+			// Primitives sharing a glTF material share the layman one; those without use the default one, last.
+			size_t material_i = primitive->material ? (size_t) (primitive->material - gltf->materials) : gltf->materials_count;
+			const struct layman_material *material = model->materials[material_i];
 
 			// Create the mesh from raw data.
 			struct layman_mesh *mesh = layman_mesh_create_from_raw(
@@ -117,49 +408,47 @@ bool load_meshes(struct layman_model *model, const cgltf_data *gltf) {
 					// UVs.
 					uvs, uvs_count, uvs_stride,
 					// Indices.
-					indices, indices_count,
+					indices, all_indices_count, indices_format,
 					// Tangents.
-					tangents, tangents_count, tangents_stride);
+					tangents, tangents_count, tangents_stride,
+					// Material.
+					material);
 
 			if (!mesh) {
+				for (size_t i = 0; i < ARRAY_COUNT(copies); i++) {
+					free(copies[i]);
+				}
+
+				free(meshlets);
 				return false;
 			}
 
-			// Load material.
-			struct layman_material *material = layman_material_create();
-
-			// Base color factor.
-			cgltf_float *base_color_factor = primitive->material->pbr_metallic_roughness.base_color_factor;
-			VEC4_ASSIGN(material->base_color_factor, base_color_factor[0], base_color_factor[1], base_color_factor[2], base_color_factor[3]);
-			// Base color texture
-			cgltf_texture *base_color_texture = primitive->material->pbr_metallic_roughness.base_color_texture.texture;
-			const void *base_color_texture_data = gltf->bin + base_color_texture->image->buffer_view->offset;
-			size_t base_color_texture_size = primitive->material->pbr_metallic_roughness.base_color_texture.texture->image->buffer_view->size;
-			material->base_color_texture = layman_texture_create_from_memory(LAYMAN_TEXTURE_KIND_ALBEDO, base_color_texture_data, base_color_texture_size);
-			// Normal texture
-			cgltf_texture *normal_texture = primitive->material->normal_texture.texture;
-			const void *normal_texture_data = gltf->bin + normal_texture->image->buffer_view->offset;
-			size_t normal_texture_size = primitive->material->normal_texture.texture->image->buffer_view->size;
-			material->normal_texture = layman_texture_create_from_memory(LAYMAN_TEXTURE_KIND_NORMAL, normal_texture_data, normal_texture_size);
-			// Metallic/roughness texture
-			cgltf_texture *metallic_roughness_texture = primitive->material->pbr_metallic_roughness.metallic_roughness_texture.texture;
-			const void *metallic_roughness_texture_data = gltf->bin + metallic_roughness_texture->image->buffer_view->offset;
-			size_t metallic_roughness_texture_size = primitive->material->pbr_metallic_roughness.metallic_roughness_texture.texture->image->buffer_view->size;
-			material->metallic_roughness_texture = layman_texture_create_from_memory(LAYMAN_TEXTURE_KIND_METALLIC_ROUGHNESS, metallic_roughness_texture_data, metallic_roughness_texture_size);
-			// Occlusion texture
-			cgltf_texture *occlusion_texture = primitive->material->occlusion_texture.texture;
-			const void *occlusion_texture_data = gltf->bin + occlusion_texture->image->buffer_view->offset;
-			size_t occlusion_texture_size = primitive->material->occlusion_texture.texture->image->buffer_view->size;
-			material->occlusion_texture = layman_texture_create_from_memory(LAYMAN_TEXTURE_KIND_OCCLUSION, occlusion_texture_data, occlusion_texture_size);
-			// Emission texture
-			cgltf_texture *emission_texture = primitive->material->emissive_texture.texture;
-			const void *emission_texture_data = gltf->bin + emission_texture->image->buffer_view->offset;
-			size_t emission_texture_size = primitive->material->emissive_texture.texture->image->buffer_view->size;
-			material->emissive_texture = layman_texture_create_from_memory(LAYMAN_TEXTURE_KIND_EMISSION, emission_texture_data, emission_texture_size);
-
-			mesh->material = material; // FIXME: Leaking the material?!
+			layman_mesh_assign_lods(mesh, lods, lods_count);
+			layman_mesh_assign_meshlets(mesh, meshlets, meshlets_count);
+			free(meshlets);
+
+			// Bounding volumes.
+			// The accessor bounds are mandatory for positions in glTF, but we don't trust every exporter.
+			const cgltf_accessor *positions = NULL;
+			for (size_t attribute_i = 0; attribute_i < primitive->attributes_count; attribute_i++) {
+				if (primitive->attributes[attribute_i].type == cgltf_attribute_type_position) {
+					positions = primitive->attributes[attribute_i].data;
+				}
+			}
+
+			if (positions && positions->has_min && positions->has_max) {
+				layman_mesh_assign_bounds(mesh, positions->min, positions->max);
+			} else if (vertices) {
+				layman_mesh_compute_bounds(mesh, vertices, vertices_count, vertices_stride);
+			}
+
+			for (size_t i = 0; i < ARRAY_COUNT(copies); i++) {
+				free(copies[i]);
+			}
 
 			model->meshes[final_mesh_i++] = mesh;
+
+			layman_model_enclose(model->aabb_min, model->aabb_max, mesh->aabb_min, mesh->aabb_max);
 		}
 	}
 
@@ -182,10 +471,34 @@ void unload_meshes(struct layman_model *model) {
 	model->meshes_count = 0;
 }
 
+void layman_model_enclose(vec3 aabb_min, vec3 aabb_max, const vec3 mesh_min, const vec3 mesh_max) {
+	glm_vec3_minv(aabb_min, (float *) mesh_min, aabb_min);
+	glm_vec3_maxv(aabb_max, (float *) mesh_max, aabb_max);
+}
+
+// Creates an empty model.
+static struct layman_model *create_model(void) {
+	struct layman_model *model = malloc(sizeof *model);
+	if (!model) {
+		return NULL;
+	}
+
+	model->meshes = NULL;
+	model->meshes_count = 0;
+	model->materials = NULL;
+	model->materials_count = 0;
+
+	// Empty box, grown by every mesh loaded.
+	VEC3_ASSIGN(model->aabb_min, FLT_MAX, FLT_MAX, FLT_MAX);
+	VEC3_ASSIGN(model->aabb_max, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	return model;
+}
+
 struct layman_model *layman_model_load(const struct layman_window *window, const char *filepath) {
 	layman_window_use(window);
 
-	struct layman_model *model = malloc(sizeof *model);
+	struct layman_model *model = create_model();
 	if (!model) {
 		layman_window_unuse(window);
 		return NULL;
@@ -200,10 +513,10 @@ struct layman_model *layman_model_load(const struct layman_window *window, const
 		return NULL;
 	}
 
-	model->meshes = NULL;
-	model->meshes_count = 0;
-
-	bool loaded = load_meshes(model, gltf);
+	// Materials first, meshes refer to them.
+	struct layman_image *images = decode_images(gltf, window->streaming);
+	bool loaded = load_materials(model, gltf, images) && load_meshes(model, gltf);
+	free_images(gltf, images);
 
 	cgltf_free(gltf);
 
@@ -218,9 +531,181 @@ struct layman_model *layman_model_load(const struct layman_window *window, const
 	return model;
 }
 
+// Creates a texture of a pack, unreferenced until a material uses it.
+static struct layman_texture *load_pack_texture(const unsigned char *pack, const struct layman_pack_texture *record) {
+	return layman_texture_create_from_levels(record->kind, record->width, record->height, record->levels, record->format, record->format_internal, pack + record->offset);
+}
+
+static struct layman_material *load_pack_material(const struct layman_pack_material *record, struct layman_texture **textures) {
+	struct layman_material *material = layman_material_create();
+	if (!material) {
+		return NULL;
+	}
+
+	glm_vec4_copy((float *) record->base_color_factor, material->base_color_factor);
+	glm_vec3_copy((float *) record->emissive_factor, material->emissive_factor);
+	material->metallic_factor = record->metallic_factor;
+	material->roughness_factor = record->roughness_factor;
+	material->normal_scale = record->normal_scale;
+	material->occlusion_strength = record->occlusion_strength;
+	material->alpha_mode = record->alpha_mode;
+	material->alpha_cutoff = record->alpha_cutoff;
+	material->unlit = record->flags & LAYMAN_PACK_MATERIAL_UNLIT;
+	material->occlusion_packed = record->flags & LAYMAN_PACK_MATERIAL_OCCLUSION_PACKED;
+	material->double_sided = record->flags & LAYMAN_PACK_MATERIAL_DOUBLE_SIDED;
+
+	// In the order of the record.
+	struct layman_texture **slots[] = {
+		&material->base_color_texture,
+		&material->metallic_roughness_texture,
+		&material->normal_texture,
+		&material->occlusion_texture,
+		&material->emissive_texture,
+	};
+
+	for (size_t i = 0; i < ARRAY_COUNT(slots); i++) {
+		if (record->textures[i] != LAYMAN_PACK_NONE) {
+			*slots[i] = textures[record->textures[i]];
+			(*slots[i])->references++; // Released along with the material.
+		}
+	}
+
+	return material;
+}
+
+// Creates the textures and materials of a validated pack.
+static bool load_pack_materials(struct layman_model *model, const unsigned char *pack) {
+	const struct layman_pack_header *header = (const void *) pack;
+	const struct layman_pack_texture *texture_records = (const void *) (pack + header->textures_offset);
+	const struct layman_pack_material *material_records = (const void *) (pack + header->materials_offset);
+
+	struct layman_texture **textures = calloc(header->textures_count + 1, sizeof *textures);
+	model->materials = calloc(header->materials_count, sizeof *model->materials);
+	if (!textures || !model->materials) {
+		free(textures);
+		return false;
+	}
+
+	model->materials_count = header->materials_count;
+
+	bool loaded = true;
+	for (uint32_t i = 0; i < header->textures_count && loaded; i++) {
+		textures[i] = load_pack_texture(pack, texture_records + i);
+		loaded = textures[i] != NULL;
+	}
+
+	for (uint32_t i = 0; i < header->materials_count && loaded; i++) {
+		model->materials[i] = load_pack_material(material_records + i, textures);
+		if (model->materials[i]) {
+			model->materials[i] = layman_material_acquire(model->materials[i]);
+		}
+		loaded = model->materials[i] != NULL;
+	}
+
+	// The materials own the textures they use, the others go away now.
+	for (uint32_t i = 0; i < header->textures_count; i++) {
+		if (textures[i] && textures[i]->references == 0) {
+			layman_texture_destroy(textures[i]);
+		}
+	}
+
+	free(textures);
+
+	return loaded;
+}
+
+// Creates the meshes of a validated pack.
+static bool load_pack_meshes(struct layman_model *model, const unsigned char *pack) {
+	const struct layman_pack_header *header = (const void *) pack;
+	const struct layman_pack_mesh *records = (const void *) (pack + header->meshes_offset);
+
+	model->meshes = calloc(header->meshes_count + 1, sizeof *model->meshes);
+	if (!model->meshes) {
+		return false;
+	}
+
+	model->meshes_count = header->meshes_count;
+
+	for (uint32_t i = 0; i < header->meshes_count; i++) {
+		const struct layman_pack_mesh *record = records + i;
+
+		struct layman_vertex_format format = layman_pack_vertex_format(record);
+		const void *streams[LAYMAN_VERTEX_STREAMS] = {pack + record->streams_offsets[0], pack + record->streams_offsets[1]};
+
+		struct layman_mesh *mesh = layman_mesh_create_interleaved(&format, streams, record->vertices_count, pack + record->indices_offset, record->indices_count, record->indices_format, model->materials[record->material]);
+		if (!mesh) {
+			return false;
+		}
+
+		struct layman_mesh_lod lods[ARRAY_COUNT(record->lods)];
+		for (uint32_t l = 0; l < record->lods_count; l++) {
+			lods[l] = (struct layman_mesh_lod) {record->lods[l].first_index, record->lods[l].indices_count, record->lods[l].error};
+		}
+
+		layman_mesh_assign_lods(mesh, lods, record->lods_count);
+		layman_mesh_assign_bounds(mesh, record->aabb_min, record->aabb_max);
+		model->meshes[i] = mesh;
+
+		// Meshes simply go without their meshlets when there's no memory for them.
+		const struct layman_pack_meshlet *meshlet_records = (const void *) (pack + record->meshlets_offset);
+		struct layman_meshlet *meshlets = malloc(record->meshlets_count * sizeof *meshlets + 1);
+		if (meshlets) {
+			for (uint32_t m = 0; m < record->meshlets_count; m++) {
+				const struct layman_pack_meshlet *source = meshlet_records + m;
+				meshlets[m] = (struct layman_meshlet) {
+					source->first_index, source->indices_count,
+					{source->center[0], source->center[1], source->center[2]}, source->radius,
+					{source->axis[0], source->axis[1], source->axis[2]}, source->cutoff,
+				};
+			}
+
+			layman_mesh_assign_meshlets(mesh, meshlets, record->meshlets_count);
+			free(meshlets);
+		}
+	}
+
+	glm_vec3_copy((float *) header->aabb_min, model->aabb_min);
+	glm_vec3_copy((float *) header->aabb_max, model->aabb_max);
+
+	return true;
+}
+
+struct layman_model *layman_model_load_pack(const struct layman_window *window, const char *filepath) {
+	size_t size;
+	const unsigned char *pack = layman_pack_map(filepath, &size);
+	if (!pack) {
+		return NULL;
+	}
+
+	if (!layman_pack_validate(pack, size)) {
+		fprintf(stderr, "Invalid or outdated pack: %s\n", filepath);
+		layman_pack_unmap(pack, size);
+		return NULL;
+	}
+
+	layman_window_use(window);
+
+	struct layman_model *model = create_model();
+	bool loaded = model && load_pack_materials(model, pack) && load_pack_meshes(model, pack);
+
+	// Everything was copied to the GPU, the pages of the file can go.
+	layman_pack_unmap(pack, size);
+
+	if (!loaded) {
+		layman_model_destroy(model);
+		layman_window_unuse(window);
+		return NULL;
+	}
+
+	layman_window_unuse(window);
+
+	return model;
+}
+
 void layman_model_destroy(struct layman_model *model) {
 	if (model) {
 		unload_meshes(model);
+		unload_materials(model);
 	}
 
 	free(model);
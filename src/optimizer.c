@@ -0,0 +1,411 @@
+#include "layman.h"
+#include <math.h>
+#include <string.h>
+
+// How much worse than the whole order the cache may get within a cluster, the price of sorting the clusters.
+#define OVERDRAW_THRESHOLD 1.05f
+
+#define NONE UINT32_MAX
+
+// A cluster of triangles and where it should be drawn, for sorting.
+struct cluster {
+	float key;
+	uint32_t index;
+};
+
+// A vertex is in the cache when it missed no more than a cache size ago. Timestamps start past the cache size, such
+// that zeroed ones are all out of it.
+static bool cached(const uint32_t *timestamps, uint32_t time, uint32_t vertex) {
+	return time - timestamps[vertex] <= LAYMAN_OPTIMIZER_CACHE_SIZE;
+}
+
+// Fetches the vertices of a triangle through the cache, returning how many missed.
+static unsigned int fetch(const uint32_t *triangle, uint32_t *timestamps, uint32_t *time) {
+	unsigned int misses = 0;
+	for (size_t k = 0; k < 3; k++) {
+		if (!cached(timestamps, *time, triangle[k])) {
+			timestamps[triangle[k]] = (*time)++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
+
+struct layman_optimizer_statistics layman_optimizer_analyze(const uint32_t *indices, size_t indices_count, size_t vertices_count) {
+	struct layman_optimizer_statistics statistics = {
+		.triangles_count = indices_count / 3,
+		.vertices_count = 0,
+		.transforms = 0,
+	};
+
+	uint32_t *timestamps = calloc(vertices_count + 1, sizeof *timestamps);
+	if (!timestamps) {
+		return statistics;
+	}
+
+	for (size_t i = 0; i < indices_count; i++) {
+		if (indices[i] >= vertices_count) {
+			free(timestamps);
+			return statistics;
+		}
+	}
+
+	uint32_t time = LAYMAN_OPTIMIZER_CACHE_SIZE + 1;
+	for (size_t i = 0; i + 2 < indices_count; i += 3) {
+		for (size_t k = 0; k < 3; k++) {
+			statistics.vertices_count += timestamps[indices[i + k]] == 0;
+		}
+
+		statistics.transforms += fetch(indices + i, timestamps, &time);
+	}
+
+	free(timestamps);
+
+	return statistics;
+}
+
+// Orders triangles for the cache with Tipsify [Sander et al. 2007]. Triangles are emitted in fans around a vertex, the
+// next one being picked among the vertices just emitted: the oldest still in the cache once all its fan is emitted.
+// When none is left, the order jumps elsewhere and the cache is lost; the triangles from there form a new cluster.
+// Returns the number of clusters, whose first triangles are written to `clusters`.
+static size_t order_triangles(const uint32_t *indices, size_t indices_count, size_t vertices_count, uint32_t *output, uint32_t *clusters) {
+	size_t triangles_count = indices_count / 3;
+
+	struct layman_adjacency adjacency;
+	if (!layman_adjacency_create(&adjacency, indices_count, vertices_count)) {
+		return 0;
+	}
+
+	layman_adjacency_build(&adjacency, indices, indices_count, vertices_count);
+
+	// Triangles of each vertex still to emit.
+	uint32_t *live = malloc(vertices_count * sizeof *live);
+	uint32_t *timestamps = calloc(vertices_count, sizeof *timestamps);
+	bool *emitted = calloc(triangles_count, sizeof *emitted);
+
+	// Every vertex emitted, the most recent last. Those of the last fan are the candidates for the next one.
+	uint32_t *dead_ends = malloc(indices_count * sizeof *dead_ends);
+
+	if (!live || !timestamps || !emitted || !dead_ends) {
+		free(live);
+		free(timestamps);
+		free(emitted);
+		free(dead_ends);
+		layman_adjacency_destroy(&adjacency);
+		return 0;
+	}
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+
+	uint32_t time = LAYMAN_OPTIMIZER_CACHE_SIZE + 1;
+	size_t dead_ends_count = 0;
+	size_t written = 0;
+	size_t clusters_count = 0;
+	uint32_t cursor = 0;
+	uint32_t current = 0;
+
+	clusters[clusters_count++] = 0;
+
+	while (current != NONE) {
+		size_t candidates = dead_ends_count;
+
+		for (uint32_t i = adjacency.offsets[current]; i < adjacency.offsets[current + 1]; i++) {
+			uint32_t triangle = adjacency.triangles[i];
+			if (emitted[triangle]) {
+				continue;
+			}
+
+			for (size_t k = 0; k < 3; k++) {
+				uint32_t vertex = indices[triangle * 3 + k];
+				output[written * 3 + k] = vertex;
+				dead_ends[dead_ends_count++] = vertex;
+				live[vertex]--;
+
+				if (!cached(timestamps, time, vertex)) {
+					timestamps[vertex] = time++;
+				}
+			}
+
+			emitted[triangle] = true;
+			written++;
+		}
+
+		// The oldest candidate still in the cache once its fan is emitted, or any with triangles left.
+		uint32_t next = NONE;
+		int64_t best = -1;
+		for (size_t i = candidates; i < dead_ends_count; i++) {
+			uint32_t vertex = dead_ends[i];
+			if (live[vertex] == 0) {
+				continue;
+			}
+
+			int64_t priority = 0;
+			if (time - timestamps[vertex] + 2 * live[vertex] <= LAYMAN_OPTIMIZER_CACHE_SIZE) {
+				priority = time - timestamps[vertex];
+			}
+
+			if (priority > best) {
+				best = priority;
+				next = vertex;
+			}
+		}
+
+		// Dead end: back to the most recent vertex with triangles left, or the next one in the input.
+		if (next == NONE) {
+			while (dead_ends_count > 0 && next == NONE) {
+				uint32_t vertex = dead_ends[--dead_ends_count];
+				next = live[vertex] > 0 ? vertex : NONE;
+			}
+
+			for (; cursor < vertices_count && next == NONE; cursor++) {
+				next = live[cursor] > 0 ? cursor : NONE;
+			}
+
+			if (next != NONE && written < triangles_count && clusters[clusters_count - 1] != written) {
+				clusters[clusters_count++] = written;
+			}
+		}
+
+		current = next;
+	}
+
+	free(live);
+	free(timestamps);
+	free(emitted);
+	free(dead_ends);
+	layman_adjacency_destroy(&adjacency);
+
+	return clusters_count;
+}
+
+// Cuts clusters further wherever the cache, flushed at the start of the cut, has already done as well as over the whole
+// cluster. Returns the new number of clusters, whose first triangles are written to `output`.
+static size_t cut_clusters(const uint32_t *indices, size_t triangles_count, size_t vertices_count, const uint32_t *clusters, size_t clusters_count, uint32_t *output) {
+	uint32_t *timestamps = calloc(vertices_count, sizeof *timestamps);
+	if (!timestamps) {
+		memcpy(output, clusters, clusters_count * sizeof *output);
+		return clusters_count;
+	}
+
+	uint32_t time = LAYMAN_OPTIMIZER_CACHE_SIZE + 1;
+	size_t output_count = 0;
+
+	for (size_t c = 0; c < clusters_count; c++) {
+		size_t start = clusters[c];
+		size_t end = c + 1 < clusters_count ? clusters[c + 1] : triangles_count;
+
+		// Flushing the cache only takes moving time past it.
+		time += LAYMAN_OPTIMIZER_CACHE_SIZE + 1;
+		unsigned int misses = 0;
+		for (size_t t = start; t < end; t++) {
+			misses += fetch(indices + t * 3, timestamps, &time);
+		}
+
+		float threshold = OVERDRAW_THRESHOLD * misses / (end - start);
+
+		output[output_count++] = start;
+		time += LAYMAN_OPTIMIZER_CACHE_SIZE + 1;
+		unsigned int running_misses = 0;
+		for (size_t t = start; t < end; t++) {
+			running_misses += fetch(indices + t * 3, timestamps, &time);
+
+			if (t + 1 < end && (float) running_misses / (t + 1 - output[output_count - 1]) <= threshold) {
+				output[output_count++] = t + 1;
+				time += LAYMAN_OPTIMIZER_CACHE_SIZE + 1;
+				running_misses = 0;
+			}
+		}
+	}
+
+	free(timestamps);
+
+	return output_count;
+}
+
+static const float *position(const float *positions, size_t stride, uint32_t vertex) {
+	return (const float *) ((const unsigned char *) positions + vertex * stride);
+}
+
+static int compare_clusters(const void *a, const void *b) {
+	const struct cluster *first = a;
+	const struct cluster *second = b;
+
+	// Highest keys first, ties in their original order.
+	if (first->key != second->key) {
+		return first->key > second->key ? -1 : 1;
+	}
+
+	return first->index < second->index ? -1 : first->index > second->index;
+}
+
+// Sorts clusters by how far out they face [Sander et al. 2007]: the dot product of their average normal and the
+// direction from the center of the mesh to theirs. Clusters on the outside of the mesh tend to hide those further in.
+static bool sort_clusters(uint32_t *indices, size_t triangles_count, const float *positions, size_t stride, const uint32_t *clusters, size_t clusters_count) {
+	struct cluster *sorted = malloc(clusters_count * sizeof *sorted);
+	float (*centers)[3] = calloc(clusters_count, sizeof *centers);
+	float (*normals)[3] = calloc(clusters_count, sizeof *normals);
+	uint32_t *copy = malloc(triangles_count * 3 * sizeof *copy);
+	if (!sorted || !centers || !normals || !copy) {
+		free(sorted);
+		free(centers);
+		free(normals);
+		free(copy);
+		return false;
+	}
+
+	// Centers weighted by area, which also weights the normals since they're left unnormalized.
+	vec3 mesh_center = GLM_VEC3_ZERO_INIT;
+	float mesh_area = 0.0f;
+	for (size_t c = 0; c < clusters_count; c++) {
+		size_t start = clusters[c];
+		size_t end = c + 1 < clusters_count ? clusters[c + 1] : triangles_count;
+		float area = 0.0f;
+
+		for (size_t t = start; t < end; t++) {
+			const float *p0 = position(positions, stride, indices[t * 3 + 0]);
+			const float *p1 = position(positions, stride, indices[t * 3 + 1]);
+			const float *p2 = position(positions, stride, indices[t * 3 + 2]);
+
+			vec3 edge_1, edge_2, normal;
+			glm_vec3_sub((float *) p1, (float *) p0, edge_1);
+			glm_vec3_sub((float *) p2, (float *) p0, edge_2);
+			glm_vec3_cross(edge_1, edge_2, normal);
+
+			float triangle_area = glm_vec3_norm(normal);
+			for (size_t k = 0; k < 3; k++) {
+				centers[c][k] += (p0[k] + p1[k] + p2[k]) / 3.0f * triangle_area;
+				normals[c][k] += normal[k];
+			}
+			area += triangle_area;
+		}
+
+		glm_vec3_add(mesh_center, centers[c], mesh_center);
+		mesh_area += area;
+
+		if (area > 0.0f) {
+			glm_vec3_scale(centers[c], 1.0f / area, centers[c]);
+		}
+	}
+
+	if (mesh_area > 0.0f) {
+		glm_vec3_scale(mesh_center, 1.0f / mesh_area, mesh_center);
+	}
+
+	for (size_t c = 0; c < clusters_count; c++) {
+		vec3 direction;
+		glm_vec3_sub(centers[c], mesh_center, direction);
+		glm_vec3_normalize(normals[c]);
+
+		sorted[c].key = glm_vec3_dot(direction, normals[c]);
+		sorted[c].index = c;
+	}
+
+	qsort(sorted, clusters_count, sizeof *sorted, compare_clusters);
+
+	memcpy(copy, indices, triangles_count * 3 * sizeof *copy);
+	size_t written = 0;
+	for (size_t i = 0; i < clusters_count; i++) {
+		size_t c = sorted[i].index;
+		size_t start = clusters[c];
+		size_t end = c + 1 < clusters_count ? clusters[c + 1] : triangles_count;
+
+		memcpy(indices + written * 3, copy + start * 3, (end - start) * 3 * sizeof *copy);
+		written += end - start;
+	}
+
+	free(sorted);
+	free(centers);
+	free(normals);
+	free(copy);
+
+	return true;
+}
+
+// Numbers vertices in the order they're first used, such that fetches walk the vertex buffers forward.
+static void order_vertices(uint32_t *indices, size_t indices_count, size_t vertices_count, uint32_t *remap) {
+	for (size_t v = 0; v < vertices_count; v++) {
+		remap[v] = NONE;
+	}
+
+	uint32_t next = 0;
+	for (size_t i = 0; i < indices_count; i++) {
+		if (remap[indices[i]] == NONE) {
+			remap[indices[i]] = next++;
+		}
+
+		indices[i] = remap[indices[i]];
+	}
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		if (remap[v] == NONE) {
+			remap[v] = next++;
+		}
+	}
+}
+
+bool layman_optimizer_optimize(uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, uint32_t *remap) {
+	if (indices_count % 3 != 0 || vertices_count >= NONE) {
+		return false;
+	}
+
+	for (size_t i = 0; i < indices_count; i++) {
+		if (indices[i] >= vertices_count) {
+			return false;
+		}
+	}
+
+	// Nothing to order, and the adjacency of no vertices at all would be empty.
+	if (indices_count == 0) {
+		for (size_t v = 0; v < vertices_count; v++) {
+			remap[v] = v;
+		}
+
+		return true;
+	}
+
+	size_t triangles_count = indices_count / 3;
+	uint32_t *ordered = malloc(indices_count * sizeof *ordered);
+	uint32_t *clusters = malloc((triangles_count + 1) * sizeof *clusters);
+	uint32_t *cut = malloc((triangles_count + 1) * sizeof *cut);
+	if (!ordered || !clusters || !cut) {
+		free(ordered);
+		free(clusters);
+		free(cut);
+		return false;
+	}
+
+	size_t clusters_count = order_triangles(indices, indices_count, vertices_count, ordered, clusters);
+	if (clusters_count == 0) {
+		free(ordered);
+		free(clusters);
+		free(cut);
+		return false;
+	}
+
+	memcpy(indices, ordered, indices_count * sizeof *indices);
+
+	// Sorting clusters is best effort, the cache order alone is fine.
+	if (positions && triangles_count > 0) {
+		clusters_count = cut_clusters(indices, triangles_count, vertices_count, clusters, clusters_count, cut);
+		sort_clusters(indices, triangles_count, positions, stride ? stride : 3 * sizeof (float), cut, clusters_count);
+	}
+
+	order_vertices(indices, indices_count, vertices_count, remap);
+
+	free(ordered);
+	free(clusters);
+	free(cut);
+
+	return true;
+}
+
+void layman_optimizer_remap(const void *source, size_t size, size_t stride, size_t vertices_count, const uint32_t *remap, void *destination) {
+	stride = stride ? stride : size;
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		memcpy((unsigned char *) destination + remap[v] * size, (const unsigned char *) source + v * stride, size);
+	}
+}
@@ -0,0 +1,261 @@
+// posix_madvise() is left out of strict C11.
+#define _POSIX_C_SOURCE 200112L
+
+#include "layman.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const void *layman_pack_map(const char *filepath, size_t *size) {
+	#ifdef _WIN32
+	HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return NULL;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping) {
+		return NULL;
+	}
+
+	// The view keeps the mapping alive.
+	const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data) {
+		return NULL;
+	}
+
+	*size = file_size.QuadPart;
+	#else
+	int file = open(filepath, O_RDONLY);
+	if (file < 0) {
+		return NULL;
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		close(file);
+		return NULL;
+	}
+
+	// The mapping stays valid once the file is closed.
+	void *data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		return NULL;
+	}
+
+	// Everything gets read once, front to back.
+	posix_madvise(data, status.st_size, POSIX_MADV_SEQUENTIAL);
+
+	*size = status.st_size;
+	#endif
+
+	return data;
+}
+
+void layman_pack_unmap(const void *data, size_t size) {
+	if (!data) {
+		return;
+	}
+
+	#ifdef _WIN32
+	(void) size;
+	UnmapViewOfFile(data);
+	#else
+	munmap((void *) data, size);
+	#endif
+}
+
+struct layman_vertex_format layman_pack_vertex_format(const struct layman_pack_mesh *mesh) {
+	struct layman_vertex_format format = {
+		.attributes = mesh->attributes,
+		.split = mesh->split != 0,
+	};
+
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		format.encodings[a] = mesh->encodings[a];
+	}
+
+	return format;
+}
+
+// Whether a range of a pack is within it and properly aligned.
+static bool in_bounds(uint64_t offset, uint64_t length, size_t size) {
+	return offset % LAYMAN_PACK_ALIGNMENT == 0 && offset <= size && length <= size - offset;
+}
+
+static bool validate_texture(const struct layman_pack_texture *texture, size_t size) {
+	if (texture->kind >= LAYMAN_TEXTURE_KIND_COUNT || texture->format > LAYMAN_TEXTURE_FORMAT_RGBA || texture->format_internal >= LAYMAN_TEXTURE_FORMAT_INTERNAL_COUNT) {
+		return false;
+	}
+
+	if (texture->width == 0 || texture->height == 0 || texture->levels == 0 || texture->levels > 32 || ((texture->width | texture->height) >> (texture->levels - 1)) == 0) {
+		return false;
+	}
+
+	// The levels must fill the blob exactly, no less or the upload would read past it.
+	uint64_t expected = 0;
+	for (uint32_t level = 0; level < texture->levels; level++) {
+		size_t width = texture->width >> level ? texture->width >> level : 1;
+		size_t height = texture->height >> level ? texture->height >> level : 1;
+		expected += layman_texture_data_size(texture->format, texture->format_internal, width, height);
+	}
+
+	return texture->size == expected && in_bounds(texture->offset, texture->size, size);
+}
+
+static bool validate_material(const struct layman_pack_material *material, uint32_t textures_count) {
+	if (material->alpha_mode > LAYMAN_MATERIAL_ALPHA_MODE_BLEND) {
+		return false;
+	}
+
+	for (size_t i = 0; i < ARRAY_COUNT(material->textures); i++) {
+		if (material->textures[i] != LAYMAN_PACK_NONE && material->textures[i] >= textures_count) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Whether every index refers to one of the vertices.
+static bool validate_indices(const void *indices, size_t count, enum layman_mesh_index_format format, uint32_t vertices_count) {
+	uint32_t max = 0;
+
+	switch (format) {
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT8: {
+		    const uint8_t *narrow = indices;
+		    for (size_t i = 0; i < count; i++) {
+			    max = narrow[i] > max ? narrow[i] : max;
+		    }
+		    break;
+	    }
+
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT16: {
+		    const uint16_t *narrow = indices;
+		    for (size_t i = 0; i < count; i++) {
+			    max = narrow[i] > max ? narrow[i] : max;
+		    }
+		    break;
+	    }
+
+	    case LAYMAN_MESH_INDEX_FORMAT_UINT32: {
+		    const uint32_t *wide = indices;
+		    for (size_t i = 0; i < count; i++) {
+			    max = wide[i] > max ? wide[i] : max;
+		    }
+		    break;
+	    }
+	}
+
+	return count == 0 || max < vertices_count;
+}
+
+static bool validate_mesh(const void *data, const struct layman_pack_mesh *mesh, uint32_t materials_count, size_t size) {
+	struct layman_vertex_format format = layman_pack_vertex_format(mesh);
+	if (mesh->material >= materials_count || !layman_vertex_format_valid(&format) || mesh->indices_format > LAYMAN_MESH_INDEX_FORMAT_UINT32) {
+		return false;
+	}
+
+	for (size_t s = 0; s < LAYMAN_VERTEX_STREAMS; s++) {
+		uint64_t stream_size = (uint64_t) mesh->vertices_count * layman_vertex_size(&format, s);
+		if (!in_bounds(mesh->streams_offsets[s], stream_size, size)) {
+			return false;
+		}
+	}
+
+	if (mesh->lods_count == 0 || mesh->lods_count > ARRAY_COUNT(mesh->lods)) {
+		return false;
+	}
+
+	for (size_t l = 0; l < mesh->lods_count; l++) {
+		if ((uint64_t) mesh->lods[l].first_index + mesh->lods[l].indices_count > mesh->indices_count) {
+			return false;
+		}
+	}
+
+	uint64_t indices_size = (uint64_t) mesh->indices_count * layman_mesh_index_size(mesh->indices_format);
+	if (!in_bounds(mesh->indices_offset, indices_size, size)) {
+		return false;
+	}
+
+	// Drawing or bounding the meshlets with an index past the vertices would read out of bounds.
+	if (!validate_indices((const unsigned char *) data + mesh->indices_offset, mesh->indices_count, mesh->indices_format, mesh->vertices_count)) {
+		return false;
+	}
+
+	// The meshlets are drawn in place of the full detail, they must stay within it.
+	if (mesh->meshlets_count == 0) {
+		return true;
+	}
+
+	if (!in_bounds(mesh->meshlets_offset, (uint64_t) mesh->meshlets_count * sizeof (struct layman_pack_meshlet), size)) {
+		return false;
+	}
+
+	const struct layman_pack_meshlet *meshlets = (const void *) ((const unsigned char *) data + mesh->meshlets_offset);
+	for (uint32_t m = 0; m < mesh->meshlets_count; m++) {
+		if (meshlets[m].first_index < mesh->lods[0].first_index || (uint64_t) meshlets[m].first_index + meshlets[m].indices_count > (uint64_t) mesh->lods[0].first_index + mesh->lods[0].indices_count) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool layman_pack_validate(const void *data, size_t size) {
+	const struct layman_pack_header *header = data;
+	if (size < sizeof *header || header->magic != LAYMAN_PACK_MAGIC || header->version != LAYMAN_PACK_VERSION) {
+		return false;
+	}
+
+	// There's always the default material.
+	if (header->materials_count == 0) {
+		return false;
+	}
+
+	if (!in_bounds(header->textures_offset, (uint64_t) header->textures_count * sizeof (struct layman_pack_texture), size)
+		|| !in_bounds(header->materials_offset, (uint64_t) header->materials_count * sizeof (struct layman_pack_material), size)
+		|| !in_bounds(header->meshes_offset, (uint64_t) header->meshes_count * sizeof (struct layman_pack_mesh), size)) {
+		return false;
+	}
+
+	const unsigned char *bytes = data;
+	const struct layman_pack_texture *textures = (const void *) (bytes + header->textures_offset);
+	const struct layman_pack_material *materials = (const void *) (bytes + header->materials_offset);
+	const struct layman_pack_mesh *meshes = (const void *) (bytes + header->meshes_offset);
+
+	for (uint32_t i = 0; i < header->textures_count; i++) {
+		if (!validate_texture(textures + i, size)) {
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < header->materials_count; i++) {
+		if (!validate_material(materials + i, header->textures_count)) {
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < header->meshes_count; i++) {
+		if (!validate_mesh(data, meshes + i, header->materials_count, size)) {
+			return false;
+		}
+	}
+
+	return true;
+}
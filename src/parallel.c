@@ -0,0 +1,161 @@
+#include "layman.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// More would only fight over the same items.
+#define THREADS_MAX 64
+
+struct work {
+	layman_parallel_job job;
+	void *data;
+	size_t count;
+	atomic_size_t next;
+};
+
+// Workers started once, waiting for whatever layman_parallel_for() hands them.
+static struct {
+	pthread_t threads[THREADS_MAX];
+	size_t threads_count;
+
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+
+	struct work *work;
+	uint64_t generation; // Of the work, workers take part in each one exactly once.
+	size_t busy;         // Workers not done with the current work yet.
+	bool stopping;
+
+	// Held while work is handed out, one caller at a time.
+	pthread_mutex_t submit;
+} pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.wake = PTHREAD_COND_INITIALIZER,
+	.done = PTHREAD_COND_INITIALIZER,
+	.submit = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void run(struct work *work) {
+	for (;;) {
+		size_t index = atomic_fetch_add(&work->next, 1);
+		if (index >= work->count) {
+			break;
+		}
+
+		work->job(index, work->data);
+	}
+}
+
+static void *worker(void *argument) {
+	UNUSED(argument);
+
+	pthread_mutex_lock(&pool.lock);
+
+	uint64_t generation = 0;
+	for (;;) {
+		while (!pool.stopping && pool.generation == generation) {
+			pthread_cond_wait(&pool.wake, &pool.lock);
+		}
+
+		if (pool.stopping) {
+			break;
+		}
+
+		generation = pool.generation;
+		struct work *work = pool.work;
+		pthread_mutex_unlock(&pool.lock);
+
+		run(work);
+
+		pthread_mutex_lock(&pool.lock);
+		if (--pool.busy == 0) {
+			pthread_cond_signal(&pool.done);
+		}
+	}
+
+	pthread_mutex_unlock(&pool.lock);
+
+	return NULL;
+}
+
+size_t layman_parallel_threads(void) {
+	#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	long count = info.dwNumberOfProcessors;
+	#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	#endif
+
+	return count > 0 ? (size_t) count : 1;
+}
+
+void layman_parallel_start(void) {
+	if (pool.threads_count > 0) {
+		return;
+	}
+
+	// The calling thread is one of the workers.
+	size_t wanted = layman_parallel_threads() - 1;
+	if (wanted > THREADS_MAX) {
+		wanted = THREADS_MAX;
+	}
+
+	pool.stopping = false;
+	pool.generation = 0;
+	while (pool.threads_count < wanted && pthread_create(&pool.threads[pool.threads_count], NULL, worker, NULL) == 0) {
+		pool.threads_count++;
+	}
+}
+
+void layman_parallel_stop(void) {
+	pthread_mutex_lock(&pool.lock);
+	pool.stopping = true;
+	pthread_cond_broadcast(&pool.wake);
+	pthread_mutex_unlock(&pool.lock);
+
+	for (size_t i = 0; i < pool.threads_count; i++) {
+		pthread_join(pool.threads[i], NULL);
+	}
+
+	pool.threads_count = 0;
+}
+
+void layman_parallel_for(size_t count, layman_parallel_job job, void *data) {
+	struct work work = {
+		.job = job,
+		.data = data,
+		.count = count,
+	};
+
+	atomic_init(&work.next, 0);
+
+	// Jobs handing out work of their own, or other threads while the pool is taken, do it all by themselves.
+	if (count < 2 || pool.threads_count == 0 || pthread_mutex_trylock(&pool.submit) != 0) {
+		run(&work);
+		return;
+	}
+
+	pthread_mutex_lock(&pool.lock);
+	pool.work = &work;
+	pool.generation++;
+	pool.busy = pool.threads_count;
+	pthread_cond_broadcast(&pool.wake);
+	pthread_mutex_unlock(&pool.lock);
+
+	run(&work);
+
+	pthread_mutex_lock(&pool.lock);
+	while (pool.busy > 0) {
+		pthread_cond_wait(&pool.done, &pool.lock);
+	}
+	pthread_mutex_unlock(&pool.lock);
+
+	pthread_mutex_unlock(&pool.submit);
+}
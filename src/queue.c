@@ -0,0 +1,140 @@
+#include "layman.h"
+
+#define PACKETS_CAPACITY_STEP 256
+
+// Layout of the sort keys, from the most significant bits to the least.
+#define KEY_PASS_BITS 4
+#define KEY_PROGRAM_BITS 12
+#define KEY_MATERIAL_BITS 16
+#define KEY_VAO_BITS 16
+#define KEY_LOD_BITS 3
+#define KEY_DEPTH_BITS 13
+
+#define KEY_DEPTH_SHIFT 0
+#define KEY_LOD_SHIFT (KEY_DEPTH_SHIFT + KEY_DEPTH_BITS)
+#define KEY_VAO_SHIFT (KEY_LOD_SHIFT + KEY_LOD_BITS)
+#define KEY_MATERIAL_SHIFT (KEY_VAO_SHIFT + KEY_VAO_BITS)
+#define KEY_PROGRAM_SHIFT (KEY_MATERIAL_SHIFT + KEY_MATERIAL_BITS)
+#define KEY_PASS_SHIFT (KEY_PROGRAM_SHIFT + KEY_PROGRAM_BITS)
+
+#define KEY_FIELD(value, bits, shift) (((uint64_t) (value) & ((UINT64_C(1) << (bits)) - 1)) << (shift))
+
+_Static_assert(KEY_PASS_SHIFT + KEY_PASS_BITS == 64, "Sort keys must use exactly 64 bits");
+_Static_assert(LAYMAN_RENDER_PASS_COUNT <= (1 << KEY_PASS_BITS), "Too many passes for the sort keys");
+_Static_assert(LAYMAN_MESH_LODS <= (1 << KEY_LOD_BITS), "Too many LODs for the sort keys");
+
+struct layman_render_queue *layman_render_queue_create(void) {
+	struct layman_render_queue *queue = malloc(sizeof *queue);
+	if (!queue) {
+		return NULL;
+	}
+
+	queue->packets = NULL;
+	queue->scratch = NULL;
+	queue->count = 0;
+	queue->capacity = 0;
+
+	return queue;
+}
+
+void layman_render_queue_destroy(struct layman_render_queue *queue) {
+	if (!queue) {
+		return;
+	}
+
+	free(queue->packets);
+	free(queue->scratch);
+	free(queue);
+}
+
+uint64_t layman_render_queue_key(enum layman_render_pass pass, const struct layman_mesh *mesh, unsigned int lod, float depth) {
+	// Quantize the depth. Anything outside of the range just gets clamped, it's only used for ordering.
+	depth = depth < 0 ? 0 : depth > 1 ? 1 : depth;
+	uint64_t quantized_depth = depth * ((1 << KEY_DEPTH_BITS) - 1);
+
+	unsigned int material_id = mesh->material ? mesh->material->id : 0;
+
+	return KEY_FIELD(pass, KEY_PASS_BITS, KEY_PASS_SHIFT)
+	       | KEY_FIELD(mesh->shader->program_id, KEY_PROGRAM_BITS, KEY_PROGRAM_SHIFT)
+	       | KEY_FIELD(material_id, KEY_MATERIAL_BITS, KEY_MATERIAL_SHIFT)
+	       | KEY_FIELD(mesh->vao, KEY_VAO_BITS, KEY_VAO_SHIFT)
+	       | KEY_FIELD(lod, KEY_LOD_BITS, KEY_LOD_SHIFT)
+	       | KEY_FIELD(quantized_depth, KEY_DEPTH_BITS, KEY_DEPTH_SHIFT);
+}
+
+void layman_render_queue_clear(struct layman_render_queue *queue) {
+	// The memory is kept around, the next frame is very likely to need just as much.
+	queue->count = 0;
+}
+
+bool layman_render_queue_push(struct layman_render_queue *queue, uint64_t key, const struct layman_mesh *mesh, const struct layman_entity *entity, unsigned int lod) {
+	bool full = queue->count == queue->capacity;
+
+	if (full) {
+		size_t new_capacity = queue->capacity + PACKETS_CAPACITY_STEP;
+
+		struct layman_render_packet *new_packets = realloc(queue->packets, new_capacity * sizeof *new_packets);
+		if (!new_packets) {
+			return false;
+		}
+
+		queue->packets = new_packets;
+
+		struct layman_render_packet *new_scratch = realloc(queue->scratch, new_capacity * sizeof *new_scratch);
+		if (!new_scratch) {
+			return false;
+		}
+
+		queue->scratch = new_scratch;
+		queue->capacity = new_capacity;
+	}
+
+	struct layman_render_packet *packet = queue->packets + queue->count;
+	packet->key = key;
+	packet->mesh = mesh;
+	packet->entity = entity;
+	packet->lod = lod;
+	queue->count++;
+
+	return true;
+}
+
+void layman_render_queue_sort(struct layman_render_queue *queue) {
+	struct layman_render_packet *source = queue->packets;
+	struct layman_render_packet *destination = queue->scratch;
+
+	for (unsigned int shift = 0; shift < 64; shift += 8) {
+		size_t offsets[256] = {0};
+
+		for (size_t i = 0; i < queue->count; i++) {
+			offsets[(source[i].key >> shift) & 0xFF]++;
+		}
+
+		// Every key has the same byte here, this pass wouldn't move anything.
+		if (queue->count == 0 || offsets[(source[0].key >> shift) & 0xFF] == queue->count) {
+			continue;
+		}
+
+		// Histogram to prefix sums.
+		size_t total = 0;
+		for (size_t i = 0; i < ARRAY_COUNT(offsets); i++) {
+			size_t count = offsets[i];
+			offsets[i] = total;
+			total += count;
+		}
+
+		for (size_t i = 0; i < queue->count; i++) {
+			destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+
+		struct layman_render_packet *tmp = source;
+		source = destination;
+		destination = tmp;
+	}
+
+	// After an odd number of passes, the sorted packets ended up in the scratch buffer.
+	if (source != queue->packets) {
+		queue->scratch = queue->packets;
+		queue->packets = source;
+	}
+}
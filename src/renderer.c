@@ -8,6 +8,20 @@
 
 INCBIN(shaders_skybox_main_vert, "../shaders/skybox/main.vert");
 INCBIN(shaders_skybox_main_frag, "../shaders/skybox/main.frag");
+INCBIN(shaders_culling_main_comp, "../shaders/culling/main.comp");
+
+#define CULLING_GROUP_SIZE 64 // Must match the `local_size_x` of the culling shader.
+
+// Roughly two 2048x2048 RGBA textures per frame.
+#define STREAMING_BUDGET (32 * 1024 * 1024)
+
+// Largest error on screen of the LODs drawn, in pixels. A coarser LOD than the last one drawn must fit within a share of
+// it, the margin preventing meshes right at a threshold from flickering between two LODs.
+#define LOD_ERROR 1.0f
+#define LOD_HYSTERESIS 0.75f
+
+// Below that many meshlets, culling them costs more than drawing them all.
+#define MESHLETS_CULLING_MIN 8
 
 struct layman_renderer *layman_renderer_create(const struct layman_window *window) {
 	struct layman_renderer *renderer = malloc(sizeof *renderer);
@@ -30,6 +44,51 @@ struct layman_renderer *layman_renderer_create(const struct layman_window *windo
 
 	renderer->window = window;
 	renderer->wireframe = false;
+	renderer->streaming_budget = STREAMING_BUDGET;
+	renderer->lod_error = LOD_ERROR;
+
+	renderer->culling = layman_culling_create();
+	if (!renderer->culling) {
+		free(renderer);
+		return NULL;
+	}
+
+	renderer->queue = layman_render_queue_create();
+	if (!renderer->queue) {
+		layman_culling_destroy(renderer->culling);
+		free(renderer);
+		return NULL;
+	}
+
+	renderer->instances = NULL;
+	renderer->instances_capacity = 0;
+
+	renderer->meshlets_visible = NULL;
+	renderer->meshlet_counts = NULL;
+	renderer->meshlet_offsets = NULL;
+	renderer->meshlets_capacity = 0;
+
+	renderer->geometry = NULL;
+	renderer->indirect_buffer = 0;
+	renderer->commands = NULL;
+	renderer->command_meshes = NULL;
+	renderer->commands_count = 0;
+	renderer->commands_capacity = 0;
+
+	renderer->culling_shader = NULL;
+	renderer->visible_instances_vbo = 0;
+
+	layman_window_use(window);
+
+	// Uniform buffer holding the frame constants.
+	glGenBuffers(1, &renderer->frame_constants_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, renderer->frame_constants_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof renderer->frame_constants, NULL, GL_STREAM_DRAW);
+
+	// Vertex buffer holding the per-instance data, respecified every frame.
+	glGenBuffers(1, &renderer->instances_vbo);
+
+	layman_window_unuse(window);
 
 	renderer->ig_context = igCreateContext(NULL);
     renderer->ig_io  = igGetIO();
@@ -50,6 +109,28 @@ void layman_renderer_destroy(struct layman_renderer *renderer) {
     ImGui_ImplGlfw_Shutdown();
     igDestroyContext(renderer->ig_context);
 
+	layman_window_use(renderer->window);
+	glDeleteBuffers(1, &renderer->frame_constants_ubo);
+	glDeleteBuffers(1, &renderer->instances_vbo);
+	glDeleteBuffers(1, &renderer->indirect_buffer);
+	glDeleteBuffers(1, &renderer->visible_instances_vbo);
+	layman_geometry_destroy(renderer->geometry);
+
+	if (renderer->culling_shader) {
+		layman_shader_destroy(renderer->culling_shader);
+	}
+
+	layman_window_unuse(renderer->window);
+
+	layman_culling_destroy(renderer->culling);
+	layman_render_queue_destroy(renderer->queue);
+	free(renderer->instances);
+	free(renderer->meshlets_visible);
+	free(renderer->meshlet_counts);
+	free(renderer->meshlet_offsets);
+	free(renderer->commands);
+	free(renderer->command_meshes);
+
 	free(renderer);
 }
 
@@ -93,65 +174,389 @@ void layman_renderer_switch(const struct layman_renderer *new) {
 
 	// Necessary to avoid the seams of the cubemap being visible.
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+	// Every program reads its frame constants from this binding point.
+	glBindBufferBase(GL_UNIFORM_BUFFER, LAYMAN_FRAME_CONSTANTS_BINDING, new->frame_constants_ubo);
 }
 
-static void render_mesh(struct layman_renderer *renderer, const struct layman_camera *camera, const struct layman_scene *scene, const struct layman_mesh *mesh) {
-	static GLint viewProjectionMatrixLocation = -1;
-	static GLint modelMatrixLocation = -1;
-	static GLint normalMatrixLocation = -1;
-	static GLint exposureLocation = -1;
+// Computes everything that only changes once per frame and uploads it in a single go to the frame constants buffer.
+static void update_frame_constants(struct layman_renderer *renderer, const struct layman_camera *camera, const struct layman_scene *scene) {
+	struct layman_frame_constants *frame = &renderer->frame_constants;
+
+	// Camera.
+	glm_lookat((float *) camera->translation, (vec3) { 0, 0, 0}, (vec3) { 0, 1, 0}, frame->view_matrix);
+	glm_perspective(glm_rad(renderer->fov), renderer->viewport_width / renderer->viewport_height, renderer->near_plane, renderer->far_plane, frame->projection_matrix);
+	glm_mat4_mul(frame->projection_matrix, frame->view_matrix, frame->view_projection_matrix);
+	glm_vec3_copy((float *) camera->translation, frame->camera);
+
+	// Tone mapping.
+	frame->exposure = renderer->exposure;
+
+	// Environment IBL.
+	frame->mip_count = scene->environment ? scene->environment->mip_count : 0;
+
+	// Lights.
+	frame->light_count = 0;
+	for (size_t i = 0; i < scene->lights_count && i < MAX_LIGHTS; i++) {
+		const struct layman_light *light = scene->lights[i];
+
+		glm_vec3_copy((float *) light->direction, frame->lights[i].direction);
+		frame->lights[i].range = light->range;
+		glm_vec3_copy((float *) light->color, frame->lights[i].color);
+		frame->lights[i].intensity = light->intensity;
+		glm_vec3_copy((float *) light->position, frame->lights[i].position);
+		frame->lights[i].inner_cone_cos = light->innerConeCos;
+		frame->lights[i].outer_cone_cos = light->outerConeCos;
+		frame->lights[i].type = light->type;
+
+		frame->light_count++;
+	}
+
+	// Respecifying the whole buffer lets the driver orphan the previous one instead of waiting on the GPU.
+	glBindBuffer(GL_UNIFORM_BUFFER, renderer->frame_constants_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof *frame, frame, GL_STREAM_DRAW);
+}
+
+// Whether the instances of a draw command get their meshlets culled: only the full detail is split, finely enough for it
+// to pay off. Meshes simply get drawn whole when there's no memory to cull them.
+static bool culls_meshlets(struct layman_renderer *renderer, const struct layman_mesh *mesh, const struct layman_draw_command *command) {
+	const struct layman_meshlets *meshlets = mesh->meshlets;
+	if (!meshlets || meshlets->count < MESHLETS_CULLING_MIN || renderer->queue->packets[command->base_instance].lod != 0) {
+		return false;
+	}
+
+	if (meshlets->count > renderer->meshlets_capacity) {
+		uint8_t *new_visible = realloc(renderer->meshlets_visible, meshlets->count * sizeof *new_visible);
+		if (!new_visible) {
+			return false;
+		}
+
+		renderer->meshlets_visible = new_visible;
+
+		GLsizei *new_counts = realloc(renderer->meshlet_counts, meshlets->count * sizeof *new_counts);
+		if (!new_counts) {
+			return false;
+		}
+
+		renderer->meshlet_counts = new_counts;
+
+		const void **new_offsets = realloc(renderer->meshlet_offsets, meshlets->count * sizeof *new_offsets);
+		if (!new_offsets) {
+			return false;
+		}
+
+		renderer->meshlet_offsets = new_offsets;
+		renderer->meshlets_capacity = meshlets->count;
+	}
+
+	return true;
+}
+
+// Culls the meshlets of an instance, merging the visible ones following each other into ranges of indices.
+// Returns the number of ranges, or `SIZE_MAX` when every meshlet is visible.
+static size_t cull_meshlets(struct layman_renderer *renderer, const struct layman_mesh *mesh, size_t instance) {
+	const struct layman_meshlets *meshlets = mesh->meshlets;
+	uint8_t *visible = renderer->meshlets_visible;
+
+	// Both faces of double-sided materials are seen, whichever way the meshlets face.
+	bool cones = mesh->material && !mesh->material->double_sided;
+	size_t visible_count = layman_culling_meshlets(meshlets, renderer->instances[instance].model_matrix, renderer->frustum_planes, renderer->frame_constants.camera, cones, visible);
+	if (visible_count == meshlets->count) {
+		return SIZE_MAX;
+	}
+
+	size_t index_size = layman_mesh_index_size(mesh->indices_format);
+	size_t ranges_count = 0;
+	for (size_t m = 0; m < meshlets->count; m++) {
+		if (!visible[m]) {
+			continue;
+		}
+
+		if (m > 0 && visible[m - 1]) {
+			renderer->meshlet_counts[ranges_count - 1] += meshlets->indices_count[m];
+			continue;
+		}
+
+		renderer->meshlet_offsets[ranges_count] = (const void *) ((size_t) meshlets->first_index[m] * index_size);
+		renderer->meshlet_counts[ranges_count] = meshlets->indices_count[m];
+		ranges_count++;
+	}
+
+	return ranges_count;
+}
 
+// Renders the instances of a draw command, for a mesh that isn't packed. That's a single draw call, unless meshlets of
+// some instances get culled.
+static void render_mesh(struct layman_renderer *renderer, const struct layman_mesh *mesh, const struct layman_draw_command *command, bool material_changed) {
 	layman_mesh_switch(mesh);
 
 	// Uniforms.
-	layman_shader_bind_uniform_environment(mesh->shader, scene->environment);
-	layman_shader_bind_uniform_material(mesh->shader, mesh->material);
-	layman_shader_bind_uniform_camera(mesh->shader, camera);
-	layman_shader_bind_uniform_lights(mesh->shader, scene->lights, scene->lights_count);
+	// Everything that is the same for the whole frame lives in the frame constants buffer instead.
+	// The material uniforms stick to the program, they only need re-uploading when the draw before used something else.
+	if (material_changed) {
+		layman_shader_bind_uniform_material(mesh->shader, mesh->material);
+	}
+
+	GLenum type = layman_mesh_index_type(mesh->indices_format);
+	const void *offset = (const void *) ((size_t) command->first_index * layman_mesh_index_size(mesh->indices_format));
+
+	if (!culls_meshlets(renderer, mesh, command)) {
+		// Per-instance transforms.
+		layman_mesh_bind_instances(mesh, renderer->instances_vbo, command->base_instance);
+
+		// Render.
+		glDrawElementsInstanced(GL_TRIANGLES, command->count, type, offset, command->instance_count);
+		return;
+	}
+
+	// Runs of instances having all their meshlets visible are still drawn as instances, the others one by one with only
+	// their visible meshlets. Going one past the last instance ends the last run.
+	size_t run = 0;
+	for (size_t i = 0; i <= command->instance_count; i++) {
+		size_t instance = command->base_instance + i;
+		size_t ranges_count = i < command->instance_count ? cull_meshlets(renderer, mesh, instance) : 0;
+		if (ranges_count == SIZE_MAX) {
+			run++;
+			continue;
+		}
+
+		if (run > 0) {
+			layman_mesh_bind_instances(mesh, renderer->instances_vbo, instance - run);
+			glDrawElementsInstanced(GL_TRIANGLES, command->count, type, offset, run);
+			run = 0;
+		}
+
+		if (ranges_count > 0) {
+			layman_mesh_bind_instances(mesh, renderer->instances_vbo, instance);
+			glMultiDrawElements(GL_TRIANGLES, renderer->meshlet_counts, type, renderer->meshlet_offsets, ranges_count);
+		}
+	}
+}
+
+// Adds the bounds of every mesh of an entity, called for the entities whose bounds intersect the view frustum.
+static void gather_entity(const struct layman_entity *entity, void *data) {
+	struct layman_culling *culling = data;
+
+	if (!entity->model) {
+		return;
+	}
+
+	mat4 model_matrix;
+	layman_entity_model_matrix(entity, model_matrix);
+
+	for (size_t i = 0; i < entity->model->meshes_count; i++) {
+		if (!layman_culling_push(culling, entity->model->meshes[i], entity, entity->lods + i, model_matrix)) {
+			fprintf(stderr, "Unable to gather mesh bounds\n");
+		}
+	}
+}
+
+static bool is_packed(const struct layman_renderer *renderer, const struct layman_mesh *mesh) {
+	return renderer->geometry && mesh->geometry_id == renderer->geometry->id;
+}
+
+// Picks the coarsest LOD of a mesh whose error stays within the limit, given the size of the mesh on screen in pixels.
+// Going coarser than the LOD drawn last takes a margin.
+static unsigned int select_lod(const struct layman_renderer *renderer, const struct layman_mesh *mesh, float size, unsigned int previous) {
+	unsigned int lod = 0;
+	for (unsigned int l = 1; l < mesh->lods_count; l++) {
+		float limit = l > previous ? renderer->lod_error * LOD_HYSTERESIS : renderer->lod_error;
+		if (mesh->lods[l].error * size > limit) {
+			break;
+		}
+
+		lod = l;
+	}
+
+	return lod;
+}
+
+// Builds one draw command per run of packets for the same mesh and LOD.
+static bool build_commands(struct layman_renderer *renderer) {
+	const struct layman_render_queue *queue = renderer->queue;
+
+	if (queue->count > renderer->commands_capacity) {
+		struct layman_draw_command *new_commands = realloc(renderer->commands, queue->capacity * sizeof *new_commands);
+		if (!new_commands) {
+			return false;
+		}
+
+		renderer->commands = new_commands;
+
+		const struct layman_mesh **new_command_meshes = realloc(renderer->command_meshes, queue->capacity * sizeof *new_command_meshes);
+		if (!new_command_meshes) {
+			return false;
+		}
+
+		renderer->command_meshes = new_command_meshes;
+		renderer->commands_capacity = queue->capacity;
+	}
+
+	renderer->commands_count = 0;
+
+	size_t first = 0;
+	while (first < queue->count) {
+		const struct layman_mesh *mesh = queue->packets[first].mesh;
+		unsigned int lod = queue->packets[first].lod;
+
+		size_t last = first + 1;
+		while (last < queue->count && queue->packets[last].mesh == mesh && queue->packets[last].lod == lod) {
+			last++;
+		}
+
+		// Meshes get packed the first time they're drawn. Only their packing state changes, the mesh itself doesn't.
+		if (renderer->geometry && !is_packed(renderer, mesh)) {
+			layman_geometry_add(renderer->geometry, (struct layman_mesh *) mesh);
+		}
+
+		struct layman_draw_command *command = renderer->commands + renderer->commands_count;
+		command->count = mesh->lods[lod].indices_count;
+		command->instance_count = renderer->culling_shader && is_packed(renderer, mesh) ? 0 : last - first; // The GPU culling counts them back up.
+		command->first_index = (is_packed(renderer, mesh) ? mesh->geometry_first_index : 0) + mesh->lods[lod].first_index;
+		command->base_vertex = mesh->geometry_base_vertex;
+		command->base_instance = first;
+
+		renderer->command_meshes[renderer->commands_count] = mesh;
+		renderer->commands_count++;
+
+		first = last;
+	}
+
+	if (renderer->geometry) {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, renderer->indirect_buffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, renderer->commands_count * sizeof *renderer->commands, renderer->commands, GL_STREAM_DRAW);
+	}
+
+	return true;
+}
+
+// Fills the instance data for every packet of the queue and uploads it in one go.
+static bool upload_instances(struct layman_renderer *renderer) {
+	const struct layman_render_queue *queue = renderer->queue;
+
+	if (queue->count > renderer->instances_capacity) {
+		struct layman_instance *new_instances = realloc(renderer->instances, queue->capacity * sizeof *new_instances);
+		if (!new_instances) {
+			return false;
+		}
+
+		renderer->instances = new_instances;
+		renderer->instances_capacity = queue->capacity;
+	}
+
+	// Follows the runs of build_commands() to know the command of every instance.
+	size_t command = 0;
+
+	for (size_t i = 0; i < queue->count; i++) {
+		const struct layman_render_packet *packet = queue->packets + i;
+		struct layman_instance *instance = renderer->instances + i;
+
+		if (i > 0 && (packet->mesh != queue->packets[i - 1].mesh || packet->lod != queue->packets[i - 1].lod)) {
+			command++;
+		}
+
+		layman_entity_model_matrix(packet->entity, instance->model_matrix);
+		layman_entity_normal_matrix(packet->entity, instance->normal_matrix);
 
-	// FIXME: Horrible, please don't do this every frames!
-	if (viewProjectionMatrixLocation == -1) {
-		viewProjectionMatrixLocation = glGetUniformLocation(mesh->shader->program_id, "u_ViewProjectionMatrix");
-		modelMatrixLocation = glGetUniformLocation(mesh->shader->program_id, "u_ModelMatrix");
-		normalMatrixLocation = glGetUniformLocation(mesh->shader->program_id, "u_NormalMatrix");
-		exposureLocation = glGetUniformLocation(mesh->shader->program_id, "u_Exposure");
+		if (renderer->culling_shader) {
+			layman_culling_sphere(packet->mesh, instance->model_matrix, instance->sphere);
+			instance->command = is_packed(renderer, packet->mesh) ? command : LAYMAN_INSTANCE_NO_COMMAND;
+		}
 	}
 
-	// TODO: More uniforms, tidy this up.
-	// TODO: Should all move into the model file and stuff.
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->instances_vbo);
+	glBufferData(GL_ARRAY_BUFFER, queue->count * sizeof *renderer->instances, renderer->instances, GL_STREAM_DRAW);
 
-	mat4 view_matrix, projection_matrix, view_projection_matrix;
-	glm_lookat((float *) camera->translation, (vec3) { 0, 0, 0}, (vec3) { 0, 1, 0}, view_matrix);
-	glm_perspective_default(renderer->viewport_width / renderer->viewport_height, projection_matrix);
-	glm_perspective(glm_rad(renderer->fov), renderer->viewport_width / renderer->viewport_height, renderer->near_plane, renderer->far_plane, projection_matrix);
+	return true;
+}
 
-	// glm_rotate_z(view_matrix, camera->rotation[2], view_matrix);
-	// glm_rotate_y(view_matrix, camera->rotation[1], view_matrix);
-	// glm_rotate_x(view_matrix, camera->rotation[0], view_matrix);
+// Lets the GPU test every instance against the view frustum. The visible ones get compacted into the range of their draw
+// command, whose instance count gets incremented accordingly.
+static void cull_instances(struct layman_renderer *renderer) {
+	size_t count = renderer->queue->count;
+	if (count == 0) {
+		return;
+	}
 
-	glm_mat4_mul(projection_matrix, view_matrix, view_projection_matrix);
-	glUniformMatrix4fv(viewProjectionMatrixLocation, 1, false, view_projection_matrix[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->visible_instances_vbo);
+	glBufferData(GL_ARRAY_BUFFER, count * sizeof *renderer->instances, NULL, GL_STREAM_DRAW);
 
-	// Translation, rotation (z, y, x), scale.
-	mat4 model_matrix = GLM_MAT4_IDENTITY_INIT;
-	glm_rotate_y(model_matrix, M_PI_2, model_matrix);
-	glm_rotate_x(model_matrix, M_PI_2, model_matrix); // FIXME Should come from the glTF transforms?
-	// glm_scale(model_matrix, (vec3) { 100, 100, 100});
+	layman_shader_switch(renderer->culling_shader);
+	glUniform4fv(renderer->uniform_frustum_planes, 6, renderer->frustum_planes[0]);
+	glUniform1ui(renderer->uniform_instance_count, count);
 
-	glUniformMatrix4fv(modelMatrixLocation, 1, false, model_matrix[0]);
-	glUniformMatrix4fv(normalMatrixLocation, 1, false, model_matrix[0]);
-	glUniform1f(exposureLocation, renderer->exposure);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, renderer->instances_vbo);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, renderer->visible_instances_vbo);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, renderer->indirect_buffer);
 
-	// Render.
-	// FIXME: Support more than just unsigned shorts.
-	glDrawElements(GL_TRIANGLES, mesh->indices_count, GL_UNSIGNED_SHORT, NULL);
+	glDispatchCompute((count + CULLING_GROUP_SIZE - 1) / CULLING_GROUP_SIZE, 1, 1);
+
+	// The draws below read what was just written.
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
 }
 
-static void render_skybox(const struct layman_renderer *renderer, const struct layman_camera *camera, const struct layman_scene *scene) {
+// Renders consecutive draw commands of packed meshes sharing a shader and material in a single call.
+static void render_batch(const struct layman_renderer *renderer, size_t first, size_t count, bool material_changed) {
+	const struct layman_mesh *mesh = renderer->command_meshes[first];
+
+	layman_geometry_switch(renderer->geometry);
+	layman_shader_switch(mesh->shader);
+	layman_material_switch(mesh->material);
+
+	if (material_changed) {
+		layman_shader_bind_uniform_material(mesh->shader, mesh->material);
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, renderer->indirect_buffer);
+	// Only meshes with 16-bit indices get packed, see layman_geometry_add().
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void *) (first * sizeof *renderer->commands), count, 0);
+}
+
+// Renders the whole queue, in as few calls as the state changes allow.
+static void render_queue(struct layman_renderer *renderer) {
+	const struct layman_shader *previous_shader = NULL;
+	const struct layman_material *previous_material = NULL;
+
+	size_t first = 0;
+	while (first < renderer->commands_count) {
+		const struct layman_mesh *mesh = renderer->command_meshes[first];
+
+		// Programs still compiling in the background would stall the frame, what uses them simply shows up later.
+		if (layman_shader_poll(mesh->shader) != LAYMAN_SHADER_STATUS_READY) {
+			first++;
+			continue;
+		}
+
+		bool material_changed = mesh->shader != previous_shader || mesh->material != previous_material;
+		previous_shader = mesh->shader;
+		previous_material = mesh->material;
+
+		if (!is_packed(renderer, mesh)) {
+			render_mesh(renderer, mesh, renderer->commands + first, material_changed);
+			first++;
+			continue;
+		}
+
+		size_t last = first + 1;
+		while (last < renderer->commands_count) {
+			const struct layman_mesh *next = renderer->command_meshes[last];
+			if (!is_packed(renderer, next) || next->shader != mesh->shader || next->material != mesh->material) {
+				break;
+			}
+
+			last++;
+		}
+
+		render_batch(renderer, first, last - first, material_changed);
+
+		first = last;
+	}
+
+	layman_geometry_switch(NULL);
+}
+
+static void render_skybox(const struct layman_scene *scene) {
 	static struct layman_shader *skybox_shader = NULL;
-	static GLint environment_map_location = 0;
-	static GLint projection_location = 0;
-	static GLint view_location = 0;
 
 	// FIXME: All this shouldn't be here.
 	if (skybox_shader == NULL) {
@@ -160,25 +565,11 @@ static void render_skybox(const struct layman_renderer *renderer, const struct l
 			fprintf(stderr, "Unable to load skybox shader\n");
 			exit(EXIT_FAILURE); // TODO: Handle failure more gracefully.
 		}
-
-		layman_shader_switch(skybox_shader);
-
-		environment_map_location = glGetUniformLocation(skybox_shader->program_id, "environmentMap");
-		projection_location = glGetUniformLocation(skybox_shader->program_id, "projection");
-		view_location = glGetUniformLocation(skybox_shader->program_id, "view");
 	}
 
+	// The projection and view matrices come from the frame constants.
 	layman_shader_switch(skybox_shader);
 	layman_texture_switch(scene->environment->cubemap);
-	glUniform1i(environment_map_location, scene->environment->cubemap->kind);
-	mat4 projection_matrix = GLM_MAT4_IDENTITY_INIT;
-	// glm_perspective_default(renderer->viewport_width / renderer->viewport_height, projection);
-	glm_perspective(glm_rad(renderer->fov), renderer->viewport_width / renderer->viewport_height, renderer->near_plane, renderer->far_plane, projection_matrix);
-	glUniformMatrix4fv(projection_location, 1, false, projection_matrix[0]);
-	mat4 view = GLM_MAT4_IDENTITY_INIT;
-	glm_lookat((float *) camera->translation, (vec3) { 0, 0, -1}, (vec3) { 0, 1, 0}, view);
-	glm_rotate_y(view, camera->rotation[1], view);
-	glUniformMatrix4fv(view_location, 1, false, view[0]);
 
 	// glDisable(GL_CULL_FACE);
 	renderCube();
@@ -197,32 +588,89 @@ static void layman_render_ui(void) {
     ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
 }
 
-void layman_renderer_render(struct layman_renderer *renderer, const struct layman_camera *camera, const struct layman_scene *scene) {
+void layman_renderer_render(struct layman_renderer *renderer, const struct layman_camera *camera, struct layman_scene *scene) {
 	layman_window_use(renderer->window);
 
 	layman_renderer_switch(renderer);
 	layman_environment_switch(scene->environment);
 
+	// Computed once here, shared by every draw below.
+	update_frame_constants(renderer, camera, scene);
+	glm_frustum_planes(renderer->frame_constants.view_projection_matrix, renderer->frustum_planes);
+
+	// Stream in a little more of the textures still loading, without stalling on the ones in flight.
+	if (renderer->window->streaming) {
+		layman_streaming_update(renderer->window->streaming, renderer->streaming_budget);
+	}
+
+	// Only the entities that moved since the last frame get their matrices and bounds recomputed.
+	layman_scene_update(scene);
+
 	// Clear the screen.
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// Render all entities.
-	for (size_t i = 0; i < scene->entity_count; i++) {
-		const struct layman_entity *entity = scene->entities[i];
+	// Gather the world-space bounds of the meshes of the entities roughly in view.
+	layman_culling_clear(renderer->culling);
+	layman_scene_query_frustum(scene, (const float *) renderer->frame_constants.view_projection_matrix, gather_entity, renderer->culling);
+
+	// Reject the meshes outside of the view frustum.
+	bool gpu_culling = renderer->culling_shader != NULL;
+	layman_culling_frustum(renderer->culling, renderer->frame_constants.view_projection_matrix);
+
+	// Pixels per unit of size at a unit of distance from the camera.
+	float pixels_per_unit = renderer->viewport_height / (2.0f * tanf(glm_rad(renderer->fov) / 2.0f));
+
+	// Queue what's left, each with the LOD its size on screen calls for.
+	layman_render_queue_clear(renderer->queue);
+	for (size_t i = 0; i < renderer->culling->count; i++) {
+		const struct layman_mesh *mesh = renderer->culling->meshes[i];
+		const struct layman_entity *entity = renderer->culling->entities[i];
+
+		// The GPU only culls the meshes packed into the shared buffers, which every packable one is once drawn.
+		if (!renderer->culling->visible[i] && !(gpu_culling && mesh->packable)) {
+			continue;
+		}
+
+		// Meshes left bare by layman_mesh_create() have no program, nor anything to draw.
+		if (!mesh->shader) {
+			continue;
+		}
+
+		vec3 center = {renderer->culling->center_x[i], renderer->culling->center_y[i], renderer->culling->center_z[i]};
+		float distance = glm_vec3_distance((float *) camera->translation, center);
+		float depth = distance / renderer->far_plane;
 
-		// Render all meshes.
-		for (size_t i = 0; i < entity->model->meshes_count; i++) {
-			struct layman_mesh *mesh = entity->model->meshes[i];
+		// The full detail from within the bounds.
+		uint8_t *lod = renderer->culling->lods[i];
+		float radius = renderer->culling->radius[i];
+		*lod = distance > radius ? select_lod(renderer, mesh, radius / distance * pixels_per_unit, *lod) : 0;
 
-			// Render mesh.
-			render_mesh(renderer, camera, scene, mesh);
+		uint64_t key = layman_render_queue_key(LAYMAN_RENDER_PASS_OPAQUE, mesh, *lod, depth);
+
+		if (!layman_render_queue_push(renderer->queue, key, mesh, entity, *lod)) {
+			fprintf(stderr, "Unable to queue mesh for rendering\n");
 		}
 	}
 
+	// Sort them by state so that the switches only happen when the state really changes.
+	layman_render_queue_sort(renderer->queue);
+
+	// Render all meshes.
+	// Entities sharing a model end up with consecutive packets for the same meshes, those get drawn as instances.
+	if (build_commands(renderer) && upload_instances(renderer)) {
+		if (gpu_culling) {
+			cull_instances(renderer);
+		}
+
+		render_queue(renderer);
+	} else {
+		fprintf(stderr, "Unable to allocate the draw data\n");
+	}
+
 	// Render the skybox.
 	// This is done last so that only the fragments that aren't hiding it gets computed.
 	// The shader is written such that the depth buffer is always 1.0 (the furtest away).
-	render_skybox(renderer, camera, scene);
+	render_skybox(scene);
 
 	// Render the UI.
 	layman_render_ui();
@@ -233,7 +681,97 @@ void layman_renderer_render(struct layman_renderer *renderer, const struct layma
 	layman_window_unuse(renderer->window);
 }
 
+void layman_renderer_streaming_budget(struct layman_renderer *renderer, size_t budget) {
+	renderer->streaming_budget = budget;
+}
+
+void layman_renderer_lod_error(struct layman_renderer *renderer, float pixels) {
+	renderer->lod_error = pixels;
+}
+
 void layman_renderer_wireframe(struct layman_renderer *renderer, bool enabled) {
 	renderer->wireframe = enabled;
 	layman_renderer_switch(NULL);
 }
+
+// Expects the window to be in use.
+static void disable_gpu_culling(struct layman_renderer *renderer) {
+	if (!renderer->culling_shader) {
+		return;
+	}
+
+	layman_shader_switch(NULL);
+	layman_shader_destroy(renderer->culling_shader);
+	glDeleteBuffers(1, &renderer->visible_instances_vbo);
+
+	renderer->culling_shader = NULL;
+	renderer->visible_instances_vbo = 0;
+
+	layman_geometry_bind_instances(renderer->geometry, renderer->instances_vbo);
+	layman_geometry_switch(NULL);
+}
+
+bool layman_renderer_indirect(struct layman_renderer *renderer, bool enabled) {
+	if (enabled == (renderer->geometry != NULL)) {
+		return true;
+	}
+
+	layman_window_use(renderer->window);
+
+	bool success = true;
+
+	if (enabled) {
+		// Multi-draw indirect is core since 4.3, which Apple never got to.
+		if (GLAD_GL_VERSION_4_3) {
+			renderer->geometry = layman_geometry_create(renderer->instances_vbo);
+			glGenBuffers(1, &renderer->indirect_buffer);
+		}
+
+		success = renderer->geometry != NULL;
+	} else {
+		disable_gpu_culling(renderer);
+
+		// The meshes keep the identifier of the geometry, which is never reused, so they simply get packed again.
+		layman_geometry_destroy(renderer->geometry);
+		glDeleteBuffers(1, &renderer->indirect_buffer);
+		renderer->geometry = NULL;
+		renderer->indirect_buffer = 0;
+	}
+
+	layman_window_unuse(renderer->window);
+
+	return success;
+}
+
+bool layman_renderer_gpu_culling(struct layman_renderer *renderer, bool enabled) {
+	if (enabled == (renderer->culling_shader != NULL)) {
+		return true;
+	}
+
+	// The culling writes the draw commands of the indirect drawing.
+	if (enabled && !renderer->geometry) {
+		return false;
+	}
+
+	layman_window_use(renderer->window);
+
+	if (enabled) {
+		renderer->culling_shader = layman_shader_load_from_memory(NULL, 0, NULL, 0, shaders_culling_main_comp_data, shaders_culling_main_comp_size);
+
+		if (renderer->culling_shader) {
+			renderer->uniform_frustum_planes = glGetUniformLocation(renderer->culling_shader->program_id, "u_FrustumPlanes");
+			renderer->uniform_instance_count = glGetUniformLocation(renderer->culling_shader->program_id, "u_InstanceCount");
+
+			// The packed meshes now read the instances that survived the culling.
+			glGenBuffers(1, &renderer->visible_instances_vbo);
+			layman_geometry_bind_instances(renderer->geometry, renderer->visible_instances_vbo);
+			layman_geometry_switch(NULL);
+		}
+	} else {
+		disable_gpu_culling(renderer);
+	}
+
+	layman_window_unuse(renderer->window);
+
+	return enabled == (renderer->culling_shader != NULL);
+}
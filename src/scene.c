@@ -1,7 +1,16 @@
 #include "layman.h"
+#include <math.h>
 
 #define ENTITIES_CAPACITY_STEP 16
 
+// Past this fraction of entities moving in a single update, rebuilding the hierarchy is both cheaper and better than
+// refitting it.
+#define REBUILD_FRACTION 4
+
+// Refitted hierarchies get rebuilt once their cost grows past this ratio of what it was when built, as entities that
+// keep moving slowly stretch their nodes over each other.
+#define REBUILD_COST_RATIO 1.5f
+
 // Scenes can only grow in size. The idea being that if there was ever at some point X entities,
 // it's equally likely in the future to have just as many entities again.
 
@@ -15,14 +24,31 @@ struct layman_scene *layman_scene_create(void) {
 	scene->entity_count = 0;
 	scene->entity_capacity = 0;
 
+	scene->entity_min = NULL;
+	scene->entity_max = NULL;
+
+	scene->bvh = layman_bvh_create();
+	if (!scene->bvh) {
+		free(scene);
+		return NULL;
+	}
+
+	scene->bvh_outdated = false;
+	scene->transforms_generation = 0;
+
 	scene->lights = NULL;
 	scene->lights_count = 0;
 
+	scene->environment = NULL;
+
 	return scene;
 }
 
 void layman_scene_destroy(struct layman_scene *scene) {
 	free(scene->entities);
+	free(scene->entity_min);
+	free(scene->entity_max);
+	layman_bvh_destroy(scene->bvh);
 	free(scene->lights);
 	free(scene);
 }
@@ -39,12 +65,30 @@ bool layman_scene_add_entity(struct layman_scene *scene, const struct layman_ent
 		}
 
 		scene->entities = new_entities;
+
+		vec3 *new_entity_min = realloc(scene->entity_min, new_capacity * sizeof *new_entity_min);
+		if (!new_entity_min) {
+			return false;
+		}
+
+		scene->entity_min = new_entity_min;
+
+		vec3 *new_entity_max = realloc(scene->entity_max, new_capacity * sizeof *new_entity_max);
+		if (!new_entity_max) {
+			return false;
+		}
+
+		scene->entity_max = new_entity_max;
 		scene->entity_capacity = new_capacity;
 	}
 
 	scene->entities[scene->entity_count] = entity;
+	layman_entity_bounds(entity, scene->entity_min[scene->entity_count], scene->entity_max[scene->entity_count]);
 	scene->entity_count++;
 
+	// Rebuilding right away would make adding many entities quadratic, it's deferred to the next update instead.
+	scene->bvh_outdated = true;
+
 	return true;
 }
 
@@ -64,3 +108,177 @@ bool layman_scene_add_light(struct layman_scene *scene, const struct layman_ligh
 void layman_scene_assign_environment(struct layman_scene *scene, const struct layman_environment *environment) {
 	scene->environment = environment;
 }
+
+void layman_scene_update(struct layman_scene *scene) {
+	// The bounds depend on the latest world matrices, they're only gathered again when some changed.
+	uint64_t generation = layman_transforms_update();
+	if (!scene->bvh_outdated && generation == scene->transforms_generation) {
+		return;
+	}
+
+	scene->transforms_generation = generation;
+
+	bool rebuild = scene->bvh_outdated;
+	size_t moved = 0;
+
+	for (size_t i = 0; i < scene->entity_count; i++) {
+		vec3 min, max;
+		layman_entity_bounds(scene->entities[i], min, max);
+
+		if (memcmp(min, scene->entity_min[i], sizeof min) == 0 && memcmp(max, scene->entity_max[i], sizeof max) == 0) {
+			continue;
+		}
+
+		glm_vec3_copy(min, scene->entity_min[i]);
+		glm_vec3_copy(max, scene->entity_max[i]);
+		moved++;
+
+		if (!rebuild && moved > scene->entity_count / REBUILD_FRACTION) {
+			rebuild = true;
+		}
+
+		if (!rebuild) {
+			layman_bvh_refit(scene->bvh, (const vec3 *) scene->entity_min, (const vec3 *) scene->entity_max, i);
+		}
+	}
+
+	if (!rebuild && moved > 0) {
+		rebuild = layman_bvh_cost(scene->bvh) > scene->bvh->built_cost * REBUILD_COST_RATIO;
+	}
+
+	if (rebuild) {
+		// On failure, the queries keep working through a linear scan until the next update.
+		scene->bvh_outdated = !layman_bvh_build(scene->bvh, (const vec3 *) scene->entity_min, (const vec3 *) scene->entity_max, scene->entity_count);
+		if (scene->bvh_outdated) {
+			fprintf(stderr, "Unable to build the scene hierarchy\n");
+		}
+	}
+}
+
+// Everything a query needs to turn the primitives of the hierarchy back into entities.
+struct query {
+	const struct layman_scene *scene;
+	layman_scene_query_callback callback;
+	void *data;
+};
+
+static void query_visit(uint32_t primitive, void *data) {
+	const struct query *query = data;
+	query->callback(query->scene->entities[primitive], query->data);
+}
+
+static size_t query_run(const struct layman_scene *scene, layman_bvh_overlap overlap, const void *shape, layman_scene_query_callback callback, void *data) {
+	struct query query = {
+		.scene = scene,
+		.callback = callback,
+		.data = data,
+	};
+
+	const vec3 *mins = (const vec3 *) scene->entity_min;
+	const vec3 *maxs = (const vec3 *) scene->entity_max;
+
+	if (!scene->bvh_outdated) {
+		return layman_bvh_query(scene->bvh, mins, maxs, overlap, shape, query_visit, &query);
+	}
+
+	// The hierarchy doesn't know about some of the entities yet, fall back to testing all of them.
+	size_t visited = 0;
+	for (size_t i = 0; i < scene->entity_count; i++) {
+		if (overlap(mins[i], maxs[i], shape)) {
+			query_visit(i, &query);
+			visited++;
+		}
+	}
+
+	return visited;
+}
+
+static bool overlap_frustum(const float *min, const float *max, const void *shape) {
+	const vec4 *planes = shape;
+
+	for (size_t i = 0; i < 6; i++) {
+		// Only the corner furthest along the normal needs testing; if it's behind the plane, the whole box is.
+		float distance = planes[i][3];
+		for (size_t axis = 0; axis < 3; axis++) {
+			distance += planes[i][axis] * (planes[i][axis] >= 0 ? max[axis] : min[axis]);
+		}
+
+		if (distance < 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t layman_scene_query_frustum(const struct layman_scene *scene, const float view_projection_matrix[16], layman_scene_query_callback callback, void *data) {
+	mat4 matrix;
+	memcpy(matrix, view_projection_matrix, sizeof matrix);
+
+	vec4 planes[6];
+	glm_frustum_planes(matrix, planes);
+
+	return query_run(scene, overlap_frustum, planes, callback, data);
+}
+
+struct sphere {
+	vec3 center;
+	float radius;
+};
+
+static bool overlap_sphere(const float *min, const float *max, const void *shape) {
+	const struct sphere *sphere = shape;
+
+	// Squared distance from the center to the closest point of the box.
+	float distance = 0;
+	for (size_t axis = 0; axis < 3; axis++) {
+		float closest = glm_clamp(sphere->center[axis], min[axis], max[axis]);
+		float delta = sphere->center[axis] - closest;
+		distance += delta * delta;
+	}
+
+	return distance <= sphere->radius * sphere->radius;
+}
+
+size_t layman_scene_query_sphere(const struct layman_scene *scene, const float center[3], float radius, layman_scene_query_callback callback, void *data) {
+	struct sphere sphere = {
+		.center = {center[0], center[1], center[2]},
+		.radius = radius,
+	};
+
+	return query_run(scene, overlap_sphere, &sphere, callback, data);
+}
+
+struct ray {
+	vec3 origin;
+	vec3 inverse_direction;
+	float max_distance;
+};
+
+static bool overlap_ray(const float *min, const float *max, const void *shape) {
+	const struct ray *ray = shape;
+
+	// Slab test. fminf() and fmaxf() discard the NaNs produced by rays parallel to a slab and starting on its border.
+	float near = 0;
+	float far = ray->max_distance;
+
+	for (size_t axis = 0; axis < 3; axis++) {
+		float t1 = (min[axis] - ray->origin[axis]) * ray->inverse_direction[axis];
+		float t2 = (max[axis] - ray->origin[axis]) * ray->inverse_direction[axis];
+
+		near = fmaxf(near, fminf(t1, t2));
+		far = fminf(far, fmaxf(t1, t2));
+	}
+
+	return near <= far;
+}
+
+size_t layman_scene_query_ray(const struct layman_scene *scene, const float origin[3], const float direction[3], float max_distance, layman_scene_query_callback callback, void *data) {
+	struct ray ray = {
+		.origin = {origin[0], origin[1], origin[2]},
+		.inverse_direction = {1 / direction[0], 1 / direction[1], 1 / direction[2]},
+		.max_distance = max_distance,
+	};
+
+	return query_run(scene, overlap_ray, &ray, callback, data);
+}
@@ -1,9 +1,101 @@
 #include "layman.h"
+#include "incbin.h"
+#include <inttypes.h>
 
 #define TO_STR(x) #x
 #define EVAL_TO_STR(x) TO_STR(x)
 #define MAX(x, y) ((x) > (y) ? (x) : (y))
 
+INCBIN(shaders_common_frame_glsl, "../shaders/common/frame.glsl");
+
+// Prepended to every stage, right after the version.
+// Only what holds for every program lives here, meshes and materials add their own defines (see layman_mesh_create_from_raw()).
+static const char *prefix =
+        // Lighting.
+        "#define USE_HDR\n"
+        "#define USE_IBL\n"
+        // "#define USE_PUNCTUAL\n"
+        "#define LIGHT_COUNT " EVAL_TO_STR(MAX_LIGHTS) "\n"
+
+        // Tonemapping.
+        "#define TONEMAP_UNCHARTED\n"
+        // "#define TONEMAP_HEJLRICHARD\n"
+        // "#define TONEMAP_ACES\n"
+
+        // Debugging.
+        // "#define DEBUG_OUTPUT\n"
+        // "#define DEBUG_BASECOLOR\n"
+        // "#define DEBUG_NORMAL\n"
+        // "#define DEBUG_METALLIC\n"
+        // "#define DEBUG_ROUGHNESS\n"
+        // "#define DEBUG_OCCLUSION\n"
+        // "#define DEBUG_FDIFFUSE\n"
+        // "#define DEBUG_FSPECULAR\n"
+        // "#define DEBUG_FEMISSIVE\n"
+
+        "#define DUMMY 1\n\n";
+
+#define STAGES_COUNT 3 // Vertex, fragment and compute.
+
+// KHR_parallel_shader_compile and ARB_parallel_shader_compile share their enum, loaded by hand as glad lacks both.
+#define COMPLETION_STATUS 0x91B1
+typedef void (APIENTRY *max_shader_compiler_threads_proc)(GLuint count);
+
+// Whether programs can be polled for completion, see layman_shader_setup_parallel_compile().
+static bool parallel_compile;
+
+// Identifies the files of the program binary cache.
+#define BINARY_MAGIC 0x4C4D5042 // "LMPB"
+
+struct binary_header {
+	uint32_t magic;
+	GLenum format;
+	uint64_t hash;
+	uint64_t length;
+};
+
+// Where the program binaries get cached, or `NULL` when they aren't.
+static char *cache_directory;
+
+// 64-bit FNV-1a.
+#define HASH_OFFSET 14695981039346656037ULL
+#define HASH_PRIME 1099511628211ULL
+
+// Programs shared by everything requesting the same sources and defines, see layman_shader_acquire().
+static struct layman_shader **cache;
+static size_t cache_count;
+
+static uint64_t hash_bytes(uint64_t hash, const void *bytes, size_t length) {
+	const unsigned char *cursor = bytes;
+
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ cursor[i]) * HASH_PRIME;
+	}
+
+	return hash;
+}
+
+// The lengths are hashed along with the content so that moving bytes from one stage to the next changes the hash.
+static uint64_t hash_stage(uint64_t hash, const void *content, size_t length) {
+	hash = hash_bytes(hash, &length, sizeof length);
+	return content ? hash_bytes(hash, content, length) : hash;
+}
+
+// Mixes everything besides the sources that changes the compiled program: the driver and what the engine prepends.
+static uint64_t hash_environment(uint64_t hash) {
+	const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+	for (size_t i = 0; i < ARRAY_COUNT(strings); i++) {
+		const char *string = (const char *) glGetString(strings[i]);
+		hash = hash_stage(hash, string, string ? strlen(string) : 0);
+	}
+
+	hash = hash_stage(hash, prefix, strlen(prefix));
+	hash = hash_stage(hash, shaders_common_frame_glsl_data, shaders_common_frame_glsl_size);
+
+	return hash;
+}
+
 // FIXME: This function is a disaster.
 static char *read_shader_file(const char *filepath) {
 	FILE *file = fopen(filepath, "rb");
@@ -94,7 +186,10 @@ static char *read_shader_file(const char *filepath) {
 }
 
 /**
- * Compiles a shader.
+ * Starts compiling a shader.
+ *
+ * The compilation may happen in the background, its status must be checked with check_shader() once the program is
+ * complete.
  *
  * @param[in] type The type of shader.
  *      - GL_COMPUTE_SHADER
@@ -104,69 +199,35 @@ static char *read_shader_file(const char *filepath) {
  *      - GL_GEOMETRY_SHADER
  *      - GL_FRAGMENT_SHADER
  * @param[in] content The content of the shader file.
+ * @param[in] defines Extra preprocessor definitions, one `#define` per line, or `NULL`.
  *
- * @return The compiled shader id or `0` on error.
+ * @return The shader id or `0` on error.
  */
-static GLuint compile_shader(GLenum type, const unsigned char *content, size_t length) {
+static GLuint compile_shader(GLenum type, const unsigned char *content, size_t length, const char *defines) {
 	GLuint shader_id = glCreateShader(type);
 	if (shader_id == 0) {
 		return 0;
 	}
 
-	const char *prefix =
-	        "#version 410 core\n\n"
-
-	        // TODO: All of the has should be set accordinly to what the mesh actually has, not hardcoded.
-
-	        // Attributes.
-	        "#define HAS_NORMALS\n"
-	        "#define HAS_UV_SET1\n"
-	        // "#define HAS_TANGENTS\n"
-
-	        // Textures.
-	        "#define HAS_BASE_COLOR_MAP\n"
-	        "#define HAS_NORMAL_MAP\n"
-	        "#define HAS_OCCLUSION_MAP\n"
-	        "#define HAS_EMISSIVE_MAP\n"
-	        "#define HAS_METALLIC_ROUGHNESS_MAP\n"
-
-	        // Material workflow.
-	        "#define MATERIAL_METALLICROUGHNESS\n"
-	        // "#define MATERIAL_SPECULARGLOSSINESS\n"
-
-	        // Lighting.
-	        // "#define MATERIAL_UNLIT\n"
-	        "#define USE_HDR\n"
-	        "#define USE_IBL\n"
-	        // "#define USE_PUNCTUAL\n"
-	        "#define LIGHT_COUNT " EVAL_TO_STR(MAX_LIGHTS) "\n"
-
-	        // Tonemapping.
-	        "#define TONEMAP_UNCHARTED\n"
-	        // "#define TONEMAP_HEJLRICHARD\n"
-	        // "#define TONEMAP_ACES\n"
-
-	        // Debugging.
-	        // "#define DEBUG_OUTPUT\n"
-	        // "#define DEBUG_BASECOLOR\n"
-	        // "#define DEBUG_NORMAL\n"
-	        // "#define DEBUG_METALLIC\n"
-	        // "#define DEBUG_ROUGHNESS\n"
-	        // "#define DEBUG_OCCLUSION\n"
-	        // "#define DEBUG_FDIFFUSE\n"
-	        // "#define DEBUG_FSPECULAR\n"
-	        // "#define DEBUG_FEMISSIVE\n"
-
-	        "#define DUMMY 1\n\n";
-
-	size_t new_length = snprintf(NULL, 0, "%s\n%.*s", prefix, (int) length, content);
+	// Compute shaders only exist since 4.3, which is never requested on Mac.
+	const char *version = type == GL_COMPUTE_SHADER ? "#version 430 core\n\n" : "#version 410 core\n\n";
+
+	// The frame constants block is shared by every program, so it gets prepended right after the defines.
+	const char *frame = (const char *) shaders_common_frame_glsl_data;
+	int frame_length = shaders_common_frame_glsl_size;
+
+	if (!defines) {
+		defines = "";
+	}
+
+	size_t new_length = snprintf(NULL, 0, "%s%s%s\n%.*s\n%.*s", version, prefix, defines, frame_length, frame, (int) length, content);
 	char *new_content = malloc(new_length + 1);
 	if (!new_content) {
 		glDeleteShader(shader_id);
 		return 0;
 	}
 
-	sprintf(new_content, "%s\n%.*s", prefix, (int) length, content);
+	sprintf(new_content, "%s%s%s\n%.*s\n%.*s", version, prefix, defines, frame_length, frame, (int) length, content);
 	new_content[new_length] = '\0';
 
 	const char *const source = new_content;
@@ -176,6 +237,11 @@ static GLuint compile_shader(GLenum type, const unsigned char *content, size_t l
 
 	glCompileShader(shader_id);
 
+	return shader_id;
+}
+
+// Blocks until the shader is compiled, unless it already is.
+static bool check_shader(GLuint shader_id) {
 	GLint success;
 	glGetShaderiv(shader_id, GL_COMPILE_STATUS, &success);
 	if (success != GL_TRUE) {
@@ -186,49 +252,58 @@ static GLuint compile_shader(GLenum type, const unsigned char *content, size_t l
 
 		fprintf(stderr, "Shader compilation error!\n%s\n", info_log);
 
-		return 0;
+		return false;
 	}
 
-	return shader_id;
+	return true;
 }
 
 static void find_uniforms(struct layman_shader *shader) {
 	shader->uniform_base_color_factor = glGetUniformLocation(shader->program_id, "u_BaseColorFactor");
-	shader->uniform_base_color_sampler = glGetUniformLocation(shader->program_id, "u_BaseColorSampler");
-	shader->uniform_normal_sampler = glGetUniformLocation(shader->program_id, "u_NormalSampler");
 	shader->uniform_normal_scale = glGetUniformLocation(shader->program_id, "u_NormalScale");
-	shader->uniform_metallic_roughness_sampler = glGetUniformLocation(shader->program_id, "u_MetallicRoughnessSampler");
 	shader->uniform_metallic_factor = glGetUniformLocation(shader->program_id, "u_MetallicFactor");
 	shader->uniform_roughness_factor = glGetUniformLocation(shader->program_id, "u_RoughnessFactor");
-	shader->uniform_occlusion_sampler = glGetUniformLocation(shader->program_id, "u_OcclusionSampler");
 	shader->uniform_occlusion_strength = glGetUniformLocation(shader->program_id, "u_OcclusionStrength");
-	shader->uniform_emissive_sampler = glGetUniformLocation(shader->program_id, "u_EmissiveSampler");
 	shader->uniform_emissive_factor = glGetUniformLocation(shader->program_id, "u_EmissiveFactor");
-	shader->uniform_camera = glGetUniformLocation(shader->program_id, "u_Camera");
-
-	shader->uniform_environment_mip_count = glGetUniformLocation(shader->program_id, "u_MipCount");
-	shader->uniform_environment_lambertian = glGetUniformLocation(shader->program_id, "u_LambertianEnvSampler");
-	shader->uniform_environment_ggx = glGetUniformLocation(shader->program_id, "u_GGXEnvSampler");
-	shader->uniform_environment_ggx_lut = glGetUniformLocation(shader->program_id, "u_GGXLUT");
-	shader->uniform_environment_charlie = glGetUniformLocation(shader->program_id, "u_CharlieEnvSampler");
-	shader->uniform_environment_charlie_lut = glGetUniformLocation(shader->program_id, "u_CharlieLUT");
-
-	char name[64];
-	for (size_t i = 0; i < MAX_LIGHTS; i++) {
-		sprintf(name, "u_Lights[%zu].type", i);
-		shader->uniform_lights_type[i] = glGetUniformLocation(shader->program_id, name);
-
-		sprintf(name, "u_Lights[%zu].position", i);
-		shader->uniform_lights_position[i] = glGetUniformLocation(shader->program_id, name);
-
-		sprintf(name, "u_Lights[%zu].direction", i);
-		shader->uniform_lights_direction[i] = glGetUniformLocation(shader->program_id, name);
+	shader->uniform_alpha_cutoff = glGetUniformLocation(shader->program_id, "u_AlphaCutoff");
+}
 
-		sprintf(name, "u_Lights[%zu].color", i);
-		shader->uniform_lights_color[i] = glGetUniformLocation(shader->program_id, name);
+// Every texture kind has its own dedicated texture unit, so the samplers never change after linkage.
+// Setting them once here means nobody has to re-send them before every draw.
+static void setup_bindings(const struct layman_shader *shader) {
+	const struct {
+		const char *name;
+		enum layman_texture_kind kind;
+	} samplers[] = {
+		// Material.
+		{"u_BaseColorSampler", LAYMAN_TEXTURE_KIND_ALBEDO},
+		{"u_NormalSampler", LAYMAN_TEXTURE_KIND_NORMAL},
+		{"u_MetallicRoughnessSampler", LAYMAN_TEXTURE_KIND_METALLIC_ROUGHNESS},
+		{"u_OcclusionSampler", LAYMAN_TEXTURE_KIND_OCCLUSION},
+		{"u_EmissiveSampler", LAYMAN_TEXTURE_KIND_EMISSION},
+
+		// Environment IBL.
+		{"u_LambertianEnvSampler", LAYMAN_TEXTURE_KIND_ENVIRONMENT_LAMBERTIAN},
+		{"u_GGXEnvSampler", LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX},
+		{"u_GGXLUT", LAYMAN_TEXTURE_KIND_ENVIRONMENT_GGX_LUT},
+		{"u_CharlieEnvSampler", LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE},
+		{"u_CharlieLUT", LAYMAN_TEXTURE_KIND_ENVIRONMENT_CHARLIE_LUT},
+
+		// Skybox.
+		{"environmentMap", LAYMAN_TEXTURE_KIND_CUBEMAP},
+	};
+
+	for (size_t i = 0; i < ARRAY_COUNT(samplers); i++) {
+		GLint location = glGetUniformLocation(shader->program_id, samplers[i].name);
+		if (location != -1) {
+			glUniform1i(location, samplers[i].kind);
+		}
+	}
 
-		sprintf(name, "u_Lights[%zu].intensity", i);
-		shader->uniform_lights_intensity[i] = glGetUniformLocation(shader->program_id, name);
+	// The frame constants are shared by all the programs through a fixed binding point.
+	GLuint frame_constants_index = glGetUniformBlockIndex(shader->program_id, "FrameConstants");
+	if (frame_constants_index != GL_INVALID_INDEX) {
+		glUniformBlockBinding(shader->program_id, frame_constants_index, LAYMAN_FRAME_CONSTANTS_BINDING);
 	}
 }
 
@@ -269,58 +344,45 @@ struct layman_shader *layman_shader_load_from_files(const char *vertex_filepath,
 	return shader;
 }
 
-struct layman_shader *layman_shader_load_from_memory(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length) {
-	GLuint vertex_shader_id = 0;
-	GLuint fragment_shader_id = 0;
-	GLuint compute_shader_id = 0;
-	bool something_went_wrong = false;
+// Starts compiling and linking a program from its sources, without waiting for either.
+// The shaders are returned in `stages` (zero for the missing ones) and must be given to finish_program() later on.
+static GLuint start_program(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length, const char *defines, GLuint stages[STAGES_COUNT]) {
+	const struct {
+		GLenum type;
+		const unsigned char *content;
+		size_t length;
+	} sources[STAGES_COUNT] = {
+		{GL_VERTEX_SHADER, vertex_content, vertex_length},
+		{GL_FRAGMENT_SHADER, fragment_content, fragment_length},
+		{GL_COMPUTE_SHADER, compute_content, compute_length},
+	};
 
-	if (vertex_content) {
-		vertex_shader_id = compile_shader(GL_VERTEX_SHADER, vertex_content, vertex_length);
-		if (!vertex_shader_id) {
-			something_went_wrong = true;
-		}
-	}
+	bool something_went_wrong = false;
 
-	if (fragment_content) {
-		fragment_shader_id = compile_shader(GL_FRAGMENT_SHADER, fragment_content, fragment_length);
-		if (!fragment_shader_id) {
-			something_went_wrong = true;
-		}
-	}
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		stages[i] = 0;
 
-	if (compute_content) {
-		compute_shader_id = compile_shader(GL_COMPUTE_SHADER, compute_content, compute_length);
-		if (!compute_shader_id) {
-			something_went_wrong = true;
+		if (sources[i].content) {
+			stages[i] = compile_shader(sources[i].type, sources[i].content, sources[i].length, defines);
+			if (!stages[i]) {
+				something_went_wrong = true;
+			}
 		}
 	}
 
-	if (something_went_wrong) {
-		if (vertex_shader_id) glDeleteShader(vertex_shader_id);
-		if (fragment_shader_id) glDeleteShader(fragment_shader_id);
-		if (compute_shader_id) glDeleteShader(compute_shader_id);
-		return NULL;
-	}
-
-	GLuint program_id = glCreateProgram();
+	GLuint program_id = something_went_wrong ? 0 : glCreateProgram();
 	if (!program_id) {
-		glDeleteShader(vertex_shader_id);
-		glDeleteShader(fragment_shader_id);
-		glDeleteShader(compute_shader_id);
-		return NULL;
-	}
-
-	if (vertex_shader_id) {
-		glAttachShader(program_id, vertex_shader_id);
-	}
+		for (size_t i = 0; i < STAGES_COUNT; i++) {
+			glDeleteShader(stages[i]);
+		}
 
-	if (fragment_shader_id) {
-		glAttachShader(program_id, fragment_shader_id);
+		return 0;
 	}
 
-	if (compute_shader_id) {
-		glAttachShader(program_id, compute_shader_id);
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		if (stages[i]) {
+			glAttachShader(program_id, stages[i]);
+		}
 	}
 
 	// Bind attributes. Must be before linkage.
@@ -328,12 +390,32 @@ struct layman_shader *layman_shader_load_from_memory(const unsigned char *vertex
 	glBindAttribLocation(program_id, LAYMAN_MESH_ATTRIBUTE_UV, "a_UV1");
 	glBindAttribLocation(program_id, LAYMAN_MESH_ATTRIBUTE_NORMAL, "a_Normal");
 	glBindAttribLocation(program_id, LAYMAN_MESH_ATTRIBUTE_TANGENT, "a_Tangent");
+	glBindAttribLocation(program_id, LAYMAN_MESH_ATTRIBUTE_MODEL_MATRIX, "a_ModelMatrix");
+	glBindAttribLocation(program_id, LAYMAN_MESH_ATTRIBUTE_NORMAL_MATRIX, "a_NormalMatrix");
+
+	// Lets the driver know the binary will be retrieved for the program binary cache.
+	if (cache_directory) {
+		glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 
 	glLinkProgram(program_id);
 
-	GLint success;
-	glGetProgramiv(program_id, GL_LINK_STATUS, &success);
-	if (success != GL_TRUE) {
+	return program_id;
+}
+
+// Blocks until a program started with start_program() is linked, unless it already is, and tells whether it worked.
+static bool finish_program(GLuint program_id, const GLuint stages[STAGES_COUNT]) {
+	bool success = true;
+
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		if (stages[i] && !check_shader(stages[i])) {
+			success = false;
+		}
+	}
+
+	GLint linked;
+	glGetProgramiv(program_id, GL_LINK_STATUS, &linked);
+	if (success && linked != GL_TRUE) {
 		GLint info_log_size;
 		glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &info_log_size);
 		char info_log[info_log_size];
@@ -341,36 +423,333 @@ struct layman_shader *layman_shader_load_from_memory(const unsigned char *vertex
 
 		fprintf(stderr, "Shader linking error: %s\n", info_log);
 
-		return 0;
+		success = false;
 	}
 
 	// Flag shaders for deletion as soon as they get detached (happens upon program deletion).
-	glDeleteShader(vertex_shader_id);
-	glDeleteShader(fragment_shader_id);
-	glDeleteShader(compute_shader_id);
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		glDeleteShader(stages[i]);
+	}
 
-	struct layman_shader *shader = malloc(sizeof *shader);
-	if (!shader) {
+	return success;
+}
+
+// Builds the path of the cached binary of a program, or returns `false` when it doesn't fit.
+static bool binary_path(uint64_t hash, char *path, size_t size) {
+	int length = snprintf(path, size, "%s/%016" PRIx64 ".bin", cache_directory, hash);
+	return length > 0 && (size_t) length < size;
+}
+
+// Creates a program from a cached binary, or returns `0` when there's none or when the driver rejects it.
+static GLuint load_binary(const char *path, uint64_t hash) {
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		return 0;
+	}
+
+	struct binary_header header;
+	void *binary = NULL;
+	GLuint program_id = 0;
+
+	if (fread(&header, sizeof header, 1, file) != 1 || header.magic != BINARY_MAGIC || header.hash != hash) {
+		goto done;
+	}
+
+	binary = malloc(header.length);
+	if (!binary || fread(binary, 1, header.length, file) != header.length) {
+		goto done;
+	}
+
+	program_id = glCreateProgram();
+	if (!program_id) {
+		goto done;
+	}
+
+	glProgramBinary(program_id, header.format, binary, header.length);
+
+	// Drivers reject binaries from other versions of themselves; a regular compilation then takes over.
+	GLint success;
+	glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+	if (success != GL_TRUE) {
 		glDeleteProgram(program_id);
-		return NULL;
+		program_id = 0;
+	}
+
+done:
+	free(binary);
+	fclose(file);
+
+	return program_id;
+}
+
+static void save_binary(GLuint program_id, const char *path, uint64_t hash) {
+	GLint length = 0;
+	glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return; // The driver doesn't support any binary format.
+	}
+
+	void *binary = malloc(length);
+	if (!binary) {
+		return;
 	}
 
-	shader->program_id = program_id;
+	struct binary_header header = {
+		.magic = BINARY_MAGIC,
+		.hash = hash,
+	};
+
+	GLsizei written = 0;
+	glGetProgramBinary(program_id, length, &written, &header.format, binary);
+	header.length = written;
+
+	// Written aside first, so that nobody ever reads a partial binary.
+	char temporary_path[FILENAME_MAX];
+	int temporary_length = snprintf(temporary_path, sizeof temporary_path, "%s.tmp", path);
+
+	FILE *file = NULL;
+	if (temporary_length > 0 && (size_t) temporary_length < sizeof temporary_path) {
+		file = fopen(temporary_path, "wb");
+	}
+
+	if (file) {
+		bool ok = fwrite(&header, sizeof header, 1, file) == 1 && fwrite(binary, 1, written, file) == (size_t) written;
+		ok = fclose(file) == 0 && ok;
+
+		if (!ok || rename(temporary_path, path) != 0) {
+			remove(temporary_path);
+		}
+	}
+
+	free(binary);
+}
+
+// Everything left to do once the program is linked.
+static void complete(struct layman_shader *shader) {
+	shader->status = finish_program(shader->program_id, shader->stages) ? LAYMAN_SHADER_STATUS_READY : LAYMAN_SHADER_STATUS_FAILED;
+
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		shader->stages[i] = 0;
+	}
+
+	if (shader->status != LAYMAN_SHADER_STATUS_READY) {
+		return;
+	}
+
+	char path[FILENAME_MAX];
+	if (shader->binary_cached && binary_path(shader->binary_hash, path, sizeof path)) {
+		save_binary(shader->program_id, path, shader->binary_hash);
+	}
 
 	layman_shader_switch(shader);
 	find_uniforms(shader);
+	setup_bindings(shader);
+}
+
+static struct layman_shader *load(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length, const char *defines, bool wait) {
+	struct layman_shader *shader = malloc(sizeof *shader);
+	if (!shader) {
+		return NULL;
+	}
+
+	shader->hash = 0;
+	shader->context = NULL;
+	shader->references = 0;
+	shader->status = LAYMAN_SHADER_STATUS_PENDING;
+	shader->binary_cached = false;
+
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		shader->stages[i] = 0;
+	}
+
+	// Binaries only work with the exact same driver and everything that ends up in the sources.
+	if (cache_directory) {
+		uint64_t hash = HASH_OFFSET;
+		hash = hash_stage(hash, vertex_content, vertex_length);
+		hash = hash_stage(hash, fragment_content, fragment_length);
+		hash = hash_stage(hash, compute_content, compute_length);
+		hash = hash_stage(hash, defines, defines ? strlen(defines) : 0);
+
+		shader->binary_hash = hash_environment(hash);
+		shader->binary_cached = true;
+	}
+
+	char path[FILENAME_MAX];
+	if (shader->binary_cached && binary_path(shader->binary_hash, path, sizeof path)) {
+		shader->program_id = load_binary(path, shader->binary_hash);
+
+		// Nothing to compile, the program is ready right away.
+		if (shader->program_id) {
+			shader->binary_cached = false;
+			complete(shader);
+			return shader;
+		}
+	}
+
+	shader->program_id = start_program(vertex_content, vertex_length, fragment_content, fragment_length, compute_content, compute_length, defines, shader->stages);
+	if (!shader->program_id) {
+		free(shader);
+		return NULL;
+	}
+
+	if (wait) {
+		complete(shader);
+
+		if (shader->status != LAYMAN_SHADER_STATUS_READY) {
+			layman_shader_destroy(shader);
+			return NULL;
+		}
+	}
 
 	return shader;
 }
 
+bool layman_shader_cache_directory(const char *path) {
+	free(cache_directory);
+	cache_directory = NULL;
+
+	if (!path) {
+		return true;
+	}
+
+	size_t length = strlen(path);
+	cache_directory = malloc(length + 1);
+	if (!cache_directory) {
+		return false;
+	}
+
+	memcpy(cache_directory, path, length + 1);
+
+	return true;
+}
+
+struct layman_shader *layman_shader_load_from_memory(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length) {
+	return load(vertex_content, vertex_length, fragment_content, fragment_length, compute_content, compute_length, NULL, true);
+}
+
+struct layman_shader *layman_shader_load_from_memory_async(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length) {
+	return load(vertex_content, vertex_length, fragment_content, fragment_length, compute_content, compute_length, NULL, false);
+}
+
+void layman_shader_setup_parallel_compile(void) {
+	parallel_compile = false;
+
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count && !parallel_compile; i++) {
+		const char *name = (const char *) glGetStringi(GL_EXTENSIONS, i);
+		parallel_compile = strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || strcmp(name, "GL_ARB_parallel_shader_compile") == 0;
+	}
+
+	if (!parallel_compile) {
+		return;
+	}
+
+	max_shader_compiler_threads_proc max_threads = (max_shader_compiler_threads_proc) glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+	if (!max_threads) {
+		max_threads = (max_shader_compiler_threads_proc) glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+	}
+
+	// As many threads as the driver sees fit.
+	if (max_threads) {
+		max_threads(0xFFFFFFFF);
+	}
+}
+
+enum layman_shader_status layman_shader_poll(struct layman_shader *shader) {
+	if (shader->status != LAYMAN_SHADER_STATUS_PENDING) {
+		return shader->status;
+	}
+
+	// Without the extension, there's no way to know without blocking.
+	if (parallel_compile) {
+		GLint completed;
+		glGetProgramiv(shader->program_id, COMPLETION_STATUS, &completed);
+		if (!completed) {
+			return LAYMAN_SHADER_STATUS_PENDING;
+		}
+	}
+
+	complete(shader);
+
+	return shader->status;
+}
+
+struct layman_shader *layman_shader_acquire(const unsigned char *vertex_content, size_t vertex_length, const unsigned char *fragment_content, size_t fragment_length, const unsigned char *compute_content, size_t compute_length, const char *defines) {
+	uint64_t hash = HASH_OFFSET;
+	hash = hash_stage(hash, vertex_content, vertex_length);
+	hash = hash_stage(hash, fragment_content, fragment_length);
+	hash = hash_stage(hash, compute_content, compute_length);
+	hash = hash_stage(hash, defines, defines ? strlen(defines) : 0);
+
+	// Contexts don't share their objects, each one gets its own programs.
+	const void *context = glfwGetCurrentContext();
+
+	for (size_t i = 0; i < cache_count; i++) {
+		if (cache[i]->hash == hash && cache[i]->context == context) {
+			cache[i]->references++;
+			return cache[i];
+		}
+	}
+
+	struct layman_shader **new_cache = realloc(cache, (cache_count + 1) * sizeof *cache);
+	if (!new_cache) {
+		return NULL;
+	}
+
+	cache = new_cache;
+
+	// Compiled in the background, the users poll it before drawing with it.
+	struct layman_shader *shader = load(vertex_content, vertex_length, fragment_content, fragment_length, compute_content, compute_length, defines, false);
+	if (!shader) {
+		return NULL;
+	}
+
+	shader->hash = hash;
+	shader->context = context;
+	shader->references = 1;
+
+	cache[cache_count] = shader;
+	cache_count++;
+
+	return shader;
+}
+
+void layman_shader_release(struct layman_shader *shader) {
+	if (!shader || --shader->references > 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < cache_count; i++) {
+		if (cache[i] == shader) {
+			cache[i] = cache[cache_count - 1];
+			cache_count--;
+			break;
+		}
+	}
+
+	layman_shader_destroy(shader);
+}
+
+// The program in use on this thread, see layman_shader_switch().
+thread_local static const struct layman_shader *current;
+
 void layman_shader_destroy(struct layman_shader *shader) {
+	// A new program allocated at the same address must not be mistaken for this one.
+	if (current == shader) {
+		layman_shader_switch(NULL);
+	}
+
+	// Pending programs still own their shaders.
+	for (size_t i = 0; i < STAGES_COUNT; i++) {
+		glDeleteShader(shader->stages[i]);
+	}
+
 	glDeleteProgram(shader->program_id);
 	free(shader);
 }
 
 void layman_shader_switch(const struct layman_shader *new) {
-	thread_local static const struct layman_shader *current;
-
 	if (current == new) {
 		return;
 	}
@@ -386,64 +765,10 @@ void layman_shader_bind_uniform_material(const struct layman_shader *shader, con
 	layman_shader_switch(shader);
 
 	glUniform4fv(shader->uniform_base_color_factor, 1, material->base_color_factor);
-	glUniform1i(shader->uniform_base_color_sampler, material->base_color_texture->kind);
-	glUniform1i(shader->uniform_metallic_roughness_sampler, material->metallic_roughness_texture->kind);
 	glUniform1f(shader->uniform_metallic_factor, material->metallic_factor);
 	glUniform1f(shader->uniform_roughness_factor, material->roughness_factor);
-	glUniform1i(shader->uniform_normal_sampler, material->normal_texture->kind);
 	glUniform1f(shader->uniform_normal_scale, material->normal_scale);
-	glUniform1i(shader->uniform_occlusion_sampler, material->occlusion_texture->kind);
 	glUniform1f(shader->uniform_occlusion_strength, material->occlusion_strength);
-	glUniform1i(shader->uniform_emissive_sampler, material->emissive_texture->kind);
 	glUniform3fv(shader->uniform_emissive_factor, 1, material->emissive_factor);
-}
-
-void layman_shader_bind_uniform_environment(const struct layman_shader *shader, const struct layman_environment *environment) {
-	layman_shader_switch(shader);
-
-	glUniform1i(shader->uniform_environment_mip_count, environment->mip_count);
-	glUniform1i(shader->uniform_environment_lambertian, environment->lambertian->kind);
-	glUniform1i(shader->uniform_environment_ggx, environment->ggx->kind);
-	glUniform1i(shader->uniform_environment_ggx_lut, environment->ggx_lut->kind);
-	glUniform1i(shader->uniform_environment_charlie, environment->charlie->kind);
-	glUniform1i(shader->uniform_environment_charlie_lut, environment->charlie_lut->kind);
-}
-
-void layman_shader_bind_uniform_camera(const struct layman_shader *shader, const struct layman_camera *camera) {
-	layman_shader_switch(shader);
-
-	glUniform3fv(shader->uniform_camera, 1, camera->translation);
-}
-
-void layman_shader_bind_uniform_lights(const struct layman_shader *shader, const struct layman_light **lights, size_t count) {
-	layman_shader_switch(shader);
-
-	for (size_t i = 0; i < count; i++) {
-		// TODO: This doesn't clean up old light uniforms when they're removed!
-		if (i >= MAX_LIGHTS) {
-			break;
-		}
-
-		const struct layman_light *light = lights[i];
-
-		switch (light->type) {
-		    case LAYMAN_LIGHT_TYPE_DIRECTIONAL:
-			    glUniform1i(shader->uniform_lights_type[i], light->type);
-			    glUniform3fv(shader->uniform_lights_position[i], 1, light->position);
-			    glUniform3fv(shader->uniform_lights_direction[i], 1, light->direction);
-			    glUniform3fv(shader->uniform_lights_color[i], 1, light->color);
-			    glUniform1f(shader->uniform_lights_intensity[i], light->intensity);
-			    break;
-
-		    case LAYMAN_LIGHT_TYPE_POINT:
-			    glUniform1i(shader->uniform_lights_type[i], light->type);
-			    glUniform3fv(shader->uniform_lights_position[i], 1, light->position);
-			    glUniform3fv(shader->uniform_lights_color[i], 1, light->color);
-			    glUniform1f(shader->uniform_lights_intensity[i], light->intensity);
-			    break;
-
-		    // TODO: The other types of lights.
-		    default: break;
-		}
-	}
+	glUniform1f(shader->uniform_alpha_cutoff, material->alpha_cutoff);
 }
@@ -0,0 +1,485 @@
+#include "layman.h"
+#include <math.h>
+#include <string.h>
+
+// Share of the triangles a pass removes at most. Removing fewer at once keeps the order closer to the cheapest first,
+// at the price of more passes.
+#define PASS_SHARE 0.2f
+
+// Below this reduction, a LOD takes more memory than it saves vertex shading.
+#define CHAIN_MIN_REDUCTION 0.85f
+
+#define FLIP_COSINE 0.5f
+
+#define NONE UINT32_MAX
+#define NO_EDGE UINT64_MAX
+
+// Sum of the squared distances to planes, as the symmetric matrix `A`, the vector `b` and the scalar `c` of
+// `p·A·p + 2·b·p + c`.
+struct quadric {
+	double a00, a11, a22, a01, a02, a12;
+	double b0, b1, b2;
+	double c;
+};
+
+// Collapsing the vertex `from` onto the vertex `to`.
+struct collapse {
+	float cost;
+	uint32_t from;
+	uint32_t to;
+};
+
+// A mesh being simplified, which can go on from one target to the next.
+struct simplifier {
+	size_t vertices_count;
+	float *points;               // Positions within the unit sphere.
+	uint32_t *canonical;         // First vertex at the same position as each.
+	bool *locked;
+	bool *marked;                // Vertices around the collapses of the current pass.
+	struct quadric *quadrics;
+	uint32_t *targets;           // Vertex each collapses onto, itself if none.
+
+	uint32_t *indices;
+	size_t indices_count;
+	struct collapse *collapses;
+	struct layman_adjacency adjacency;
+
+	double largest_cost;
+};
+
+static size_t table_size(size_t count) {
+	size_t size = 16;
+	while (size < count * 2) {
+		size *= 2;
+	}
+
+	return size;
+}
+
+static uint32_t hash_position(const float *position) {
+	uint32_t bits[3];
+	memcpy(bits, position, sizeof bits);
+	return bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u;
+}
+
+static uint64_t hash_edge(uint64_t edge) {
+	edge ^= edge >> 33;
+	edge *= UINT64_C(0xFF51AFD7ED558CCD);
+	edge ^= edge >> 33;
+	return edge;
+}
+
+// Numbers every vertex by the first one at the same position.
+static bool find_positions(const float *points, size_t vertices_count, uint32_t *canonical) {
+	size_t size = table_size(vertices_count);
+	uint32_t *table = malloc(size * sizeof *table);
+	if (!table) {
+		return false;
+	}
+
+	memset(table, 0xFF, size * sizeof *table);
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		const float *point = points + v * 3;
+
+		size_t slot = hash_position(point) & (size - 1);
+		while (table[slot] != NONE && memcmp(points + table[slot] * 3, point, 3 * sizeof (float)) != 0) {
+			slot = (slot + 1) & (size - 1);
+		}
+
+		if (table[slot] == NONE) {
+			table[slot] = v;
+		}
+
+		canonical[v] = table[slot];
+	}
+
+	free(table);
+
+	return true;
+}
+
+// Finds the edges, by position, used by a single triangle. Those with triangles on both sides appear once each way.
+static bool find_borders(const uint32_t *indices, size_t indices_count, const uint32_t *canonical, bool *border) {
+	size_t size = table_size(indices_count);
+	uint64_t *table = malloc(size * sizeof *table);
+	if (!table) {
+		return false;
+	}
+
+	memset(table, 0xFF, size * sizeof *table);
+
+	for (size_t pass = 0; pass < 2; pass++) {
+		for (size_t i = 0; i < indices_count; i++) {
+			uint32_t a = canonical[indices[i]];
+			uint32_t b = canonical[indices[i - i % 3 + (i + 1) % 3]];
+			if (a == b) {
+				continue;
+			}
+
+			// Record every edge first, then look for the opposite of each.
+			uint64_t edge = pass == 0 ? (uint64_t) a << 32 | b : (uint64_t) b << 32 | a;
+			size_t slot = hash_edge(edge) & (size - 1);
+			while (table[slot] != NO_EDGE && table[slot] != edge) {
+				slot = (slot + 1) & (size - 1);
+			}
+
+			if (pass == 0) {
+				table[slot] = edge;
+			} else if (table[slot] == NO_EDGE) {
+				border[a] = true;
+				border[b] = true;
+			}
+		}
+	}
+
+	free(table);
+
+	return true;
+}
+
+static void quadric_add(struct quadric *quadric, const struct quadric *other) {
+	double *values = (double *) quadric;
+	const double *others = (const double *) other;
+	for (size_t i = 0; i < sizeof *quadric / sizeof (double); i++) {
+		values[i] += others[i];
+	}
+}
+
+static void quadric_add_plane(struct quadric *quadric, const double normal[3], double distance) {
+	quadric->a00 += normal[0] * normal[0];
+	quadric->a11 += normal[1] * normal[1];
+	quadric->a22 += normal[2] * normal[2];
+	quadric->a01 += normal[0] * normal[1];
+	quadric->a02 += normal[0] * normal[2];
+	quadric->a12 += normal[1] * normal[2];
+	quadric->b0 += normal[0] * distance;
+	quadric->b1 += normal[1] * distance;
+	quadric->b2 += normal[2] * distance;
+	quadric->c += distance * distance;
+}
+
+static double quadric_evaluate(const struct quadric *quadric, const float *point) {
+	double x = point[0], y = point[1], z = point[2];
+	double value = quadric->a00 * x * x + quadric->a11 * y * y + quadric->a22 * z * z
+	               + 2.0 * (quadric->a01 * x * y + quadric->a02 * x * z + quadric->a12 * y * z)
+	               + 2.0 * (quadric->b0 * x + quadric->b1 * y + quadric->b2 * z)
+	               + quadric->c;
+
+	// Rounding can take it just below zero.
+	return value > 0.0 ? value : 0.0;
+}
+
+static void triangle_normal(const float *a, const float *b, const float *c, double normal[3]) {
+	double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+	double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+	normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+	normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+	normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+}
+
+// Every vertex gets the planes of the triangles around it, such that moving it measures how far it gets from them.
+static void compute_quadrics(const uint32_t *indices, size_t indices_count, const float *points, struct quadric *quadrics) {
+	for (size_t i = 0; i + 2 < indices_count; i += 3) {
+		const float *a = points + indices[i] * 3;
+
+		double normal[3];
+		triangle_normal(a, points + indices[i + 1] * 3, points + indices[i + 2] * 3, normal);
+
+		double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0) {
+			continue;
+		}
+
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+		double distance = -(normal[0] * a[0] + normal[1] * a[1] + normal[2] * a[2]);
+
+		for (size_t k = 0; k < 3; k++) {
+			quadric_add_plane(quadrics + indices[i + k], normal, distance);
+		}
+	}
+}
+
+static int compare_collapses(const void *a, const void *b) {
+	float cost_a = ((const struct collapse *) a)->cost;
+	float cost_b = ((const struct collapse *) b)->cost;
+	return (cost_a > cost_b) - (cost_a < cost_b);
+}
+
+// Tells whether moving a vertex onto another keeps the triangles around it facing the same way, and addressing the
+// same vertices where the other has several.
+static bool collapse_valid(const struct collapse *collapse, const uint32_t *indices, const struct layman_adjacency *adjacency, const float *points, const uint32_t *canonical) {
+	for (uint32_t t = adjacency->offsets[collapse->from]; t < adjacency->offsets[collapse->from + 1]; t++) {
+		const uint32_t *triangle = indices + adjacency->triangles[t] * 3;
+		if (triangle[0] == collapse->to || triangle[1] == collapse->to || triangle[2] == collapse->to) {
+			continue; // Goes away.
+		}
+
+		const float *before[3], *after[3];
+		for (size_t k = 0; k < 3; k++) {
+			if (triangle[k] != collapse->from && canonical[triangle[k]] == canonical[collapse->to]) {
+				return false;
+			}
+
+			before[k] = points + triangle[k] * 3;
+			after[k] = triangle[k] == collapse->from ? points + collapse->to * 3 : before[k];
+		}
+
+		double normal_before[3], normal_after[3];
+		triangle_normal(before[0], before[1], before[2], normal_before);
+		triangle_normal(after[0], after[1], after[2], normal_after);
+		double dot = normal_before[0] * normal_after[0] + normal_before[1] * normal_after[1] + normal_before[2] * normal_after[2];
+		double lengths = sqrt((normal_before[0] * normal_before[0] + normal_before[1] * normal_before[1] + normal_before[2] * normal_before[2]) * (normal_after[0] * normal_after[0] + normal_after[1] * normal_after[1] + normal_after[2] * normal_after[2]));
+		if (dot <= FLIP_COSINE * lengths) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Applies the collapses of a pass, dropping the triangles they made degenerate.
+static size_t apply_collapses(uint32_t *indices, size_t indices_count, const uint32_t *targets) {
+	size_t count = 0;
+	for (size_t i = 0; i + 2 < indices_count; i += 3) {
+		uint32_t a = targets[indices[i]], b = targets[indices[i + 1]], c = targets[indices[i + 2]];
+		if (a != b && b != c && c != a) {
+			indices[count++] = a;
+			indices[count++] = b;
+			indices[count++] = c;
+		}
+	}
+
+	return count;
+}
+
+static void finish(struct simplifier *simplifier) {
+	free(simplifier->points);
+	free(simplifier->canonical);
+	free(simplifier->locked);
+	free(simplifier->marked);
+	free(simplifier->quadrics);
+	free(simplifier->targets);
+	free(simplifier->indices);
+	free(simplifier->collapses);
+	layman_adjacency_destroy(&simplifier->adjacency);
+}
+
+static bool start(struct simplifier *simplifier, const uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count) {
+	for (size_t i = 0; i < indices_count; i++) {
+		if (indices[i] >= vertices_count) {
+			return false;
+		}
+	}
+
+	stride = stride ? stride : 3 * sizeof (float);
+	indices_count -= indices_count % 3;
+
+	*simplifier = (struct simplifier) {
+		.vertices_count = vertices_count,
+		.points = malloc(vertices_count * 3 * sizeof *simplifier->points + 1),
+		.canonical = malloc(vertices_count * sizeof *simplifier->canonical + 1),
+		.locked = calloc(vertices_count + 1, sizeof *simplifier->locked),
+		.marked = malloc((vertices_count + 1) * sizeof *simplifier->marked),
+		.quadrics = calloc(vertices_count + 1, sizeof *simplifier->quadrics),
+		.targets = malloc(vertices_count * sizeof *simplifier->targets + 1),
+		.indices = malloc(indices_count * sizeof *simplifier->indices + 1),
+		.collapses = malloc(indices_count * 2 * sizeof *simplifier->collapses + 1),
+		.largest_cost = 0.0,
+	};
+
+	bool adjacency = layman_adjacency_create(&simplifier->adjacency, indices_count, vertices_count);
+	if (!simplifier->points || !simplifier->canonical || !simplifier->locked || !simplifier->marked || !simplifier->quadrics || !simplifier->targets || !simplifier->indices || !simplifier->collapses || !adjacency) {
+		finish(simplifier);
+		return false;
+	}
+
+	// Positions are brought within the unit sphere, for the errors to be relative to the size of the mesh.
+	vec3 min = {INFINITY, INFINITY, INFINITY}, max = {-INFINITY, -INFINITY, -INFINITY};
+	for (size_t v = 0; v < vertices_count; v++) {
+		const float *position = (const float *) ((const unsigned char *) positions + v * stride);
+		glm_vec3_minv(min, (float *) position, min);
+		glm_vec3_maxv(max, (float *) position, max);
+	}
+
+	vec3 center;
+	glm_vec3_center(min, max, center);
+	float radius = vertices_count ? glm_vec3_distance(min, max) / 2.0f : 0.0f;
+	float scale = radius > 0.0f ? 1.0f / radius : 1.0f;
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		const float *position = (const float *) ((const unsigned char *) positions + v * stride);
+		for (size_t k = 0; k < 3; k++) {
+			simplifier->points[v * 3 + k] = (position[k] - center[k]) * scale;
+		}
+	}
+
+	// Vertices sharing their position with others or on a border stay where they are.
+	if (!find_positions(simplifier->points, vertices_count, simplifier->canonical) || !find_borders(indices, indices_count, simplifier->canonical, simplifier->locked)) {
+		finish(simplifier);
+		return false;
+	}
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		if (simplifier->canonical[v] != v) {
+			simplifier->locked[v] = true;
+			simplifier->locked[simplifier->canonical[v]] = true;
+		}
+	}
+
+	for (size_t v = 0; v < vertices_count; v++) {
+		simplifier->locked[v] = simplifier->locked[v] || simplifier->locked[simplifier->canonical[v]];
+		simplifier->targets[v] = v;
+	}
+
+	compute_quadrics(indices, indices_count, simplifier->points, simplifier->quadrics);
+
+	// Triangles degenerate from the start would only get in the way.
+	memcpy(simplifier->indices, indices, indices_count * sizeof *simplifier->indices);
+	simplifier->indices_count = apply_collapses(simplifier->indices, indices_count, simplifier->targets);
+
+	return true;
+}
+
+// Collapses edges until the indices get down to a number, or nothing else can collapse.
+static void simplify(struct simplifier *simplifier, size_t target_count) {
+	uint32_t *indices = simplifier->indices;
+	struct layman_adjacency *adjacency = &simplifier->adjacency;
+
+	while (simplifier->indices_count > target_count) {
+		size_t count = simplifier->indices_count;
+		layman_adjacency_build(adjacency, indices, count, simplifier->vertices_count);
+
+		// Both ways of every edge, as long as the vertex moving isn't locked.
+		size_t collapses_count = 0;
+		for (size_t i = 0; i < count; i++) {
+			uint32_t a = indices[i];
+			uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+			uint32_t ends[2][2] = {{a, b}, {b, a}};
+
+			for (size_t e = 0; e < 2; e++) {
+				uint32_t from = ends[e][0], to = ends[e][1];
+				if (simplifier->locked[from]) {
+					continue;
+				}
+
+				struct quadric sum = simplifier->quadrics[from];
+				quadric_add(&sum, simplifier->quadrics + to);
+				simplifier->collapses[collapses_count++] = (struct collapse) {quadric_evaluate(&sum, simplifier->points + to * 3), from, to};
+			}
+		}
+
+		qsort(simplifier->collapses, collapses_count, sizeof *simplifier->collapses, compare_collapses);
+
+		// The cheapest collapses go first. Vertices around one that happened wait for the next pass, their triangles
+		// having changed under the costs and checks.
+		memset(simplifier->marked, 0, simplifier->vertices_count * sizeof *simplifier->marked);
+		size_t goal = (count - target_count) / 3;
+		goal = goal < count / 3 * PASS_SHARE ? goal : count / 3 * PASS_SHARE + 1;
+		size_t removed = 0;
+
+		for (size_t c = 0; c < collapses_count && removed < goal; c++) {
+			const struct collapse *collapse = simplifier->collapses + c;
+			if (simplifier->marked[collapse->from] || simplifier->marked[collapse->to] || !collapse_valid(collapse, indices, adjacency, simplifier->points, simplifier->canonical)) {
+				continue;
+			}
+
+			for (uint32_t t = adjacency->offsets[collapse->from]; t < adjacency->offsets[collapse->from + 1]; t++) {
+				const uint32_t *triangle = indices + adjacency->triangles[t] * 3;
+				for (size_t k = 0; k < 3; k++) {
+					simplifier->marked[triangle[k]] = true;
+					removed += triangle[k] == collapse->to;
+				}
+			}
+
+			quadric_add(simplifier->quadrics + collapse->to, simplifier->quadrics + collapse->from);
+			simplifier->targets[collapse->from] = collapse->to;
+			simplifier->largest_cost = collapse->cost > simplifier->largest_cost ? collapse->cost : simplifier->largest_cost;
+		}
+
+		if (removed == 0) {
+			break;
+		}
+
+		simplifier->indices_count = apply_collapses(indices, count, simplifier->targets);
+	}
+}
+
+bool layman_simplifier_simplify(const uint32_t *indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, size_t target_count, uint32_t *destination, size_t *destination_count, float *error) {
+	struct simplifier simplifier;
+	if (!start(&simplifier, indices, indices_count, positions, stride, vertices_count)) {
+		return false;
+	}
+
+	simplify(&simplifier, target_count);
+
+	memcpy(destination, simplifier.indices, simplifier.indices_count * sizeof *destination);
+	*destination_count = simplifier.indices_count;
+	*error = sqrt(simplifier.largest_cost);
+
+	finish(&simplifier);
+
+	return true;
+}
+
+size_t layman_simplifier_chain(uint32_t **indices, size_t indices_count, const float *positions, size_t stride, size_t vertices_count, size_t lods_count, float ratio, struct layman_mesh_lod *lods) {
+	lods[0] = (struct layman_mesh_lod) {0, indices_count, 0.0f};
+
+	struct simplifier simplifier;
+	if (lods_count < 2 || !start(&simplifier, *indices, indices_count, positions, stride, vertices_count)) {
+		return 1;
+	}
+
+	uint32_t *remap = malloc(vertices_count * sizeof *remap + 1);
+	uint32_t *inverse = malloc(vertices_count * sizeof *inverse + 1);
+
+	size_t total = indices_count;
+	size_t made = 1;
+	for (; made < lods_count && remap && inverse; made++) {
+		const struct layman_mesh_lod *previous = lods + made - 1;
+
+		size_t target = (size_t) (previous->indices_count * ratio) / 3 * 3;
+		if (target == 0) {
+			break;
+		}
+
+		simplify(&simplifier, target);
+
+		size_t count = simplifier.indices_count;
+		if (count > previous->indices_count * CHAIN_MIN_REDUCTION) {
+			break;
+		}
+
+		uint32_t *new_indices = realloc(*indices, (total + count) * sizeof *new_indices);
+		if (!new_indices) {
+			break;
+		}
+
+		*indices = new_indices;
+
+		uint32_t *lod = *indices + total;
+		memcpy(lod, simplifier.indices, count * sizeof *lod);
+
+		// The vertices are shared with the full detail, only the order of the triangles may change.
+		if (layman_optimizer_optimize(lod, count, positions, stride, vertices_count, remap)) {
+			for (size_t v = 0; v < vertices_count; v++) {
+				inverse[remap[v]] = v;
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				lod[i] = inverse[lod[i]];
+			}
+		}
+
+		lods[made] = (struct layman_mesh_lod) {total, count, sqrt(simplifier.largest_cost)};
+		total += count;
+	}
+
+	free(remap);
+	free(inverse);
+	finish(&simplifier);
+
+	return made;
+}
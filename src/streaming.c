@@ -0,0 +1,250 @@
+#include "layman.h"
+
+// Offsets are kept aligned for the driver's copy routines.
+#define ALIGNMENT 16
+#define ALIGN(x) (((x) + ALIGNMENT - 1) & ~(size_t) (ALIGNMENT - 1))
+
+struct layman_streaming *layman_streaming_create(size_t size) {
+	#ifdef GL_ARB_buffer_storage
+	if (!GLAD_GL_ARB_buffer_storage) {
+		return NULL;
+	}
+
+	struct layman_streaming *streaming = malloc(sizeof *streaming);
+	if (!streaming) {
+		return NULL;
+	}
+
+	streaming->size = size;
+	streaming->head = 0;
+	streaming->tail = 0;
+	streaming->used = 0;
+	streaming->uploads = NULL;
+	streaming->uploads_count = 0;
+	streaming->uploads_capacity = 0;
+	streaming->first_ticket = 0;
+
+	// Coherent, such that what's written is visible to the GPU without flushing explicitly.
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glGenBuffers(1, &streaming->buffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streaming->buffer);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+	streaming->mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (!streaming->mapped) {
+		glDeleteBuffers(1, &streaming->buffer);
+		free(streaming);
+		return NULL;
+	}
+
+	return streaming;
+	#else
+	UNUSED(size);
+	return NULL;
+	#endif
+}
+
+void layman_streaming_destroy(struct layman_streaming *streaming) {
+	if (!streaming) {
+		return;
+	}
+
+	for (size_t i = 0; i < streaming->uploads_count; i++) {
+		struct layman_streaming_upload *upload = streaming->uploads + i;
+
+		if (upload->state == LAYMAN_STREAMING_STATE_ISSUED) {
+			glDeleteSync(upload->fence);
+		} else if (upload->texture) {
+			upload->texture->streaming = NULL;
+		}
+	}
+
+	// Deleting the buffer unmaps it.
+	glDeleteBuffers(1, &streaming->buffer);
+
+	free(streaming->uploads);
+	free(streaming);
+}
+
+// Finds room for a number of bytes in the ring, wrapping around to its start when the end is too short.
+static bool allocate(struct layman_streaming *streaming, size_t length, size_t *offset) {
+	// Nothing in use anymore, start over from the beginning to keep the most contiguous space.
+	if (streaming->used == 0) {
+		streaming->head = 0;
+		streaming->tail = 0;
+	}
+
+	// The head only meets the tail again when the ring is full.
+	size_t consumed;
+	if (streaming->head > streaming->tail || streaming->used == 0) {
+		if (streaming->head + length <= streaming->size) {
+			*offset = streaming->head;
+			consumed = length;
+		} else if (length <= streaming->tail) {
+			// The end of the ring is skipped, it's given back along with this allocation.
+			*offset = 0;
+			consumed = streaming->size - streaming->head + length;
+		} else {
+			return false;
+		}
+	} else if (streaming->head + length <= streaming->tail) {
+		*offset = streaming->head;
+		consumed = length;
+	} else {
+		return false;
+	}
+
+	streaming->head = *offset + length;
+	streaming->used += consumed;
+
+	return true;
+}
+
+unsigned char *layman_streaming_reserve(struct layman_streaming *streaming, size_t length, uint64_t *ticket) {
+	length = ALIGN(length);
+
+	if (streaming->uploads_count == streaming->uploads_capacity) {
+		size_t new_capacity = streaming->uploads_capacity ? 2 * streaming->uploads_capacity : 16;
+		struct layman_streaming_upload *new_uploads = realloc(streaming->uploads, new_capacity * sizeof *new_uploads);
+		if (!new_uploads) {
+			return NULL;
+		}
+
+		streaming->uploads = new_uploads;
+		streaming->uploads_capacity = new_capacity;
+	}
+
+	size_t used = streaming->used;
+	size_t offset;
+	if (!allocate(streaming, length, &offset)) {
+		return NULL;
+	}
+
+	struct layman_streaming_upload *upload = streaming->uploads + streaming->uploads_count;
+	upload->state = LAYMAN_STREAMING_STATE_RESERVED;
+	upload->texture = NULL;
+	upload->offset = offset;
+	upload->length = streaming->used - used; // Including what was skipped to wrap around.
+	upload->end = streaming->head;
+	upload->fence = NULL;
+
+	*ticket = streaming->first_ticket + streaming->uploads_count;
+	streaming->uploads_count++;
+
+	return streaming->mapped + offset;
+}
+
+// Gets a reservation that wasn't submitted or discarded yet.
+static struct layman_streaming_upload *reserved(struct layman_streaming *streaming, uint64_t ticket) {
+	if (ticket < streaming->first_ticket || ticket - streaming->first_ticket >= streaming->uploads_count) {
+		return NULL;
+	}
+
+	struct layman_streaming_upload *upload = streaming->uploads + (ticket - streaming->first_ticket);
+
+	return upload->state == LAYMAN_STREAMING_STATE_RESERVED ? upload : NULL;
+}
+
+bool layman_streaming_submit(struct layman_streaming *streaming, uint64_t ticket, struct layman_texture *texture) {
+	struct layman_streaming_upload *upload = reserved(streaming, ticket);
+	if (!upload) {
+		return false;
+	}
+
+	upload->state = LAYMAN_STREAMING_STATE_READY;
+	upload->texture = texture;
+	texture->streaming = streaming;
+
+	// Until then, the storage holds whatever was there.
+	layman_texture_provide_placeholder(texture);
+
+	return true;
+}
+
+void layman_streaming_discard(struct layman_streaming *streaming, uint64_t ticket) {
+	struct layman_streaming_upload *upload = reserved(streaming, ticket);
+	if (upload) {
+		upload->state = LAYMAN_STREAMING_STATE_READY;
+	}
+}
+
+void layman_streaming_cancel(struct layman_streaming *streaming, const struct layman_texture *texture) {
+	for (size_t i = 0; i < streaming->uploads_count; i++) {
+		struct layman_streaming_upload *upload = streaming->uploads + i;
+
+		if (upload->texture == texture && upload->state == LAYMAN_STREAMING_STATE_READY) {
+			upload->texture = NULL;
+		}
+	}
+}
+
+static void issue(struct layman_streaming *streaming, struct layman_streaming_upload *upload) {
+	struct layman_texture *texture = upload->texture;
+
+	if (texture) {
+		layman_texture_switch(texture);
+		glTexParameteri(texture->gl_target, GL_TEXTURE_BASE_LEVEL, 0);
+
+		// Decoded rows are tightly packed, whatever their width.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streaming->buffer);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(texture->gl_target, 0, 0, 0, texture->width, texture->height, texture->gl_format, texture->gl_type, (const void *) upload->offset);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if (texture->levels > 1) {
+			glGenerateMipmap(texture->gl_target);
+		}
+
+		texture->streaming = NULL;
+	}
+
+	// Discarded memory still waits for the uploads before it, which can't be told apart from this one anyway.
+	upload->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	upload->state = LAYMAN_STREAMING_STATE_ISSUED;
+}
+
+void layman_streaming_update(struct layman_streaming *streaming, size_t budget) {
+	// Reclaim the memory of the oldest uploads the GPU is done with. Never blocks.
+	size_t retired = 0;
+	while (retired < streaming->uploads_count) {
+		struct layman_streaming_upload *upload = streaming->uploads + retired;
+		if (upload->state != LAYMAN_STREAMING_STATE_ISSUED) {
+			break;
+		}
+
+		GLenum status = glClientWaitSync(upload->fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			break;
+		}
+
+		glDeleteSync(upload->fence);
+		streaming->used -= upload->length;
+		streaming->tail = upload->end;
+		retired++;
+	}
+
+	if (retired > 0) {
+		streaming->uploads_count -= retired;
+		streaming->first_ticket += retired;
+		memmove(streaming->uploads, streaming->uploads + retired, streaming->uploads_count * sizeof *streaming->uploads);
+	}
+
+	// Issue the next uploads, in order, within the budget.
+	size_t spent = 0;
+	for (size_t i = 0; i < streaming->uploads_count; i++) {
+		struct layman_streaming_upload *upload = streaming->uploads + i;
+		if (upload->state == LAYMAN_STREAMING_STATE_ISSUED) {
+			continue;
+		}
+
+		if (upload->state == LAYMAN_STREAMING_STATE_RESERVED || (spent > 0 && spent + upload->length > budget)) {
+			break;
+		}
+
+		issue(streaming, upload);
+		spent += upload->length;
+	}
+}
@@ -1,7 +1,98 @@
 #include "layman.h"
 #include "stb_image.h"
+#include <string.h>
+
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
+
+// S3TC never made it to core OpenGL, but every desktop driver has it.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// Whether textures get compressed as they're created from images, see layman_texture_compression().
+static bool compression;
+
+// Every texture shared through layman_texture_acquire().
+static struct layman_texture **cache;
+static size_t cache_count;
+
+// Hashes 8 bytes at a time, encoded images easily weigh a few megabytes.
+// Multiply-xorshift rounds as in MurmurHash64A; this only needs to be fast and well distributed, not cryptographic.
+static uint64_t hash_bytes(uint64_t hash, const unsigned char *bytes, size_t length) {
+	const uint64_t multiplier = 0xC6A4A7935BD1E995ULL;
+
+	hash ^= length * multiplier;
+
+	size_t i = 0;
+	for (; i + sizeof (uint64_t) <= length; i += sizeof (uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof word); // Unaligned.
+
+		word *= multiplier;
+		word ^= word >> 47;
+		word *= multiplier;
+
+		hash ^= word;
+		hash *= multiplier;
+	}
+
+	// Remaining bytes.
+	for (; i < length; i++) {
+		hash = (hash ^ bytes[i]) * multiplier;
+	}
+
+	hash ^= hash >> 47;
+	hash *= multiplier;
+	hash ^= hash >> 47;
+
+	return hash;
+}
+
+// Allocates every level of every face at once.
+static void allocate(struct layman_texture *texture) {
+	// Immutable storage, the driver then never has to check the completeness of the texture again.
+	if (GLAD_GL_VERSION_4_2) {
+		glTexStorage2D(texture->gl_target, texture->levels, texture->gl_internal_format, texture->width, texture->height);
+		return;
+	}
+
+	// Mac only goes up to OpenGL 4.1, every level gets specified by hand there.
+	size_t faces = texture->gl_target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+	for (size_t level = 0; level < texture->levels; level++) {
+		GLsizei width = MAX(texture->width >> level, 1);
+		GLsizei height = MAX(texture->height >> level, 1);
+
+		for (size_t face = 0; face < faces; face++) {
+			GLenum target = faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : texture->gl_target;
+			glTexImage2D(target, level, texture->gl_internal_format, width, height, 0, texture->gl_format, texture->gl_type, NULL);
+		}
+	}
+
+	glTexParameteri(texture->gl_target, GL_TEXTURE_MAX_LEVEL, texture->levels - 1);
+}
 
 struct layman_texture *layman_texture_create(enum layman_texture_kind kind, size_t width, size_t height, bool mipmapping, enum layman_texture_type type, enum layman_texture_format format, enum layman_texture_format_internal format_internal) {
+	// Automatic levels when mipmapping is enabled.
+	size_t levels = 1;
+	if (mipmapping) {
+		while ((width | height) >> levels) {
+			levels++;
+		}
+	}
+
+	return layman_texture_create_with_levels(kind, width, height, levels, type, format, format_internal);
+}
+
+struct layman_texture *layman_texture_create_with_levels(enum layman_texture_kind kind, size_t width, size_t height, size_t levels, enum layman_texture_type type, enum layman_texture_format format, enum layman_texture_format_internal format_internal) {
 	struct layman_texture *texture = malloc(sizeof *texture);
 	if (!texture) {
 		return NULL;
@@ -11,14 +102,13 @@ struct layman_texture *layman_texture_create(enum layman_texture_kind kind, size
 	texture->kind = kind;
 	texture->width = width;
 	texture->height = height;
-	texture->levels = 1;
-
-	// Automatic levels when mipmappign is enabled.
-	if (mipmapping) {
-		while ((width | height) >> texture->levels) {
-			texture->levels++;
-		}
-	}
+	texture->levels = levels;
+	texture->format_internal = format_internal;
+	texture->hash = 0;
+	texture->size = 0;
+	texture->context = NULL;
+	texture->references = 0;
+	texture->streaming = NULL;
 
 	// Figure out what OpenGL texture unit a given texture should be assigned to (based on its kind).
 	// This is actually the recommended way to enumerate that constant.
@@ -51,15 +141,31 @@ struct layman_texture *layman_texture_create(enum layman_texture_kind kind, size
 	}
 
 	// Translate our internal formats to OpenGL internal formats.
+	// Immutable storage only takes sized formats, the unsized ones get the usual 8 bits per channel.
 	switch (format_internal) {
-	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB: texture->gl_internal_format = GL_RGB; break;
-	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA: texture->gl_internal_format = GL_RGBA; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_R8: texture->gl_internal_format = GL_R8; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RG8: texture->gl_internal_format = GL_RG8; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB: texture->gl_internal_format = GL_RGB8; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA: texture->gl_internal_format = GL_RGBA8; break;
 	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB8: texture->gl_internal_format = GL_RGB8; break;
 	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA8: texture->gl_internal_format = GL_RGBA8; break;
 	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB16F: texture->gl_internal_format = GL_RGB16F; break;
 	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA16F: texture->gl_internal_format = GL_RGBA16F; break;
 	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGB32F: texture->gl_internal_format = GL_RGB32F; break;
 	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA32F: texture->gl_internal_format = GL_RGBA32F; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_SRGB8: texture->gl_internal_format = GL_SRGB8; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_SRGB8_ALPHA8: texture->gl_internal_format = GL_SRGB8_ALPHA8; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1: texture->gl_internal_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3: texture->gl_internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4: texture->gl_internal_format = GL_COMPRESSED_RED_RGTC1; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC5: texture->gl_internal_format = GL_COMPRESSED_RG_RGTC2; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC7: texture->gl_internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB: texture->gl_internal_format = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3_SRGB: texture->gl_internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_BC7_SRGB: texture->gl_internal_format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+	    case LAYMAN_TEXTURE_FORMAT_INTERNAL_COUNT:
+		    free(texture);
+		    return NULL;
 	}
 
 	glGenTextures(1, &texture->gl_id);
@@ -67,16 +173,23 @@ struct layman_texture *layman_texture_create(enum layman_texture_kind kind, size
 	layman_texture_switch(texture);
 
 	// Pre-allocate the storage for the pixel data.
-	layman_texture_provide_data(texture, 0, width, height, NULL);
+	allocate(texture);
 
 	// Wrapping.
 	// glTexParameteri(texture->gl_target, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	// glTexParameteri(texture->gl_target, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
+	// Cubemaps are sampled by direction, their edges must never wrap to the opposite side of a face.
+	if (texture->gl_target == GL_TEXTURE_CUBE_MAP) {
+		glTexParameteri(texture->gl_target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(texture->gl_target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(texture->gl_target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+
 	// Filtering.
 	// `NEAREST` is generally faster than `LINEAR`, but it can produce textured images with sharper edges
 	// because the transition between texture elements is not as smooth.
-	glTexParameteri(texture->gl_target, GL_TEXTURE_MIN_FILTER, mipmapping ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(texture->gl_target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(texture->gl_target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	// Anisotropic filtering.
@@ -91,6 +204,10 @@ void layman_texture_destroy(struct layman_texture *texture) {
 		return;
 	}
 
+	if (texture->streaming) {
+		layman_streaming_cancel(texture->streaming, texture);
+	}
+
 	glDeleteTextures(1, &texture->gl_id);
 	free(texture);
 }
@@ -127,38 +244,340 @@ struct layman_texture *layman_texture_create_from_file(enum layman_texture_kind
 	return NULL;
 }
 
-struct layman_texture *layman_texture_create_from_memory(enum layman_texture_kind kind, const unsigned char *data, size_t size) {
+// Grayscale images get expanded to RGB, and RGBA when they have an alpha channel, the way glTF reads them.
+// Only then can any kind of texture, packed or compressed, be made from them.
+static int expanded_components(int components) {
+	switch (components) {
+	    case 1: return 3;
+	    case 2: return 4;
+	    default: return components;
+	}
+}
+
+bool layman_image_stage(struct layman_image *image, struct layman_streaming *streaming, const unsigned char *data, size_t size) {
 	int width, height, components;
+	if (!stbi_info_from_memory(data, size, &width, &height, &components)) {
+		return false;
+	}
 
-	unsigned char *decoded = stbi_load_from_memory(data, size, &width, &height, &components, 0);
+	components = expanded_components(components);
+
+	uint64_t ticket;
+	unsigned char *staging = layman_streaming_reserve(streaming, (size_t) width * height * components, &ticket);
+	if (!staging) {
+		return false;
+	}
+
+	image->width = width;
+	image->height = height;
+	image->components = components;
+	image->streaming = streaming;
+	image->staging = staging;
+	image->ticket = ticket;
+
+	return true;
+}
+
+bool layman_image_decode(struct layman_image *image, const unsigned char *data, size_t size) {
+	int width, height, components, stored;
+	if (!stbi_info_from_memory(data, size, &width, &height, &stored)) {
+		return false;
+	}
+
+	components = expanded_components(stored);
+	unsigned char *decoded = stbi_load_from_memory(data, size, &width, &height, &stored, components);
 	if (!decoded) {
+		return false;
+	}
+
+	if (!image->staging) {
+		image->pixels = decoded;
+		image->width = width;
+		image->height = height;
+		image->components = components;
+		return true;
+	}
+
+	// stb_image always decodes into memory of its own, the pixels get moved to the staging memory in one go.
+	// The header promised a size, the pixels can't be trusted if it lied.
+	bool matching = width == image->width && height == image->height && components == image->components;
+	if (matching) {
+		memcpy(image->staging, decoded, (size_t) width * height * components);
+		image->pixels = image->staging;
+	}
+
+	stbi_image_free(decoded);
+
+	return matching;
+}
+
+void layman_image_free(struct layman_image *image) {
+	if (image->streaming) {
+		layman_streaming_discard(image->streaming, image->ticket);
+	} else {
+		stbi_image_free(image->pixels);
+	}
+
+	image->pixels = NULL;
+	image->streaming = NULL;
+	image->staging = NULL;
+}
+
+void layman_texture_compression(bool enabled) {
+	compression = enabled;
+}
+
+// Whether a kind of texture survives compression.
+// Metallic and roughness would bleed into each other, they're left uncompressed.
+static bool compressible(enum layman_texture_kind kind) {
+	switch (kind) {
+	    case LAYMAN_TEXTURE_KIND_ALBEDO:
+	    case LAYMAN_TEXTURE_KIND_EMISSION:
+	    case LAYMAN_TEXTURE_KIND_NORMAL:
+	    case LAYMAN_TEXTURE_KIND_OCCLUSION:
+		    return true;
+	    default:
+		    return false;
+	}
+}
+
+bool layman_texture_compressed(enum layman_texture_kind kind) {
+	if (!compression || !compressible(kind)) {
+		return false;
+	}
+
+	// BC4 and BC5 are core since OpenGL 3.0, BC1 and BC3 aren't.
+	if (kind == LAYMAN_TEXTURE_KIND_ALBEDO || kind == LAYMAN_TEXTURE_KIND_EMISSION) {
+		return glfwExtensionSupported("GL_EXT_texture_compression_s3tc") == GLFW_TRUE;
+	}
+
+	return true;
+}
+
+// Picks the block format of an image for a kind of texture.
+static enum layman_texture_format_internal compressed_format(enum layman_texture_kind kind, const struct layman_image *image) {
+	switch (kind) {
+	    case LAYMAN_TEXTURE_KIND_NORMAL:
+		    // Unit vectors, the shader rebuilds Z from X and Y.
+		    return LAYMAN_TEXTURE_FORMAT_INTERNAL_BC5;
+	    case LAYMAN_TEXTURE_KIND_OCCLUSION:
+		    // Only red is read.
+		    return LAYMAN_TEXTURE_FORMAT_INTERNAL_BC4;
+	    default:
+		    break;
+	}
+
+	// Many images carry an alpha channel they don't use, those don't need to pay for it.
+	if (image->components == 4) {
+		size_t count = (size_t) image->width * image->height;
+		for (size_t i = 0; i < count; i++) {
+			if (image->pixels[i * 4 + 3] != 255) {
+				return LAYMAN_TEXTURE_FORMAT_INTERNAL_BC3_SRGB;
+			}
+		}
+	}
+
+	return LAYMAN_TEXTURE_FORMAT_INTERNAL_BC1_SRGB;
+}
+
+// Picks the smallest uncompressed format holding what the shader reads from a kind of texture.
+// The pixels are uploaded as they are, OpenGL drops the channels the format doesn't have.
+static enum layman_texture_format_internal uncompressed_format(enum layman_texture_kind kind) {
+	switch (kind) {
+	    case LAYMAN_TEXTURE_KIND_ALBEDO:
+	    case LAYMAN_TEXTURE_KIND_EMISSION:
+		    // Linearized by the hardware when sampled, and filtered after that on most hardware.
+		    return LAYMAN_TEXTURE_FORMAT_INTERNAL_SRGB8_ALPHA8;
+	    case LAYMAN_TEXTURE_KIND_NORMAL:
+		    // Unit vectors, the shader rebuilds Z from X and Y.
+		    return LAYMAN_TEXTURE_FORMAT_INTERNAL_RG8;
+	    case LAYMAN_TEXTURE_KIND_OCCLUSION:
+		    // Only red is read.
+		    return LAYMAN_TEXTURE_FORMAT_INTERNAL_R8;
+	    default:
+		    return LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA8;
+	}
+}
+
+enum layman_texture_format_internal layman_texture_import_format(enum layman_texture_kind kind, const struct layman_image *image, bool compressed) {
+	return compressed && compressible(kind) ? compressed_format(kind, image) : uncompressed_format(kind);
+}
+
+size_t layman_texture_data_size(enum layman_texture_format format, enum layman_texture_format_internal format_internal, size_t width, size_t height) {
+	if (layman_compression_block_format(format_internal)) {
+		return layman_compression_size(format_internal, width, height);
+	}
+
+	return width * height * (format == LAYMAN_TEXTURE_FORMAT_RGBA ? 4 : 3);
+}
+
+// A compressed texture being uploaded level by level.
+struct compressing {
+	struct layman_texture *texture;
+	size_t components;
+	unsigned char *blocks; // Large enough for the first level.
+};
+
+static void compress_level(size_t level, const unsigned char *pixels, size_t width, size_t height, void *data) {
+	struct compressing *compressing = data;
+
+	layman_compression_encode(compressing->texture->format_internal, pixels, width, height, compressing->components, compressing->blocks);
+	layman_texture_provide_data(compressing->texture, level, width, height, compressing->blocks);
+}
+
+// Compresses every level of an image on the CPU and uploads them.
+static struct layman_texture *create_compressed(enum layman_texture_kind kind, const struct layman_image *image, enum layman_texture_format format) {
+	enum layman_texture_format_internal format_internal = compressed_format(kind, image);
+
+	unsigned char *blocks = malloc(layman_compression_size(format_internal, image->width, image->height));
+	if (!blocks) {
 		return NULL;
 	}
 
+	struct layman_texture *texture = layman_texture_create(kind, image->width, image->height, true, LAYMAN_TEXTURE_TYPE_UNSIGNED_BYTE, format, format_internal);
+	struct compressing compressing = {texture, image->components, blocks};
+	if (texture && !layman_compression_mipmap(image->pixels, image->width, image->height, image->components, texture->levels, compress_level, &compressing)) {
+		layman_texture_destroy(texture);
+		texture = NULL;
+	}
+
+	free(blocks);
+
+	return texture;
+}
+
+struct layman_texture *layman_texture_create_from_image(enum layman_texture_kind kind, const struct layman_image *image) {
 	enum layman_texture_format format;
-	switch (components) {
+	switch (image->components) {
 	    case 3: format = LAYMAN_TEXTURE_FORMAT_RGB; break;
 	    case 4: format = LAYMAN_TEXTURE_FORMAT_RGBA; break;
 	    default:
 		    fprintf(stderr, "Unsupported texture data format\n");
-		    stbi_image_free(decoded);
 		    return NULL;
 	}
 
-	struct layman_texture *texture = layman_texture_create(kind, width, height, true, LAYMAN_TEXTURE_TYPE_UNSIGNED_BYTE, format, LAYMAN_TEXTURE_FORMAT_INTERNAL_RGBA8);
+	// Falls back to uncompressed when out of memory.
+	if (layman_texture_compressed(kind)) {
+		struct layman_texture *texture = create_compressed(kind, image, format);
+		if (texture) {
+			return texture;
+		}
+	}
+
+	struct layman_texture *texture = layman_texture_create(kind, image->width, image->height, true, LAYMAN_TEXTURE_TYPE_UNSIGNED_BYTE, format, uncompressed_format(kind));
+	if (!texture) {
+		return NULL;
+	}
+
+	// Staged pixels can only be submitted once, images shared by several textures upload the others right away.
+	if (!image->streaming || !layman_streaming_submit(image->streaming, image->ticket, texture)) {
+		layman_texture_provide_data(texture, 0, image->width, image->height, image->pixels);
+	}
+
+	return texture;
+}
+
+struct layman_texture *layman_texture_create_from_levels(enum layman_texture_kind kind, size_t width, size_t height, size_t levels, enum layman_texture_format format, enum layman_texture_format_internal format_internal, const unsigned char *data) {
+	struct layman_texture *texture = layman_texture_create_with_levels(kind, width, height, levels, LAYMAN_TEXTURE_TYPE_UNSIGNED_BYTE, format, format_internal);
 	if (!texture) {
-		stbi_image_free(decoded);
 		return NULL;
 	}
 
-	layman_texture_provide_data(texture, 0, width, height, decoded);
+	// Rows are tightly packed, whatever their width.
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (unsigned int level = 0; level < levels; level++) {
+		layman_texture_provide_face_data(texture, 0, level, data);
+		data += layman_texture_data_size(format, format_internal, layman_texture_level_width(texture, level), layman_texture_level_height(texture, level));
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return texture;
+}
+
+struct layman_texture *layman_texture_create_from_memory(enum layman_texture_kind kind, const unsigned char *data, size_t size) {
+	struct layman_image image = {0};
+	if (!layman_image_decode(&image, data, size)) {
+		return NULL;
+	}
+
+	struct layman_texture *texture = layman_texture_create_from_image(kind, &image);
 
 	// Cleanup.
-	stbi_image_free(decoded);
+	layman_image_free(&image);
 
 	return texture;
 }
 
+// Finds a texture shared through layman_texture_acquire() in the current context.
+static struct layman_texture *find(enum layman_texture_kind kind, uint64_t hash, size_t size) {
+	// Contexts don't share their objects, each one gets its own textures.
+	const void *context = glfwGetCurrentContext();
+
+	for (size_t i = 0; i < cache_count; i++) {
+		struct layman_texture *texture = cache[i];
+		if (texture->hash == hash && texture->size == size && texture->kind == kind && texture->compressed == layman_texture_compressed(kind) && texture->context == context) {
+			return texture;
+		}
+	}
+
+	return NULL;
+}
+
+bool layman_texture_cached(enum layman_texture_kind kind, const unsigned char *data, size_t size) {
+	return find(kind, hash_bytes(kind, data, size), size) != NULL;
+}
+
+struct layman_texture *layman_texture_acquire(enum layman_texture_kind kind, const unsigned char *data, size_t size, const struct layman_image *decoded) {
+	uint64_t hash = hash_bytes(kind, data, size);
+
+	struct layman_texture *texture = find(kind, hash, size);
+	if (texture) {
+		texture->references++;
+		return texture;
+	}
+
+	struct layman_texture **new_cache = realloc(cache, (cache_count + 1) * sizeof *cache);
+	if (!new_cache) {
+		return NULL;
+	}
+
+	cache = new_cache;
+
+	texture = decoded ? layman_texture_create_from_image(kind, decoded) : layman_texture_create_from_memory(kind, data, size);
+	if (!texture) {
+		return NULL;
+	}
+
+	texture->hash = hash;
+	texture->size = size;
+	texture->compressed = layman_texture_compressed(kind);
+	texture->context = glfwGetCurrentContext();
+	texture->references = 1;
+
+	cache[cache_count] = texture;
+	cache_count++;
+
+	return texture;
+}
+
+void layman_texture_release(struct layman_texture *texture) {
+	if (!texture || --texture->references > 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < cache_count; i++) {
+		if (cache[i] == texture) {
+			cache[i] = cache[cache_count - 1];
+			cache_count--;
+			break;
+		}
+	}
+
+	layman_texture_destroy(texture);
+}
+
 void layman_texture_switch(const struct layman_texture *new) {
 	thread_local static const struct layman_texture *current;
 
@@ -177,7 +596,13 @@ void layman_texture_switch(const struct layman_texture *new) {
 void layman_texture_provide_data(struct layman_texture *texture, unsigned int level, unsigned int width, unsigned int height, const void *data) {
 	layman_texture_switch(texture);
 
-	glTexImage2D(texture->gl_target, level, texture->gl_internal_format, width, height, 0, texture->gl_format, texture->gl_type, data);
+	// Compressed levels are all provided one by one, the driver can't generate them.
+	if (layman_compression_block_format(texture->format_internal)) {
+		glCompressedTexSubImage2D(texture->gl_target, level, 0, 0, width, height, texture->gl_internal_format, layman_compression_size(texture->format_internal, width, height), data);
+		return;
+	}
+
+	glTexSubImage2D(texture->gl_target, level, 0, 0, width, height, texture->gl_format, texture->gl_type, data);
 
 	// Mimapping.
 	if (level == 0 && texture->levels > 1) {
@@ -185,6 +610,60 @@ void layman_texture_provide_data(struct layman_texture *texture, unsigned int le
 	}
 }
 
+void layman_texture_provide_face_data(struct layman_texture *texture, unsigned int face, unsigned int level, const void *data) {
+	layman_texture_switch(texture);
+
+	GLenum target = texture->gl_target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : texture->gl_target;
+	size_t width = layman_texture_level_width(texture, level);
+	size_t height = layman_texture_level_height(texture, level);
+
+	if (layman_compression_block_format(texture->format_internal)) {
+		glCompressedTexSubImage2D(target, level, 0, 0, width, height, texture->gl_internal_format, layman_compression_size(texture->format_internal, width, height), data);
+	} else {
+		glTexSubImage2D(target, level, 0, 0, width, height, texture->gl_format, texture->gl_type, data);
+	}
+}
+
+void layman_texture_provide_placeholder(struct layman_texture *texture) {
+	// What the material would look like without the texture.
+	unsigned char texel[4] = {255, 255, 255, 255};
+	if (texture->kind == LAYMAN_TEXTURE_KIND_NORMAL) {
+		texel[0] = 128;
+		texel[1] = 128;
+	}
+
+	unsigned int level = texture->levels - 1;
+	size_t width = layman_texture_level_width(texture, level);
+	size_t height = layman_texture_level_height(texture, level);
+	size_t components = texture->gl_format == GL_RGBA ? 4 : 3;
+
+	unsigned char *pixels = malloc(width * height * components);
+	if (!pixels) {
+		return;
+	}
+
+	for (size_t i = 0; i < width * height; i++) {
+		memcpy(pixels + i * components, texel, components);
+	}
+
+	layman_texture_switch(texture);
+	glTexParameteri(texture->gl_target, GL_TEXTURE_BASE_LEVEL, level);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(texture->gl_target, level, 0, 0, width, height, texture->gl_format, texture->gl_type, pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	free(pixels);
+}
+
+size_t layman_texture_level_width(const struct layman_texture *texture, unsigned int level) {
+	return MAX(texture->width >> level, 1);
+}
+
+size_t layman_texture_level_height(const struct layman_texture *texture, unsigned int level) {
+	return MAX(texture->height >> level, 1);
+}
+
 void layman_texture_anisotropic_filtering(struct layman_texture *texture, float anisotropy) {
 	// Ensure the driver supports the anisotropic extension before we attempt to do anything.
 	if (glfwExtensionSupported("GL_EXT_texture_filter_anisotropic") == GLFW_FALSE) {
@@ -198,8 +677,8 @@ void layman_texture_anisotropic_filtering(struct layman_texture *texture, float
 	glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_anisotropy);
 
 	if (anisotropy <= max_anisotropy) {
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+		glTexParameterf(texture->gl_target, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
 	} else {
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, max_anisotropy);
+		glTexParameterf(texture->gl_target, GL_TEXTURE_MAX_ANISOTROPY_EXT, max_anisotropy);
 	}
 }
@@ -0,0 +1,459 @@
+#include "layman.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define USE_SSE
+#endif
+
+#define TRANSFORMS_CAPACITY_STEP 256 // Must be a multiple of 4.
+
+static struct layman_transforms transforms;
+
+static void reset_slot(size_t slot) {
+	transforms.translation_x[slot] = 0;
+	transforms.translation_y[slot] = 0;
+	transforms.translation_z[slot] = 0;
+	transforms.rotation_x[slot] = 0;
+	transforms.rotation_y[slot] = 0;
+	transforms.rotation_z[slot] = 0;
+	transforms.rotation_w[slot] = 1;
+	transforms.scale_x[slot] = 1;
+	transforms.scale_y[slot] = 1;
+	transforms.scale_z[slot] = 1;
+	transforms.parents[slot] = LAYMAN_TRANSFORM_NONE;
+	transforms.dirty[slot] = 0;
+	glm_mat4_identity(transforms.world_matrices[slot]);
+	glm_mat4_identity(transforms.normal_matrices[slot]);
+}
+
+static void copy_slot(size_t destination, size_t source) {
+	transforms.translation_x[destination] = transforms.translation_x[source];
+	transforms.translation_y[destination] = transforms.translation_y[source];
+	transforms.translation_z[destination] = transforms.translation_z[source];
+	transforms.rotation_x[destination] = transforms.rotation_x[source];
+	transforms.rotation_y[destination] = transforms.rotation_y[source];
+	transforms.rotation_z[destination] = transforms.rotation_z[source];
+	transforms.rotation_w[destination] = transforms.rotation_w[source];
+	transforms.scale_x[destination] = transforms.scale_x[source];
+	transforms.scale_y[destination] = transforms.scale_y[source];
+	transforms.scale_z[destination] = transforms.scale_z[source];
+	transforms.parents[destination] = transforms.parents[source];
+	transforms.dirty[destination] = transforms.dirty[source];
+	glm_mat4_copy(transforms.world_matrices[source], transforms.world_matrices[destination]);
+	glm_mat4_copy(transforms.normal_matrices[source], transforms.normal_matrices[destination]);
+	transforms.handles[destination] = transforms.handles[source];
+}
+
+static bool grow(void) {
+	size_t new_capacity = transforms.capacity + TRANSFORMS_CAPACITY_STEP;
+
+	// Each array is committed as soon as it's reallocated, so that a failure midway leaves nothing dangling.
+	#define GROW(array) do { \
+		void *new_array = realloc(transforms.array, new_capacity * sizeof *transforms.array); \
+		if (!new_array) { \
+			return false; \
+		} \
+		transforms.array = new_array; \
+	} while (0)
+
+	GROW(translation_x);
+	GROW(translation_y);
+	GROW(translation_z);
+	GROW(rotation_x);
+	GROW(rotation_y);
+	GROW(rotation_z);
+	GROW(rotation_w);
+	GROW(scale_x);
+	GROW(scale_y);
+	GROW(scale_z);
+	GROW(parents);
+	GROW(dirty);
+	GROW(world_matrices);
+	GROW(normal_matrices);
+	GROW(handles);
+	GROW(slots);
+
+	#undef GROW
+
+	for (size_t i = transforms.capacity; i < new_capacity; i++) {
+		reset_slot(i);
+	}
+
+	transforms.capacity = new_capacity;
+
+	return true;
+}
+
+static bool valid(uint32_t transform) {
+	return transform < transforms.handles_count && transforms.slots[transform] != LAYMAN_TRANSFORM_NONE;
+}
+
+static void mark_dirty(size_t slot) {
+	transforms.dirty[slot] = 1;
+	transforms.any_dirty = true;
+}
+
+uint32_t layman_transform_create(void) {
+	if (transforms.count == transforms.capacity && !grow()) {
+		return LAYMAN_TRANSFORM_NONE;
+	}
+
+	// Reuse the handle of a destroyed transform when there's one.
+	uint32_t handle = 0;
+	if (transforms.handles_count > transforms.count) {
+		while (transforms.slots[handle] != LAYMAN_TRANSFORM_NONE) {
+			handle++;
+		}
+	} else {
+		handle = transforms.handles_count++;
+	}
+
+	size_t slot = transforms.count++;
+	reset_slot(slot);
+	mark_dirty(slot);
+
+	transforms.handles[slot] = handle;
+	transforms.slots[handle] = slot;
+
+	return handle;
+}
+
+void layman_transform_destroy(uint32_t transform) {
+	if (!valid(transform)) {
+		return;
+	}
+
+	size_t slot = transforms.slots[transform];
+	size_t last = transforms.count - 1;
+
+	// Fill the hole with the last slot, which might now come before its parent.
+	if (slot != last) {
+		copy_slot(slot, last);
+		transforms.slots[transforms.handles[slot]] = slot;
+		transforms.order_outdated = true;
+	}
+
+	reset_slot(last);
+	transforms.slots[transform] = LAYMAN_TRANSFORM_NONE;
+	transforms.count--;
+
+	for (size_t i = 0; i < transforms.count; i++) {
+		if (transforms.parents[i] == transform) {
+			transforms.parents[i] = LAYMAN_TRANSFORM_NONE;
+			mark_dirty(i);
+		}
+	}
+}
+
+void layman_transform_set_translation(uint32_t transform, const vec3 translation) {
+	if (!valid(transform)) {
+		return;
+	}
+
+	size_t slot = transforms.slots[transform];
+
+	transforms.translation_x[slot] = translation[0];
+	transforms.translation_y[slot] = translation[1];
+	transforms.translation_z[slot] = translation[2];
+	mark_dirty(slot);
+}
+
+void layman_transform_set_rotation(uint32_t transform, const versor rotation) {
+	if (!valid(transform)) {
+		return;
+	}
+
+	size_t slot = transforms.slots[transform];
+
+	transforms.rotation_x[slot] = rotation[0];
+	transforms.rotation_y[slot] = rotation[1];
+	transforms.rotation_z[slot] = rotation[2];
+	transforms.rotation_w[slot] = rotation[3];
+	mark_dirty(slot);
+}
+
+void layman_transform_set_scale(uint32_t transform, const vec3 scale) {
+	if (!valid(transform)) {
+		return;
+	}
+
+	size_t slot = transforms.slots[transform];
+
+	transforms.scale_x[slot] = scale[0];
+	transforms.scale_y[slot] = scale[1];
+	transforms.scale_z[slot] = scale[2];
+	mark_dirty(slot);
+}
+
+bool layman_transform_set_parent(uint32_t transform, uint32_t parent) {
+	if (!valid(transform) || (parent != LAYMAN_TRANSFORM_NONE && !valid(parent))) {
+		return false;
+	}
+
+	for (uint32_t ancestor = parent; ancestor != LAYMAN_TRANSFORM_NONE; ancestor = transforms.parents[transforms.slots[ancestor]]) {
+		if (ancestor == transform) {
+			return false;
+		}
+	}
+
+	size_t slot = transforms.slots[transform];
+
+	transforms.parents[slot] = parent;
+	if (parent != LAYMAN_TRANSFORM_NONE && transforms.slots[parent] > slot) {
+		transforms.order_outdated = true;
+	}
+
+	mark_dirty(slot);
+
+	return true;
+}
+
+// Moves every array around such that the slot `order[i]` ends up at `i`.
+static void permute(void *array, size_t size, const uint32_t *order, void *scratch) {
+	for (size_t i = 0; i < transforms.count; i++) {
+		memcpy((char *) scratch + i * size, (char *) array + order[i] * size, size);
+	}
+
+	memcpy(array, scratch, transforms.count * size);
+}
+
+// Sorts the slots by depth in the hierarchy, which puts every parent before its children.
+static bool sort(void) {
+	uint32_t *depths = malloc(transforms.count * sizeof *depths);
+	uint32_t *offsets = calloc(transforms.count + 1, sizeof *offsets);
+	uint32_t *order = malloc(transforms.count * sizeof *order);
+	void *scratch = malloc(transforms.count * sizeof *transforms.world_matrices);
+
+	if (!depths || !offsets || !order || !scratch) {
+		free(depths);
+		free(offsets);
+		free(order);
+		free(scratch);
+		return false;
+	}
+
+	// Counting sort, stable so that siblings keep their relative order.
+	for (size_t i = 0; i < transforms.count; i++) {
+		uint32_t depth = 0;
+		for (uint32_t parent = transforms.parents[i]; parent != LAYMAN_TRANSFORM_NONE; parent = transforms.parents[transforms.slots[parent]]) {
+			depth++;
+		}
+
+		depths[i] = depth;
+		offsets[depth + 1]++;
+	}
+
+	for (size_t depth = 1; depth <= transforms.count; depth++) {
+		offsets[depth] += offsets[depth - 1];
+	}
+
+	for (size_t i = 0; i < transforms.count; i++) {
+		order[offsets[depths[i]]++] = i;
+	}
+
+	#define PERMUTE(array) permute(transforms.array, sizeof *transforms.array, order, scratch)
+
+	PERMUTE(translation_x);
+	PERMUTE(translation_y);
+	PERMUTE(translation_z);
+	PERMUTE(rotation_x);
+	PERMUTE(rotation_y);
+	PERMUTE(rotation_z);
+	PERMUTE(rotation_w);
+	PERMUTE(scale_x);
+	PERMUTE(scale_y);
+	PERMUTE(scale_z);
+	PERMUTE(parents);
+	PERMUTE(dirty);
+	PERMUTE(world_matrices);
+	PERMUTE(normal_matrices);
+	PERMUTE(handles);
+
+	#undef PERMUTE
+
+	for (size_t i = 0; i < transforms.count; i++) {
+		transforms.slots[transforms.handles[i]] = i;
+	}
+
+	free(depths);
+	free(offsets);
+	free(order);
+	free(scratch);
+
+	return true;
+}
+
+// Builds a local matrix from the rotation and scale columns and the translation.
+static void assign_local(mat4 matrix, const float columns[9], float x, float y, float z) {
+	glm_vec4_copy((vec4) { columns[0], columns[1], columns[2], 0}, matrix[0]);
+	glm_vec4_copy((vec4) { columns[3], columns[4], columns[5], 0}, matrix[1]);
+	glm_vec4_copy((vec4) { columns[6], columns[7], columns[8], 0}, matrix[2]);
+	glm_vec4_copy((vec4) { x, y, z, 1}, matrix[3]);
+}
+
+// Computes the local matrices of the dirty slots and writes them where their world matrices go.
+static void compute_locals(void) {
+	#ifdef USE_SSE
+	const __m128 one = _mm_set1_ps(1);
+	const __m128 two = _mm_set1_ps(2);
+
+	for (size_t i = 0; i < transforms.count; i += 4) {
+		// The dirty flags are padded with zeros as well.
+		uint32_t block_dirty;
+		memcpy(&block_dirty, transforms.dirty + i, sizeof block_dirty);
+		if (!block_dirty) {
+			continue;
+		}
+
+		__m128 x = _mm_loadu_ps(transforms.rotation_x + i);
+		__m128 y = _mm_loadu_ps(transforms.rotation_y + i);
+		__m128 z = _mm_loadu_ps(transforms.rotation_z + i);
+		__m128 w = _mm_loadu_ps(transforms.rotation_w + i);
+		__m128 scale_x = _mm_loadu_ps(transforms.scale_x + i);
+		__m128 scale_y = _mm_loadu_ps(transforms.scale_y + i);
+		__m128 scale_z = _mm_loadu_ps(transforms.scale_z + i);
+
+		__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+		// Rotation matrix of a unit quaternion, with every column scaled.
+		__m128 columns[9] = {
+			_mm_mul_ps(scale_x, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)))),
+			_mm_mul_ps(scale_x, _mm_mul_ps(two, _mm_add_ps(xy, wz))),
+			_mm_mul_ps(scale_x, _mm_mul_ps(two, _mm_sub_ps(xz, wy))),
+			_mm_mul_ps(scale_y, _mm_mul_ps(two, _mm_sub_ps(xy, wz))),
+			_mm_mul_ps(scale_y, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)))),
+			_mm_mul_ps(scale_y, _mm_mul_ps(two, _mm_add_ps(yz, wx))),
+			_mm_mul_ps(scale_z, _mm_mul_ps(two, _mm_add_ps(xz, wy))),
+			_mm_mul_ps(scale_z, _mm_mul_ps(two, _mm_sub_ps(yz, wx))),
+			_mm_mul_ps(scale_z, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))),
+		};
+
+		float lanes[9][4];
+		for (size_t c = 0; c < 9; c++) {
+			_mm_storeu_ps(lanes[c], columns[c]);
+		}
+
+		for (size_t lane = 0; lane < 4 && i + lane < transforms.count; lane++) {
+			size_t slot = i + lane;
+			if (!transforms.dirty[slot]) {
+				continue;
+			}
+
+			float local[9];
+			for (size_t c = 0; c < 9; c++) {
+				local[c] = lanes[c][lane];
+			}
+
+			assign_local(transforms.world_matrices[slot], local, transforms.translation_x[slot], transforms.translation_y[slot], transforms.translation_z[slot]);
+		}
+	}
+	#else
+	for (size_t i = 0; i < transforms.count; i++) {
+		if (!transforms.dirty[i]) {
+			continue;
+		}
+
+		float x = transforms.rotation_x[i], y = transforms.rotation_y[i], z = transforms.rotation_z[i], w = transforms.rotation_w[i];
+		float scale_x = transforms.scale_x[i], scale_y = transforms.scale_y[i], scale_z = transforms.scale_z[i];
+
+		float local[9] = {
+			scale_x * (1 - 2 * (y * y + z * z)),
+			scale_x * 2 * (x * y + w * z),
+			scale_x * 2 * (x * z - w * y),
+			scale_y * 2 * (x * y - w * z),
+			scale_y * (1 - 2 * (x * x + z * z)),
+			scale_y * 2 * (y * z + w * x),
+			scale_z * 2 * (x * z + w * y),
+			scale_z * 2 * (y * z - w * x),
+			scale_z * (1 - 2 * (x * x + y * y)),
+		};
+
+		assign_local(transforms.world_matrices[i], local, transforms.translation_x[i], transforms.translation_y[i], transforms.translation_z[i]);
+	}
+	#endif
+}
+
+// The inverse transpose of the upper 3x3 part of a matrix, up to a positive factor.
+static void compute_normal_matrix(mat4 world_matrix, mat4 normal_matrix) {
+	vec3 columns[3];
+
+	// Cofactors, which equal the inverse transpose multiplied by the determinant. Dividing by its magnitude is useless
+	// since the shaders renormalize anyway, but its sign must be kept for the normals of mirrored transforms.
+	glm_vec3_cross(world_matrix[1], world_matrix[2], columns[0]);
+	glm_vec3_cross(world_matrix[2], world_matrix[0], columns[1]);
+	glm_vec3_cross(world_matrix[0], world_matrix[1], columns[2]);
+
+	float sign = glm_vec3_dot(world_matrix[0], columns[0]) < 0 ? -1 : 1;
+
+	glm_mat4_identity(normal_matrix);
+	for (size_t c = 0; c < 3; c++) {
+		glm_vec3_scale(columns[c], sign, normal_matrix[c]);
+	}
+}
+
+uint64_t layman_transforms_update(void) {
+	if (transforms.order_outdated) {
+		if (sort()) {
+			transforms.order_outdated = false;
+		} else {
+			fprintf(stderr, "Unable to sort the transforms\n");
+		}
+	}
+
+	if (!transforms.any_dirty) {
+		return transforms.generation;
+	}
+
+	// Propagate the changes to the descendants, all in one pass since parents come first.
+	for (size_t i = 0; i < transforms.count; i++) {
+		uint32_t parent = transforms.parents[i];
+		if (parent != LAYMAN_TRANSFORM_NONE && transforms.dirty[transforms.slots[parent]]) {
+			transforms.dirty[i] = 1;
+		}
+	}
+
+	compute_locals();
+
+	// Compose with the parents, whose world matrices are already final.
+	for (size_t i = 0; i < transforms.count; i++) {
+		uint32_t parent = transforms.parents[i];
+		if (!transforms.dirty[i] || parent == LAYMAN_TRANSFORM_NONE) {
+			continue;
+		}
+
+		mat4 world_matrix;
+		glm_mat4_mul(transforms.world_matrices[transforms.slots[parent]], transforms.world_matrices[i], world_matrix);
+		glm_mat4_copy(world_matrix, transforms.world_matrices[i]);
+	}
+
+	for (size_t i = 0; i < transforms.count; i++) {
+		if (transforms.dirty[i]) {
+			compute_normal_matrix(transforms.world_matrices[i], transforms.normal_matrices[i]);
+			transforms.dirty[i] = 0;
+		}
+	}
+
+	transforms.any_dirty = false;
+
+	return ++transforms.generation;
+}
+
+void layman_transform_world_matrix(uint32_t transform, mat4 world_matrix) {
+	if (!valid(transform)) {
+		glm_mat4_identity(world_matrix);
+		return;
+	}
+
+	glm_mat4_copy(transforms.world_matrices[transforms.slots[transform]], world_matrix);
+}
+
+void layman_transform_normal_matrix(uint32_t transform, mat4 normal_matrix) {
+	if (!valid(transform)) {
+		glm_mat4_identity(normal_matrix);
+		return;
+	}
+
+	glm_mat4_copy(transforms.normal_matrices[transforms.slots[transform]], normal_matrix);
+}
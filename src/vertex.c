@@ -0,0 +1,251 @@
+#include "layman.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Past this, half floats step by more than 1/1024, a texel of a 1024 pixels texture.
+#define HALF_UVS_RANGE 2.0f
+
+// Floats per attribute, as they come in.
+static const GLint components[LAYMAN_VERTEX_ATTRIBUTES] = {
+	[LAYMAN_MESH_ATTRIBUTE_POSITION] = 3,
+	[LAYMAN_MESH_ATTRIBUTE_UV] = 2,
+	[LAYMAN_MESH_ATTRIBUTE_NORMAL] = 3,
+	[LAYMAN_MESH_ATTRIBUTE_TANGENT] = 4,
+};
+
+// How each encoding is fed to the vertex shader.
+static const struct {
+	GLenum type;
+	GLboolean normalized;
+	size_t component_size;
+	GLint components; // Zero for as many as the attribute has.
+} encodings[] = {
+	[LAYMAN_VERTEX_ENCODING_FLOAT] = {GL_FLOAT, false, 4, 0},
+	[LAYMAN_VERTEX_ENCODING_HALF] = {GL_HALF_FLOAT, false, 2, 0},
+	[LAYMAN_VERTEX_ENCODING_UNORM16] = {GL_UNSIGNED_SHORT, true, 2, 0},
+	[LAYMAN_VERTEX_ENCODING_OCTAHEDRAL] = {GL_SHORT, true, 2, 2},
+	[LAYMAN_VERTEX_ENCODING_SNORM8] = {GL_BYTE, true, 1, 4},
+};
+
+// Bits of the encodings each attribute can be stored in.
+static const unsigned int supported[LAYMAN_VERTEX_ATTRIBUTES] = {
+	[LAYMAN_MESH_ATTRIBUTE_POSITION] = 1 << LAYMAN_VERTEX_ENCODING_FLOAT,
+	[LAYMAN_MESH_ATTRIBUTE_UV] = 1 << LAYMAN_VERTEX_ENCODING_FLOAT | 1 << LAYMAN_VERTEX_ENCODING_HALF | 1 << LAYMAN_VERTEX_ENCODING_UNORM16,
+	[LAYMAN_MESH_ATTRIBUTE_NORMAL] = 1 << LAYMAN_VERTEX_ENCODING_FLOAT | 1 << LAYMAN_VERTEX_ENCODING_OCTAHEDRAL,
+	[LAYMAN_MESH_ATTRIBUTE_TANGENT] = 1 << LAYMAN_VERTEX_ENCODING_FLOAT | 1 << LAYMAN_VERTEX_ENCODING_SNORM8,
+};
+
+struct layman_vertex_format layman_vertex_format_float(unsigned int attributes) {
+	struct layman_vertex_format format = {
+		.attributes = attributes,
+		.split = false,
+	};
+
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		format.encodings[a] = LAYMAN_VERTEX_ENCODING_FLOAT;
+	}
+
+	return format;
+}
+
+struct layman_vertex_format layman_vertex_format_compact(unsigned int attributes, const float *uvs, size_t count) {
+	struct layman_vertex_format format = layman_vertex_format_float(attributes);
+	format.encodings[LAYMAN_MESH_ATTRIBUTE_NORMAL] = LAYMAN_VERTEX_ENCODING_OCTAHEDRAL;
+	format.encodings[LAYMAN_MESH_ATTRIBUTE_TANGENT] = LAYMAN_VERTEX_ENCODING_SNORM8;
+
+	if (uvs) {
+		float min = 0.0f, max = 0.0f;
+		for (size_t i = 0; i < count * 2; i++) {
+			min = uvs[i] < min ? uvs[i] : min;
+			max = uvs[i] > max ? uvs[i] : max;
+		}
+
+		if (min >= 0.0f && max <= 1.0f) {
+			format.encodings[LAYMAN_MESH_ATTRIBUTE_UV] = LAYMAN_VERTEX_ENCODING_UNORM16;
+		} else if (min >= -HALF_UVS_RANGE && max <= HALF_UVS_RANGE) {
+			format.encodings[LAYMAN_MESH_ATTRIBUTE_UV] = LAYMAN_VERTEX_ENCODING_HALF;
+		}
+	}
+
+	return format;
+}
+
+bool layman_vertex_format_valid(const struct layman_vertex_format *format) {
+	// Positions are mandatory, and there's nothing past tangents.
+	if (!((format->attributes >> LAYMAN_MESH_ATTRIBUTE_POSITION) & 1) || format->attributes >> LAYMAN_VERTEX_ATTRIBUTES) {
+		return false;
+	}
+
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		unsigned int encoding = format->encodings[a];
+		if ((format->attributes >> a) & 1 && (encoding >= ARRAY_COUNT(encodings) || !((supported[a] >> encoding) & 1))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Which stream an attribute lives in.
+static size_t stream_of(const struct layman_vertex_format *format, size_t attribute) {
+	return format->split && attribute == LAYMAN_MESH_ATTRIBUTE_POSITION ? 1 : 0;
+}
+
+static size_t attribute_size(const struct layman_vertex_format *format, size_t attribute) {
+	size_t encoding = format->encodings[attribute];
+	GLint count = encodings[encoding].components ? encodings[encoding].components : components[attribute];
+	return count * encodings[encoding].component_size;
+}
+
+size_t layman_vertex_size(const struct layman_vertex_format *format, size_t stream) {
+	size_t size = 0;
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		if ((format->attributes >> a) & 1 && stream_of(format, a) == stream) {
+			size += attribute_size(format, a);
+		}
+	}
+
+	return size;
+}
+
+// Rounds to the nearest half float, ties to even, like the GPU would.
+static uint16_t to_half(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof bits);
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	// Too large, infinite or not a number.
+	if (magnitude >= 0x47800000) {
+		return sign | (magnitude > 0x7F800000 ? 0x7E00 : 0x7C00);
+	}
+
+	// Too small even for a subnormal.
+	if (magnitude < 0x33000000) {
+		return sign;
+	}
+
+	uint32_t half, rest, midpoint;
+	if (magnitude < 0x38800000) {
+		// Subnormal, the implicit bit of the mantissa becomes explicit.
+		uint32_t shift = 126 - (magnitude >> 23);
+		uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		half = mantissa >> shift;
+		rest = mantissa & ((1u << shift) - 1);
+		midpoint = 1u << (shift - 1);
+	} else {
+		// Normal, rebias the exponent. Rounding up may carry into it, up to infinity.
+		half = (magnitude - 0x38000000) >> 13;
+		rest = magnitude & 0x1FFF;
+		midpoint = 0x1000;
+	}
+
+	half += rest > midpoint || (rest == midpoint && (half & 1));
+	return sign | half;
+}
+
+static float clamp(float value, float min, float max) {
+	return value < min ? min : value > max ? max : value;
+}
+
+// Folds a unit vector onto an octahedron, then unfolds its lower half over the upper one to fill a square.
+// Mirrors octahedralDecode() of `shaders/pbr/main.vert`.
+static void to_octahedral(const float normal[3], int16_t out[2]) {
+	float length = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+	if (length == 0.0f) {
+		out[0] = out[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / length;
+	float y = normal[1] / length;
+	if (normal[2] < 0.0f) {
+		float folded_x = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float folded_y = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = folded_x;
+		y = folded_y;
+	}
+
+	out[0] = (int16_t) lroundf(clamp(x, -1.0f, 1.0f) * 32767.0f);
+	out[1] = (int16_t) lroundf(clamp(y, -1.0f, 1.0f) * 32767.0f);
+}
+
+static void encode_attribute(enum layman_vertex_encoding encoding, const float *values, size_t count, unsigned char *out) {
+	switch (encoding) {
+	    case LAYMAN_VERTEX_ENCODING_FLOAT:
+		    memcpy(out, values, count * sizeof (float));
+		    break;
+
+	    case LAYMAN_VERTEX_ENCODING_HALF:
+		    for (size_t c = 0; c < count; c++) {
+			    uint16_t half = to_half(values[c]);
+			    memcpy(out + c * sizeof half, &half, sizeof half);
+		    }
+		    break;
+
+	    case LAYMAN_VERTEX_ENCODING_UNORM16:
+		    for (size_t c = 0; c < count; c++) {
+			    uint16_t value = (uint16_t) lroundf(clamp(values[c], 0.0f, 1.0f) * 65535.0f);
+			    memcpy(out + c * sizeof value, &value, sizeof value);
+		    }
+		    break;
+
+	    case LAYMAN_VERTEX_ENCODING_OCTAHEDRAL: {
+		    int16_t folded[2];
+		    to_octahedral(values, folded);
+		    memcpy(out, folded, sizeof folded);
+		    break;
+	    }
+
+	    case LAYMAN_VERTEX_ENCODING_SNORM8:
+		    // Only the sign of W matters, keep it exact.
+		    for (size_t c = 0; c < 3; c++) {
+			    out[c] = (unsigned char) (int8_t) lroundf(clamp(values[c], -1.0f, 1.0f) * 127.0f);
+		    }
+		    out[3] = (unsigned char) (int8_t) (values[3] < 0.0f ? -127 : 127);
+		    break;
+	}
+}
+
+void layman_vertex_encode(const struct layman_vertex_format *format, const float *const sources[LAYMAN_VERTEX_ATTRIBUTES], size_t count, void *const streams[LAYMAN_VERTEX_STREAMS]) {
+	size_t strides[LAYMAN_VERTEX_STREAMS];
+	for (size_t s = 0; s < LAYMAN_VERTEX_STREAMS; s++) {
+		strides[s] = layman_vertex_size(format, s);
+	}
+
+	size_t offsets[LAYMAN_VERTEX_STREAMS] = {0};
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		if (!((format->attributes >> a) & 1)) {
+			continue;
+		}
+
+		size_t s = stream_of(format, a);
+		unsigned char *out = (unsigned char *) streams[s] + offsets[s];
+		for (size_t i = 0; i < count; i++) {
+			encode_attribute(format->encodings[a], sources[a] + i * components[a], components[a], out + i * strides[s]);
+		}
+
+		offsets[s] += attribute_size(format, a);
+	}
+}
+
+void layman_vertex_point(const struct layman_vertex_format *format, const GLuint buffers[LAYMAN_VERTEX_STREAMS]) {
+	size_t offsets[LAYMAN_VERTEX_STREAMS] = {0};
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		if (!((format->attributes >> a) & 1)) {
+			continue;
+		}
+
+		size_t s = stream_of(format, a);
+		size_t encoding = format->encodings[a];
+		GLint count = encodings[encoding].components ? encodings[encoding].components : components[a];
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[s]);
+		glVertexAttribPointer(a, count, encodings[encoding].type, encodings[encoding].normalized, layman_vertex_size(format, s), (const void *) offsets[s]);
+		glEnableVertexAttribArray(a);
+
+		offsets[s] += attribute_size(format, a);
+	}
+}
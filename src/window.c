@@ -7,11 +7,16 @@
 // We don't have to worry about concurrency here, since layman_window_create() and layman_window_destroy() are only allowed from the main thread.
 static int refcount = 0;
 
+// Enough for a few large textures to be in flight at once.
+#define STREAMING_SIZE (64 * 1024 * 1024)
+
 static bool increment_refcount(void) {
 	if (refcount == 0) {
 		if (glfwInit() == GLFW_FALSE) {
 			return false;
 		}
+
+		layman_parallel_start();
 	}
 
 	refcount++;
@@ -23,6 +28,7 @@ static void decrement_refcount(void) {
 	refcount--;
 
 	if (refcount == 0) {
+		layman_parallel_stop();
 		glfwTerminate();
 	}
 }
@@ -187,6 +193,12 @@ struct layman_window *layman_window_create(unsigned int width, unsigned int heig
 	// Setup OpenGL debugging.
 	setup_opengl_debugging();
 
+	// Let the driver compile shaders in the background, see layman_shader_load_from_memory_async().
+	layman_shader_setup_parallel_compile();
+
+	// Textures get streamed in when possible, see layman_renderer_streaming_budget().
+	window->streaming = layman_streaming_create(STREAMING_SIZE);
+
 	// Minimum number of monitor refreshes the driver should wait after the call to glfwSwapBuffers before actually swapping the buffers on the display.
 	// Essentially, 0 = V-Sync off, 1 = V-Sync on. Leaving this on avoids ugly tearing artifacts.
 	// It requires the OpenGL context to be effective on Windows.
@@ -207,6 +219,12 @@ void layman_window_destroy(struct layman_window *window) {
 		return;
 	}
 
+	if (window->streaming) {
+		layman_window_use(window);
+		layman_streaming_destroy(window->streaming);
+		layman_window_unuse(window);
+	}
+
 	free(window);
 	decrement_refcount();
 }
@@ -0,0 +1,682 @@
+/*
+ * Cooks glTF models into packs that layman_model_load_pack() hands straight to the GPU, see `private/layman/pack.h`.
+ *
+ * Usage: layman-cooker [--compress] [--float-vertices] [--split-positions] [--lods <count>] [--lods-ratio <ratio>]
+ *                      <model.gltf|model.glb> <model.pack>
+ *
+ * The triangles get reordered, simplified into LODs and split into meshlets, the vertices quantized and interleaved, the
+ * images decoded, mipmapped and optionally compressed, and the materials resolved; everything the loader would otherwise
+ * do on every load. How much the vertex cache gains from the new order, the triangles of each LOD and the meshlets are
+ * printed.
+ *
+ * --compress            Compresses the textures that can be, see layman_texture_compression().
+ * --float-vertices      Keeps every attribute as floats instead of the most compact encoding they fit.
+ * --split-positions     Stores the positions in a stream of their own, for passes only needing them.
+ * --lods <count>        The most LODs per mesh, the full detail included, 4 by default. 1 disables them.
+ * --lods-ratio <ratio>  Of the triangles of each LOD to the one before, 0.5 by default.
+ */
+
+#include "gltf.h"
+#include "layman.h"
+#include "layman/import.h"
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+
+struct options {
+	bool compress;
+	bool quantize;
+	bool split;
+	size_t lods;
+	float lods_ratio;
+};
+
+// Vertex cache statistics of every mesh, before and after the optimizer.
+struct report {
+	struct layman_optimizer_statistics before;
+	struct layman_optimizer_statistics after;
+	size_t lods_triangles[LAYMAN_MESH_LODS]; // Of the meshes having each LOD.
+	size_t meshlets_count;
+	size_t meshlets_triangles;
+};
+
+// The content of the pack, built in memory and written in one go.
+struct output {
+	unsigned char *data;
+	size_t size;
+	size_t capacity;
+};
+
+// Floats per attribute, by `enum layman_mesh_attribute`.
+static const size_t vertex_components[LAYMAN_VERTEX_ATTRIBUTES] = {3, 2, 3, 4};
+
+// Reserves zeroed space at the end of the pack, at the next aligned offset.
+// The returned pointer is only valid until the next allocation.
+static unsigned char *allocate(struct output *output, size_t size, uint64_t *offset) {
+	size_t start = (output->size + LAYMAN_PACK_ALIGNMENT - 1) / LAYMAN_PACK_ALIGNMENT * LAYMAN_PACK_ALIGNMENT;
+
+	if (start + size > output->capacity) {
+		size_t new_capacity = output->capacity ? 2 * output->capacity : 1 << 20;
+		while (new_capacity < start + size) {
+			new_capacity *= 2;
+		}
+
+		unsigned char *new_data = realloc(output->data, new_capacity);
+		if (!new_data) {
+			return NULL;
+		}
+
+		output->data = new_data;
+		output->capacity = new_capacity;
+	}
+
+	memset(output->data + output->size, 0, start + size - output->size);
+	output->size = start + size;
+	*offset = start;
+
+	return output->data + start;
+}
+
+static bool append(struct output *output, const void *data, size_t size, uint64_t *offset) {
+	unsigned char *destination = allocate(output, size, offset);
+	if (!destination) {
+		return false;
+	}
+
+	if (size > 0) {
+		memcpy(destination, data, size);
+	}
+
+	return true;
+}
+
+// The levels of a texture being written one after the other.
+struct texturing {
+	const struct layman_pack_texture *record;
+	size_t components;
+	unsigned char *destination; // Of the next level.
+};
+
+static void cook_level(size_t level, const unsigned char *pixels, size_t width, size_t height, void *data) {
+	(void) level;
+	struct texturing *texturing = data;
+
+	if (!layman_compression_encode(texturing->record->format_internal, pixels, width, height, texturing->components, texturing->destination)) {
+		memcpy(texturing->destination, pixels, width * height * texturing->components);
+	}
+
+	texturing->destination += layman_texture_data_size(texturing->record->format, texturing->record->format_internal, width, height);
+}
+
+// Decodes an image and writes every level of it, compressed or not, the way layman_texture_create_from_image() would
+// upload it.
+static bool cook_texture(struct output *output, const cgltf_data *gltf, const cgltf_image *image, enum layman_texture_kind kind, bool compress, struct layman_pack_texture *record) {
+	struct layman_image decoded = {0};
+	if (!layman_image_decode(&decoded, layman_import_image_data(gltf, image), image->buffer_view->size)) {
+		return false;
+	}
+
+	if (decoded.components != 3 && decoded.components != 4) {
+		layman_image_free(&decoded);
+		return false;
+	}
+
+	size_t width = decoded.width;
+	size_t height = decoded.height;
+	size_t components = decoded.components;
+
+	size_t levels = 1;
+	while ((width | height) >> levels) {
+		levels++;
+	}
+
+	record->kind = kind;
+	record->format = components == 4 ? LAYMAN_TEXTURE_FORMAT_RGBA : LAYMAN_TEXTURE_FORMAT_RGB;
+	record->format_internal = layman_texture_import_format(kind, &decoded, compress);
+	record->width = width;
+	record->height = height;
+	record->levels = levels;
+	record->size = 0;
+
+	for (size_t level = 0; level < levels; level++) {
+		size_t level_width = width >> level ? width >> level : 1;
+		size_t level_height = height >> level ? height >> level : 1;
+		record->size += layman_texture_data_size(record->format, record->format_internal, level_width, level_height);
+	}
+
+	struct texturing texturing = {record, components, allocate(output, record->size, &record->offset)};
+	bool cooked = texturing.destination && layman_compression_mipmap(decoded.pixels, width, height, components, levels, cook_level, &texturing);
+
+	layman_image_free(&decoded);
+
+	return cooked;
+}
+
+// Writes the textures of every material, each image once per kind it's used as.
+// `indices` receives the record of each image and kind pair, or `LAYMAN_PACK_NONE`.
+static bool cook_textures(struct output *output, const cgltf_data *gltf, bool compress, struct layman_pack_texture **records, uint32_t *count, uint32_t *indices) {
+	*records = calloc(gltf->images_count * LAYMAN_TEXTURE_KIND_COUNT + 1, sizeof **records);
+	if (!*records) {
+		return false;
+	}
+
+	*count = 0;
+
+	for (size_t i = 0; i < gltf->materials_count; i++) {
+		for (size_t j = 0; j < LAYMAN_IMPORT_TEXTURES; j++) {
+			enum layman_texture_kind kind = layman_import_texture_kinds[j];
+			const cgltf_image *image = layman_import_texture(gltf->materials + i, j);
+			if (!image) {
+				continue;
+			}
+
+			uint32_t *index = indices + (image - gltf->images) * LAYMAN_TEXTURE_KIND_COUNT + kind;
+			if (*index != LAYMAN_PACK_NONE) {
+				continue;
+			}
+
+			// Like the loader, materials simply go without the images that can't be decoded.
+			if (!cook_texture(output, gltf, image, kind, compress, *records + *count)) {
+				fprintf(stderr, "Skipping image %zu, it can't be decoded\n", (size_t) (image - gltf->images));
+				continue;
+			}
+
+			*index = (*count)++;
+		}
+	}
+
+	return true;
+}
+
+// Resolves the materials, followed by the default one.
+static bool cook_materials(const cgltf_data *gltf, const uint32_t *texture_indices, struct layman_pack_material **records, uint32_t *count) {
+	*count = gltf->materials_count + 1;
+	*records = calloc(*count, sizeof **records);
+	if (!*records) {
+		return false;
+	}
+
+	for (size_t i = 0; i < *count; i++) {
+		struct layman_pack_material *record = *records + i;
+
+		for (size_t j = 0; j < ARRAY_COUNT(record->textures); j++) {
+			record->textures[j] = LAYMAN_PACK_NONE;
+		}
+
+		// The default material, as made by layman_material_create().
+		if (i == gltf->materials_count) {
+			for (size_t c = 0; c < 4; c++) {
+				record->base_color_factor[c] = 1;
+			}
+			record->metallic_factor = 1;
+			record->roughness_factor = 1;
+			record->normal_scale = 1;
+			record->occlusion_strength = 1;
+			record->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE;
+			record->alpha_cutoff = 0.5f;
+			continue;
+		}
+
+		const cgltf_material *source = gltf->materials + i;
+		const cgltf_pbr_metallic_roughness *pbr = &source->pbr_metallic_roughness;
+
+		memcpy(record->base_color_factor, pbr->base_color_factor, sizeof record->base_color_factor);
+		memcpy(record->emissive_factor, source->emissive_factor, sizeof record->emissive_factor);
+		record->metallic_factor = pbr->metallic_factor;
+		record->roughness_factor = pbr->roughness_factor;
+		record->normal_scale = source->normal_texture.scale;
+		record->occlusion_strength = source->occlusion_texture.scale;
+		record->alpha_cutoff = source->alpha_cutoff;
+
+		switch (source->alpha_mode) {
+		    case cgltf_alpha_mode_opaque:
+			    record->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_OPAQUE;
+			    break;
+
+		    case cgltf_alpha_mode_mask:
+			    record->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_MASK;
+			    break;
+
+		    case cgltf_alpha_mode_blend:
+			    record->alpha_mode = LAYMAN_MATERIAL_ALPHA_MODE_BLEND;
+			    break;
+		}
+
+		record->flags = 0;
+		if (source->unlit) {
+			record->flags |= LAYMAN_PACK_MATERIAL_UNLIT;
+		}
+		if (layman_import_occlusion_packed(source)) {
+			record->flags |= LAYMAN_PACK_MATERIAL_OCCLUSION_PACKED;
+		}
+		if (source->double_sided) {
+			record->flags |= LAYMAN_PACK_MATERIAL_DOUBLE_SIDED;
+		}
+
+		for (size_t j = 0; j < LAYMAN_IMPORT_TEXTURES; j++) {
+			const cgltf_image *image = layman_import_texture(source, j);
+			if (image) {
+				record->textures[j] = texture_indices[(image - gltf->images) * LAYMAN_TEXTURE_KIND_COUNT + layman_import_texture_kinds[j]];
+			}
+		}
+	}
+
+	return true;
+}
+
+static void account(struct layman_optimizer_statistics *total, struct layman_optimizer_statistics statistics) {
+	total->triangles_count += statistics.triangles_count;
+	total->vertices_count += statistics.vertices_count;
+	total->transforms += statistics.transforms;
+}
+
+// Reorders the triangles and vertices of a primitive, see layman_optimizer_optimize().
+static bool optimize(uint32_t *indices, size_t indices_count, float *sources[LAYMAN_VERTEX_ATTRIBUTES], size_t count, struct report *report) {
+	account(&report->before, layman_optimizer_analyze(indices, indices_count, count));
+
+	uint32_t *remap = malloc(count * sizeof *remap + 1);
+	if (!remap) {
+		return false;
+	}
+
+	if (!layman_optimizer_optimize(indices, indices_count, sources[LAYMAN_MESH_ATTRIBUTE_POSITION], 0, count, remap)) {
+		free(remap);
+		return false;
+	}
+
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		if (!sources[a]) {
+			continue;
+		}
+
+		size_t size = vertex_components[a] * sizeof (float);
+		float *remapped = malloc(count * size + 1);
+		if (!remapped) {
+			free(remap);
+			return false;
+		}
+
+		layman_optimizer_remap(sources[a], size, 0, count, remap, remapped);
+		free(sources[a]);
+		sources[a] = remapped;
+	}
+
+	free(remap);
+
+	return true;
+}
+
+// Appends the LODs of a primitive to its indices, see layman_simplifier_chain().
+static void simplify(uint32_t **indices, const float *positions, const struct options *options, struct layman_pack_mesh *record, struct report *report) {
+	struct layman_mesh_lod lods[LAYMAN_MESH_LODS];
+	size_t lods_count = options->lods < ARRAY_COUNT(record->lods) ? options->lods : ARRAY_COUNT(record->lods);
+	record->lods_count = layman_simplifier_chain(indices, record->indices_count, positions, 0, record->vertices_count, lods_count, options->lods_ratio, lods);
+
+	for (size_t l = 0; l < record->lods_count; l++) {
+		record->lods[l] = (struct layman_pack_lod) {lods[l].first_index, lods[l].indices_count, lods[l].error};
+		report->lods_triangles[l] += lods[l].indices_count / 3;
+	}
+
+	record->indices_count = lods[record->lods_count - 1].first_index + lods[record->lods_count - 1].indices_count;
+}
+
+// Splits the full detail of a primitive into meshlets, see layman_meshlet_build(), then reports how the vertex cache
+// fares with the final order. Primitives are simply drawn whole when out of memory.
+static bool split(struct output *output, uint32_t *indices, const float *positions, struct layman_pack_mesh *record, struct report *report) {
+	struct layman_meshlet *meshlets = NULL;
+	size_t count = layman_meshlet_build(indices, record->lods[0].indices_count, positions, 0, record->vertices_count, &meshlets);
+
+	account(&report->after, layman_optimizer_analyze(indices, record->lods[0].indices_count, record->vertices_count));
+
+	struct layman_pack_meshlet *records = count > 0 ? (void *) allocate(output, count * sizeof *records, &record->meshlets_offset) : NULL;
+	if (count > 0 && !records) {
+		free(meshlets);
+		return false;
+	}
+
+	for (size_t m = 0; m < count; m++) {
+		records[m] = (struct layman_pack_meshlet) {
+			meshlets[m].first_index, meshlets[m].indices_count,
+			{meshlets[m].center[0], meshlets[m].center[1], meshlets[m].center[2]}, meshlets[m].radius,
+			{meshlets[m].axis[0], meshlets[m].axis[1], meshlets[m].axis[2]}, meshlets[m].cutoff,
+		};
+	}
+
+	record->meshlets_count = count;
+	report->meshlets_count += count;
+	report->meshlets_triangles += count > 0 ? record->lods[0].indices_count / 3 : 0;
+
+	free(meshlets);
+
+	return true;
+}
+
+// Optimizes, simplifies and encodes the vertices of a triangle primitive, along with its indices.
+static bool cook_vertices(struct output *output, const struct options *options, const cgltf_accessor *const accessors[LAYMAN_VERTEX_ATTRIBUTES], uint32_t **indices, struct layman_pack_mesh *record, struct report *report) {
+	size_t count = record->vertices_count;
+
+	// Every attribute as tightly packed floats, sparse accessors resolved.
+	float *sources[LAYMAN_VERTEX_ATTRIBUTES] = {0};
+	bool unpacked = true;
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES && unpacked; a++) {
+		if (!((record->attributes >> a) & 1)) {
+			continue;
+		}
+
+		size_t floats_count = count * vertex_components[a];
+		sources[a] = malloc(floats_count * sizeof (float));
+		unpacked = sources[a] && cgltf_accessor_unpack_floats(accessors[a], sources[a], floats_count) == floats_count;
+	}
+
+	if (unpacked) {
+		unpacked = optimize(*indices, record->indices_count, sources, count, report);
+	}
+
+	if (unpacked) {
+		const float *positions = sources[LAYMAN_MESH_ATTRIBUTE_POSITION];
+		simplify(indices, positions, options, record, report);
+		unpacked = split(output, *indices, positions, record, report);
+	}
+
+	if (unpacked) {
+		layman_mesh_positions_bounds(sources[LAYMAN_MESH_ATTRIBUTE_POSITION], count, 0, record->aabb_min, record->aabb_max);
+
+		struct layman_vertex_format format = options->quantize
+			? layman_vertex_format_compact(record->attributes, sources[LAYMAN_MESH_ATTRIBUTE_UV], count)
+			: layman_vertex_format_float(record->attributes);
+		format.split = options->split;
+
+		for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+			record->encodings[a] = format.encodings[a];
+		}
+		record->split = format.split;
+
+		// Both streams first, allocating moves the previous ones.
+		for (size_t s = 0; s < LAYMAN_VERTEX_STREAMS && unpacked; s++) {
+			unpacked = allocate(output, count * layman_vertex_size(&format, s), &record->streams_offsets[s]) != NULL;
+		}
+
+		if (unpacked) {
+			void *streams[LAYMAN_VERTEX_STREAMS];
+			for (size_t s = 0; s < LAYMAN_VERTEX_STREAMS; s++) {
+				streams[s] = output->data + record->streams_offsets[s];
+			}
+
+			layman_vertex_encode(&format, (const float *const *) sources, count, streams);
+		}
+	}
+
+	for (size_t a = 0; a < LAYMAN_VERTEX_ATTRIBUTES; a++) {
+		free(sources[a]);
+	}
+
+	return unpacked;
+}
+
+// Returns `false` when the primitive can't be cooked, which isn't fatal.
+static bool cook_primitive(struct output *output, const struct options *options, const cgltf_data *gltf, const cgltf_primitive *primitive, struct layman_pack_mesh *record, struct report *report) {
+	// Same accessors as the loader picks.
+	const cgltf_accessor *accessors[LAYMAN_VERTEX_ATTRIBUTES] = {0};
+	for (size_t i = 0; i < primitive->attributes_count; i++) {
+		const cgltf_attribute *attribute = primitive->attributes + i;
+
+		switch (attribute->type) {
+		    case cgltf_attribute_type_position:
+			    if (attribute->data->type == cgltf_type_vec3) {
+				    accessors[LAYMAN_MESH_ATTRIBUTE_POSITION] = attribute->data;
+			    }
+			    break;
+
+		    case cgltf_attribute_type_normal:
+			    if (attribute->data->type == cgltf_type_vec3) {
+				    accessors[LAYMAN_MESH_ATTRIBUTE_NORMAL] = attribute->data;
+			    }
+			    break;
+
+		    case cgltf_attribute_type_texcoord:
+			    if (attribute->data->type == cgltf_type_vec2 && attribute->index == 0) {
+				    accessors[LAYMAN_MESH_ATTRIBUTE_UV] = attribute->data;
+			    }
+			    break;
+
+		    case cgltf_attribute_type_tangent:
+			    if (attribute->data->type == cgltf_type_vec4) {
+				    accessors[LAYMAN_MESH_ATTRIBUTE_TANGENT] = attribute->data;
+			    }
+			    break;
+
+		    default:
+			    break;
+		}
+	}
+
+	const cgltf_accessor *positions = accessors[LAYMAN_MESH_ATTRIBUTE_POSITION];
+	if (!positions) {
+		return false;
+	}
+
+	size_t vertices_count = positions->count;
+	if (vertices_count > UINT32_MAX) {
+		fprintf(stderr, "Skipping a primitive of %zu vertices, too many for 32-bit indices\n", vertices_count);
+		return false;
+	}
+
+	// Attributes not covering every vertex are dropped.
+	record->attributes = 0;
+	for (unsigned int attribute = 0; attribute < ARRAY_COUNT(accessors); attribute++) {
+		if (accessors[attribute] && accessors[attribute]->count == vertices_count) {
+			record->attributes |= 1 << attribute;
+		}
+	}
+
+	record->material = primitive->material ? (uint32_t) (primitive->material - gltf->materials) : (uint32_t) gltf->materials_count;
+	record->vertices_count = vertices_count;
+	record->indices_count = primitive->indices ? primitive->indices->count : vertices_count;
+	record->indices_format = layman_mesh_index_format_fit(vertices_count);
+	record->lods_count = 1;
+	record->lods[0] = (struct layman_pack_lod) {0, record->indices_count, 0.0f};
+	record->meshlets_count = 0;
+	record->reserved = 0;
+	record->meshlets_offset = 0;
+
+	// Indices of any width, made up for primitives without. Narrowed once optimized and simplified.
+	uint32_t *indices = malloc(record->indices_count * sizeof *indices + 1);
+	if (!indices) {
+		return false;
+	}
+
+	for (size_t i = 0; i < record->indices_count; i++) {
+		indices[i] = primitive->indices ? cgltf_accessor_read_index(primitive->indices, i) : i;
+
+		if (indices[i] >= vertices_count) {
+			fprintf(stderr, "Skipping a primitive indexing vertex %u of %zu\n", indices[i], vertices_count);
+			free(indices);
+			return false;
+		}
+	}
+
+	bool cooked = cook_vertices(output, options, accessors, &indices, record, report);
+
+	size_t indices_size = record->indices_count * layman_mesh_index_size(record->indices_format);
+	void *destination = cooked ? allocate(output, indices_size, &record->indices_offset) : NULL;
+	if (destination) {
+		layman_mesh_narrow_indices(indices, record->indices_count, record->indices_format, destination);
+	}
+
+	free(indices);
+
+	return destination != NULL;
+}
+
+static bool cook_meshes(struct output *output, const struct options *options, const cgltf_data *gltf, struct layman_pack_mesh **records, uint32_t *count) {
+	size_t primitives_count = 0;
+	for (size_t i = 0; i < gltf->meshes_count; i++) {
+		primitives_count += gltf->meshes[i].primitives_count;
+	}
+
+	*records = calloc(primitives_count + 1, sizeof **records);
+	if (!*records) {
+		return false;
+	}
+
+	*count = 0;
+	struct report report = {0};
+
+	for (size_t i = 0; i < gltf->meshes_count; i++) {
+		for (size_t j = 0; j < gltf->meshes[i].primitives_count; j++) {
+			const cgltf_primitive *primitive = gltf->meshes[i].primitives + j;
+
+			// Only support triangle primitives.
+			if (primitive->type != cgltf_primitive_type_triangles) {
+				continue;
+			}
+
+			if (cook_primitive(output, options, gltf, primitive, *records + *count, &report)) {
+				(*count)++;
+			}
+		}
+	}
+
+	// What the vertex shader is spared.
+	if (report.before.triangles_count > 0 && report.before.vertices_count > 0) {
+		printf("Vertex cache (%d entries), %zu triangles:\n", LAYMAN_OPTIMIZER_CACHE_SIZE, report.before.triangles_count);
+		printf("  ACMR %.3f -> %.3f\n", (double) report.before.transforms / report.before.triangles_count, (double) report.after.transforms / report.after.triangles_count);
+		printf("  ATVR %.3f -> %.3f\n", (double) report.before.transforms / report.before.vertices_count, (double) report.after.transforms / report.after.vertices_count);
+	}
+
+	// What distant meshes get drawn with instead.
+	for (size_t l = 1; l < LAYMAN_MESH_LODS && report.lods_triangles[l] > 0; l++) {
+		printf("LOD %zu: %zu triangles\n", l, report.lods_triangles[l]);
+	}
+
+	// What gets culled instead of whole meshes.
+	if (report.meshlets_count > 0) {
+		printf("Meshlets: %zu, %.1f triangles each\n", report.meshlets_count, (double) report.meshlets_triangles / report.meshlets_count);
+	}
+
+	return true;
+}
+
+static bool cook(const cgltf_data *gltf, const struct options *options, struct output *output) {
+	struct layman_pack_header header = {
+		.magic = LAYMAN_PACK_MAGIC,
+		.version = LAYMAN_PACK_VERSION,
+	};
+
+	// Filled in last.
+	uint64_t header_offset;
+	if (!allocate(output, sizeof header, &header_offset)) {
+		return false;
+	}
+
+	struct layman_pack_texture *textures = NULL;
+	struct layman_pack_material *materials = NULL;
+	struct layman_pack_mesh *meshes = NULL;
+	uint32_t *texture_indices = malloc((gltf->images_count * LAYMAN_TEXTURE_KIND_COUNT + 1) * sizeof *texture_indices);
+
+	bool cooked = texture_indices != NULL;
+	if (cooked) {
+		for (size_t i = 0; i < gltf->images_count * LAYMAN_TEXTURE_KIND_COUNT; i++) {
+			texture_indices[i] = LAYMAN_PACK_NONE;
+		}
+
+		cooked = cook_textures(output, gltf, options->compress, &textures, &header.textures_count, texture_indices)
+			&& cook_materials(gltf, texture_indices, &materials, &header.materials_count)
+			&& cook_meshes(output, options, gltf, &meshes, &header.meshes_count)
+			&& append(output, textures, header.textures_count * sizeof *textures, &header.textures_offset)
+			&& append(output, materials, header.materials_count * sizeof *materials, &header.materials_offset)
+			&& append(output, meshes, header.meshes_count * sizeof *meshes, &header.meshes_offset);
+	}
+
+	if (cooked) {
+		VEC3_ASSIGN(header.aabb_min, FLT_MAX, FLT_MAX, FLT_MAX);
+		VEC3_ASSIGN(header.aabb_max, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (uint32_t m = 0; m < header.meshes_count; m++) {
+			layman_model_enclose(header.aabb_min, header.aabb_max, meshes[m].aabb_min, meshes[m].aabb_max);
+		}
+
+		memcpy(output->data + header_offset, &header, sizeof header);
+	}
+
+	free(texture_indices);
+	free(textures);
+	free(materials);
+	free(meshes);
+
+	return cooked;
+}
+
+int main(int argc, char **argv) {
+	struct options options = {
+		.compress = false,
+		.quantize = true,
+		.split = false,
+		.lods = 4,
+		.lods_ratio = 0.5f,
+	};
+	const char *input = NULL;
+	const char *output_path = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--compress") == 0) {
+			options.compress = true;
+		} else if (strcmp(argv[i], "--float-vertices") == 0) {
+			options.quantize = false;
+		} else if (strcmp(argv[i], "--split-positions") == 0) {
+			options.split = true;
+		} else if (strcmp(argv[i], "--lods") == 0 && i + 1 < argc) {
+			long lods = strtol(argv[++i], NULL, 10);
+			options.lods = lods > 0 ? lods : 1;
+		} else if (strcmp(argv[i], "--lods-ratio") == 0 && i + 1 < argc) {
+			float ratio = strtof(argv[++i], NULL);
+			options.lods_ratio = ratio > 0.0f && ratio < 1.0f ? ratio : options.lods_ratio;
+		} else if (!input) {
+			input = argv[i];
+		} else if (!output_path) {
+			output_path = argv[i];
+		} else {
+			input = NULL;
+			break;
+		}
+	}
+
+	if (!input || !output_path) {
+		fprintf(stderr, "Usage: %s [--compress] [--float-vertices] [--split-positions] [--lods <count>] [--lods-ratio <ratio>] <model.gltf|model.glb> <model.pack>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	cgltf_data *gltf = NULL;
+	cgltf_options gltf_options = {0};
+	if (cgltf_parse_file(&gltf_options, input, &gltf) != cgltf_result_success || cgltf_load_buffers(&gltf_options, gltf, input) != cgltf_result_success) {
+		fprintf(stderr, "Can't load %s\n", input);
+		cgltf_free(gltf);
+		return EXIT_FAILURE;
+	}
+
+	struct output output = {0};
+	layman_parallel_start();
+	bool cooked = cook(gltf, &options, &output);
+	layman_parallel_stop();
+	cgltf_free(gltf);
+
+	if (!cooked) {
+		fprintf(stderr, "Out of memory\n");
+		free(output.data);
+		return EXIT_FAILURE;
+	}
+
+	FILE *file = fopen(output_path, "wb");
+	bool written = file && fwrite(output.data, 1, output.size, file) == output.size;
+	if (file && fclose(file) != 0) {
+		written = false;
+	}
+
+	free(output.data);
+
+	if (!written) {
+		fprintf(stderr, "Can't write %s\n", output_path);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}